@@ -1,4 +1,10 @@
 from .parallel_mcts import parallel_mcts_solve
+from .mcts_wrapper import solve_ensemble, solve_large_instance, solve_one_instance
+from .solver_pool import SolverPool, SolverFuture
+from .daemon import SolverClient, SolverDaemon
+from .live_solver import LiveSolver
+from .tuner import tune_parameters
+from .trace import export_trace, start_trace, stop_trace, trace
 from .mcts_types import TSP_Result
 
-__all__ = ['parallel_mcts_solve', 'TSP_Result']
\ No newline at end of file
+__all__ = ['parallel_mcts_solve', 'solve_one_instance', 'solve_ensemble', 'solve_large_instance', 'SolverPool', 'SolverFuture', 'SolverClient', 'SolverDaemon', 'LiveSolver', 'tune_parameters', 'start_trace', 'stop_trace', 'export_trace', 'trace', 'TSP_Result']
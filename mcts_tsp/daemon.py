@@ -0,0 +1,421 @@
+"""Long-lived solver daemon serving the instances of several processes.
+
+The daemon owns one native SolverPool and accepts instances over a Unix
+domain socket. The arrays of an instance are not sent through the socket:
+the client writes them into an anonymous shared memory file and passes its
+descriptor along with the request (SCM_RIGHTS), the daemon maps it read-only.
+The native pool copies the mapped arrays once into the job it queues, since
+the job outlives the request, then the shared file is released.
+Jobs are dispatched to the pool round-robin across the connected clients, so
+a client queuing many instances does not starve the others.
+
+Run it with `python -m mcts_tsp.daemon --socket /tmp/mcts_tsp.sock`, and
+solve through `SolverClient`.
+"""
+
+import argparse
+import array
+import errno
+import collections
+import concurrent.futures
+import itertools
+import json
+import mmap
+import os
+import socket
+import struct
+import tempfile
+import threading
+
+import numpy as np
+
+from .mcts_types import TSP_Result
+from .solver_pool import DEFAULT_PARAMS
+
+DEFAULT_SOCKET_PATH = "/tmp/mcts_tsp.sock"
+
+# Every message is a little-endian length, a JSON header of that length, then
+# an optional binary payload whose size is given in the header
+_LENGTH = struct.Struct("<I")
+_ALIGNMENT = 64
+_ARRAY_NAMES = ("coordinates", "opt_solution", "heatmap")
+
+def _recv_exact(sock, size):
+    chunks = []
+    while size > 0:
+        chunk = sock.recv(size)
+        if not chunk:
+            raise ConnectionError("Connection closed in the middle of a message")
+        chunks.append(chunk)
+        size -= len(chunk)
+    return b"".join(chunks)
+
+def _send_message(sock, header, payload=b"", fds=()):
+    data = json.dumps(header).encode()
+    message = _LENGTH.pack(len(data)) + data + payload
+    ancillary = [(socket.SOL_SOCKET, socket.SCM_RIGHTS, array.array("i", fds))] if fds else []
+    # The descriptors travel with the first bytes, a partial send only needs the rest
+    sent = sock.sendmsg([message], ancillary)
+    if sent < len(message):
+        sock.sendall(message[sent:])
+
+def _recv_message(sock, max_fds=1):
+    """Return (header, payload, fds), or None if the peer closed the connection."""
+    fds = array.array("i")
+    data, ancillary, _, _ = sock.recvmsg(_LENGTH.size, socket.CMSG_SPACE(max_fds * fds.itemsize))
+    if not data:
+        return None
+    for level, kind, cmsg_data in ancillary:
+        if level == socket.SOL_SOCKET and kind == socket.SCM_RIGHTS:
+            fds.frombytes(cmsg_data[:len(cmsg_data) - len(cmsg_data) % fds.itemsize])
+    data += _recv_exact(sock, _LENGTH.size - len(data))
+    header = json.loads(_recv_exact(sock, _LENGTH.unpack(data)[0]))
+    payload = _recv_exact(sock, header.get("payload_size", 0))
+    return header, payload, list(fds)
+
+def _create_shared_file(size):
+    memfd_create = getattr(os, "memfd_create", None)
+    if memfd_create is not None:
+        fd = memfd_create("mcts_tsp", os.MFD_CLOEXEC)
+    else:
+        with tempfile.TemporaryFile() as f:
+            fd = os.dup(f.fileno())
+    os.ftruncate(fd, max(size, 1))
+    return fd
+
+def _listen(path):
+    """Listen on the Unix socket `path`, accessible to the current user only.
+
+    A socket file left over by a daemon that did not shut down is replaced,
+    but not the socket of a daemon still serving on `path`.
+    """
+    probe = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    try:
+        probe.connect(path)
+    except FileNotFoundError:
+        pass
+    except OSError as e:
+        if e.errno != errno.ECONNREFUSED:
+            raise
+        os.unlink(path)
+    else:
+        raise RuntimeError(f"A solver daemon is already serving on {path}")
+    finally:
+        probe.close()
+
+    listener = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    old_umask = os.umask(0o177)  # The socket is created 0600
+    try:
+        listener.bind(path)
+    except OSError:
+        listener.close()
+        raise
+    finally:
+        os.umask(old_umask)
+    listener.listen()
+    return listener
+
+class _FairScheduler:
+    """Feed the pool from per-client queues, one job per client in turn.
+
+    At most `max_in_flight` jobs are in the native pool at once, so the
+    order of the remaining jobs is still decided here.
+    """
+
+    def __init__(self, native_pool, max_in_flight):
+        self._pool = native_pool
+        self._max_in_flight = max_in_flight
+        self._in_flight = 0
+        self._queues = collections.OrderedDict()  # client -> deque of jobs, in round-robin order
+        self._cond = threading.Condition()
+        self._closed = False
+        self._thread = threading.Thread(target=self._dispatch, daemon=True)
+        self._thread.start()
+
+    def put(self, client, job):
+        with self._cond:
+            self._queues.setdefault(client, collections.deque()).append(job)
+            self._cond.notify()
+
+    def drop(self, client):
+        """Forget the queued jobs of `client`, return them."""
+        with self._cond:
+            return list(self._queues.pop(client, ()))
+
+    def close(self):
+        with self._cond:
+            self._closed = True
+            self._cond.notify()
+        self._thread.join()
+
+    def _job_done(self):
+        with self._cond:
+            self._in_flight -= 1
+            self._cond.notify()
+
+    def _dispatch(self):
+        while True:
+            with self._cond:
+                while not self._closed and (not self._queues or self._in_flight >= self._max_in_flight):
+                    self._cond.wait()
+                if self._closed:
+                    return
+                client, queue = self._queues.popitem(last=False)
+                job = queue.popleft()
+                if queue:
+                    self._queues[client] = queue
+                self._in_flight += 1
+            try:
+                job.run(self._pool, self._job_done)
+            except Exception as e:
+                job.conn.reply(dict(id=job.request_id, error=str(e)))
+                self._job_done()
+
+class _Connection:
+    def __init__(self, sock):
+        self.sock = sock
+        self.send_lock = threading.Lock()
+
+    def reply(self, header, payload=b""):
+        with self.send_lock:
+            try:
+                _send_message(self.sock, dict(header, payload_size=len(payload)), payload)
+            except OSError:
+                pass  # The client is gone, its result is dropped
+
+class SolverDaemon:
+    """Serve instances on the Unix socket `path` with a pool of `num_threads` solver threads."""
+
+    def __init__(self, path=DEFAULT_SOCKET_PATH, num_threads=0, share_budget=False):
+        from . import _mcts_cpp as mcts
+
+        self.path = path
+        self._listener = _listen(path)
+        self._native = mcts.SolverPool(num_threads, 0, share_budget)
+        self._scheduler = _FairScheduler(self._native, self._native.num_threads)
+        self._closed = False
+
+    def serve_forever(self):
+        while not self._closed:
+            try:
+                sock, _ = self._listener.accept()
+            except OSError:
+                break
+            threading.Thread(target=self._serve_client, args=(_Connection(sock),), daemon=True).start()
+
+    def shutdown(self):
+        """Stop accepting clients, cancel the queued jobs and wait for the running ones."""
+        self._closed = True
+        self._listener.close()
+        if os.path.exists(self.path):
+            os.unlink(self.path)
+        self._scheduler.close()
+        self._native.shutdown(True)
+
+    def _serve_client(self, conn):
+        try:
+            while True:
+                message = _recv_message(conn.sock)
+                if message is None:
+                    break
+                header, _, fds = message
+                try:
+                    job = self._make_job(conn, header, fds)
+                except Exception as e:
+                    conn.reply(dict(id=header.get("id"), error=str(e)))
+                    continue
+                self._scheduler.put(conn, job)
+        except (OSError, ValueError):
+            pass
+        finally:
+            for job in self._scheduler.drop(conn):
+                job.cancel()
+            conn.sock.close()
+
+    def _make_job(self, conn, header, fds):
+        if len(fds) != 1:
+            for fd in fds:
+                os.close(fd)
+            raise ValueError("A request carries exactly one shared memory descriptor")
+        params = header["params"]
+        unknown = set(params) - set(DEFAULT_PARAMS)
+        if unknown:
+            os.close(fds[0])
+            raise ValueError(f"Unknown parameters {sorted(unknown)}")
+        params = {**DEFAULT_PARAMS, **params}
+        city_num = header["city_num"]
+        if (2 * params["max_depth"] > city_num):
+            os.close(fds[0])
+            raise ValueError("max_depth should be less than city_num/2")
+        return _Job(conn, header["id"], city_num, params, header["arrays"], fds[0])
+
+class _Job:
+    """One instance waiting in the scheduler, its arrays are in the shared file `fd`."""
+
+    def __init__(self, conn, request_id, city_num, params, layout, fd):
+        self.conn = conn
+        self.request_id = request_id
+        self.city_num = city_num
+        self.params = params
+        self.layout = layout
+        self.fd = fd
+
+    def cancel(self):
+        os.close(self.fd)
+
+    def run(self, native_pool, job_done):
+        # The pool copies the arrays into its job, so the shared file is released right away
+        try:
+            shared = mmap.mmap(self.fd, 0, access=mmap.ACCESS_READ)
+        finally:
+            os.close(self.fd)
+        with shared:
+            arrays = {
+                name: np.frombuffer(shared, dtype=np.dtype(dtype), count=int(np.prod(shape)),
+                                    offset=offset).reshape(shape)
+                for name, (offset, shape, dtype) in self.layout.items()
+            }
+            try:
+                future = native_pool.submit(self.city_num, **arrays, **self.params)
+            except Exception as e:
+                self.conn.reply(dict(id=self.request_id, error=str(e)))
+                job_done()
+                return
+            finally:
+                del arrays
+        future.add_done_callback(lambda _: self._send_result(future, job_done))
+
+    def _send_result(self, future, job_done):
+        job_done()
+        try:
+            result = future.result(0)
+        except Exception as e:
+            self.conn.reply(dict(id=self.request_id, error=str(e)))
+            return
+        solution = np.ascontiguousarray(result.Solution, dtype=np.int32)
+        length_time = np.ascontiguousarray(result.Length_Time, dtype=np.float64)
+        self.conn.reply(
+            dict(id=self.request_id, error=None, Concorde_Distance=result.Concorde_Distance,
+                 MCTS_Distance=result.MCTS_Distance, Gap=result.Gap, Time=result.Time,
+                 Overall_Time=result.Overall_Time, solution_len=len(solution), length_time_len=len(length_time)),
+            solution.tobytes() + length_time.tobytes())
+
+class SolverClient:
+    """Thin client of a SolverDaemon, safe to share between threads.
+
+    Parameters given here are the defaults of every submission, any of them
+    can be overridden per call (see `solver_pool.DEFAULT_PARAMS`).
+    """
+
+    def __init__(self, path=DEFAULT_SOCKET_PATH, **params):
+        unknown = set(params) - set(DEFAULT_PARAMS)
+        if unknown:
+            raise TypeError(f"Unknown parameters {sorted(unknown)}")
+        self.params = params
+        self._sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self._sock.connect(path)
+        self._send_lock = threading.Lock()
+        self._pending_lock = threading.Lock()
+        self._pending = {}
+        self._ids = itertools.count()
+        self._reader = threading.Thread(target=self._read_replies, daemon=True)
+        self._reader.start()
+
+    def submit(self, coordinates, opt_solution, heatmap, **params) -> concurrent.futures.Future:
+        """Send one instance to the daemon, return a future of its TSP_Result."""
+        unknown = set(params) - set(DEFAULT_PARAMS)
+        if unknown:
+            raise TypeError(f"Unknown parameters {sorted(unknown)}")
+        arrays = dict(coordinates=np.asarray(coordinates), opt_solution=np.asarray(opt_solution),
+                      heatmap=np.asarray(heatmap))
+        layout, size = {}, 0
+        for name in _ARRAY_NAMES:
+            layout[name] = (size, arrays[name].shape, arrays[name].dtype.str)
+            size += -(-arrays[name].nbytes // _ALIGNMENT) * _ALIGNMENT
+
+        fd = _create_shared_file(size)
+        try:
+            # Each array is copied straight into the shared file
+            with mmap.mmap(fd, max(size, 1)) as shared:
+                for name in _ARRAY_NAMES:
+                    offset, shape, dtype = layout[name]
+                    view = np.ndarray(shape, dtype=dtype, buffer=shared, offset=offset)
+                    np.copyto(view, arrays[name])
+                    del view  # The map cannot be closed while a view exports it
+
+            future = concurrent.futures.Future()
+            request_id = next(self._ids)
+            with self._pending_lock:
+                self._pending[request_id] = future
+            header = dict(id=request_id, city_num=len(arrays["opt_solution"]), params={**self.params, **params},
+                          arrays=layout)
+            with self._send_lock:
+                _send_message(self._sock, header, fds=[fd])
+        finally:
+            os.close(fd)
+        return future
+
+    def solve(self, coordinates, opt_solution, heatmap, **params) -> TSP_Result:
+        return self.submit(coordinates, opt_solution, heatmap, **params).result()
+
+    def close(self):
+        self._sock.shutdown(socket.SHUT_RDWR)
+        self._sock.close()
+        self._reader.join()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc_info):
+        self.close()
+
+    def _read_replies(self):
+        try:
+            while True:
+                message = _recv_message(self._sock, max_fds=0)
+                if message is None:
+                    break
+                header, payload, _ = message
+                with self._pending_lock:
+                    future = self._pending.pop(header["id"], None)
+                if future is None:
+                    continue
+                if header["error"] is not None:
+                    future.set_exception(RuntimeError(header["error"]))
+                    continue
+                solution_size = 4 * header["solution_len"]
+                future.set_result(TSP_Result(
+                    Concorde_Distance=header["Concorde_Distance"],
+                    MCTS_Distance=header["MCTS_Distance"],
+                    Gap=header["Gap"],
+                    Time=header["Time"],
+                    Overall_Time=header["Overall_Time"],
+                    Solution=np.frombuffer(payload[:solution_size], dtype=np.int32).copy(),
+                    Length_Time=np.frombuffer(payload[solution_size:], dtype=np.float64).reshape(-1, 2).copy(),
+                ))
+        except (OSError, ValueError):
+            pass
+        finally:
+            with self._pending_lock:
+                pending, self._pending = self._pending, {}
+            for future in pending.values():
+                future.set_exception(ConnectionError("The solver daemon closed the connection"))
+
+def main():
+    parser = argparse.ArgumentParser(description="Serve TSP instances on a Unix domain socket")
+    parser.add_argument("--socket", default=DEFAULT_SOCKET_PATH, help="path of the Unix domain socket")
+    parser.add_argument("--num-threads", type=int, default=0, help="solver threads (0: one per core)")
+    parser.add_argument("--share-budget", action="store_true",
+                        help="lend the time saved by stagnated instances to the others")
+    args = parser.parse_args()
+
+    daemon = SolverDaemon(args.socket, args.num_threads, args.share_budget)
+    try:
+        daemon.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        daemon.shutdown()
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,65 @@
+import threading
+
+import numpy as np
+
+from . import _mcts_cpp as mcts
+
+class LiveSolver:
+    """An EUC_2D instance kept alive between solves.
+
+    `solve()` solves the instance from scratch. `update()` then applies a
+    small change (cities added, removed or moved) and only patches the
+    distance and candidate rows of the changed cities, repairs the best tour
+    by cheapest insertion and runs a short search around the changed cities,
+    starting from the edge weights learned so far.
+
+    Cities are numbered 0..city_num-1. In an update, `remove` and `move` use
+    the numbering before the update. Removals are applied by decreasing
+    index, the last city taking the index of each removed one, then the
+    `add` cities are appended. `coordinates` always holds the current cities.
+
+    The candidates are the nearest cities, the heatmap is only used by
+    `solve()`.
+    """
+
+    def __init__(self, alpha=1, beta=10, param_h=10, param_t=0.1, max_candidate_num=5, max_depth=10,
+                 log_len_time=False, debug=False, restart_policy=0, kick_segment_len=50, mcts_patience=1,
+                 stagnation_threshold=0.0, init_method="heatmap_sampling"):
+        self._native = mcts.LiveSolver(alpha, beta, param_h, param_t, max_candidate_num, max_depth, log_len_time,
+                                       debug, restart_policy, kick_segment_len, mcts_patience, stagnation_threshold,
+                                       init_method)
+        # The native instance must not be searched by two threads at once
+        self._lock = threading.Lock()
+
+    @property
+    def city_num(self):
+        return self._native.city_num
+
+    @property
+    def coordinates(self):
+        return self._native.coordinates
+
+    @property
+    def tour(self):
+        return self._native.tour
+
+    def solve(self, coordinates, heatmap=None, opt_solution=None):
+        with self._lock:
+            return self._native.solve(coordinates, opt_solution, heatmap)
+
+    def update(self, add=None, remove=None, move=None, time_limit=None):
+        """Apply a change and re-optimize the tour around it.
+
+        `add` is an (A, 2) array of new coordinates, `remove` a list of
+        indices and `move` a mapping {index: (x, y)}. `time_limit` is the
+        search time in seconds, by default `param_t` per city for a region
+        of 20 cities per changed city. The returned `Concorde_Distance` is
+        the length of the repaired tour before the search.
+        """
+        add = np.zeros((0, 2)) if add is None else np.asarray(add, dtype=np.float64).reshape(-1, 2)
+        remove = np.asarray([] if remove is None else list(remove), dtype=np.int32)
+        move = {} if move is None else dict(move)
+        move_index = np.fromiter(move.keys(), dtype=np.int32, count=len(move))
+        move_coordinates = np.asarray(list(move.values()), dtype=np.float64).reshape(-1, 2)
+        with self._lock:
+            return self._native.update(add, remove, move_index, move_coordinates, time_limit or 0.0)
@@ -1,5 +1,6 @@
 from dataclasses import dataclass
-from typing import List, Tuple
+
+import numpy as np
 
 @dataclass
 class TSP_Result:
@@ -8,5 +9,18 @@ class TSP_Result:
     Gap: float
     Time: float
     Overall_Time: float
-    Solution: List[int]
-    Length_Time: List[Tuple[float, float]]
\ No newline at end of file
+    Solution: np.ndarray     # int32 array of shape (N,)
+    Length_Time: np.ndarray  # float64 array of shape (M, 2)
+    Learned_Weight_City: np.ndarray = None  # int32 array of shape (N, K), heaviest learned edges of each city
+    Learned_Weight: np.ndarray = None       # float32 array of shape (N, K)
+    Lower_Bound: float = -1.0               # Held-Karp lower bound, -1 unless computed
+    Certified_Gap: float = -1.0             # (MCTS_Distance - Lower_Bound) / Lower_Bound, -1 unless computed
+
+@dataclass
+class TSP_Ensemble_Result:
+    Best_Index: int
+    Best: TSP_Result
+    MCTS_Distances: np.ndarray  # float64 array of shape (S,)
+    Gaps: np.ndarray            # float64 array of shape (S,)
+    Times: np.ndarray           # float64 array of shape (S,)
+    Overall_Time: float
@@ -1,6 +1,17 @@
 import numpy as np
 from . import _mcts_cpp as mcts
-from .mcts_types import TSP_Result
+from .mcts_types import TSP_Ensemble_Result, TSP_Result
+
+# Native entry point of each supported metric. For "EXPLICIT", `coordinates`
+# is the (N, N) integer distance matrix instead of the city coordinates
+METRIC_SOLVERS = {
+    "EUC_2D": mcts.solve,
+    "EUC_3D": mcts.solve_euc_3d,
+    "CEIL_2D": mcts.solve_ceil_2d,
+    "GEO": mcts.solve_geo,
+    "ATT": mcts.solve_att,
+    "EXPLICIT": mcts.solve_explicit,
+}
 
 def solve_one_instance(
     coordinates: np.ndarray,
@@ -15,11 +26,66 @@ def solve_one_instance(
     candidate_use_heatmap: int,
     max_depth: int,
     log_len_time: bool = False,
-    debug: bool = False
+    debug: bool = False,
+    restart_policy: int = 0,
+    kick_segment_len: int = 50,
+    metric: str = "EUC_2D",
+    checkpoint_path: str = "",
+    checkpoint_interval: float = 300.0,
+    resume_path: str = "",
+    mcts_patience: int = 1,
+    stagnation_threshold: float = 0.0,
+    init_method: str = "heatmap_sampling",
+    focused_sampling: bool = False,
+    export_weight_num: int = 0,
+    prior_weight=None,
+    compute_lower_bound: bool = False,
+    target_gap: float = 0.0,
+    renumber: str = "none",
+    heatmap_scale: float = 1 / 255,
+    island_num: int = 1,
+    elite_pool_size: int = 0
 ) -> TSP_Result:
+    """Solve one instance.
+
+    With `export_weight_num=K`, the result also holds the K heaviest learned
+    edges of each city (`Learned_Weight_City`, -1 padded, and
+    `Learned_Weight`, both of shape (N, K)). Pass them back as
+    `prior_weight=(result.Learned_Weight_City, result.Learned_Weight)` to
+    start a later solve of the same cities from these weights instead of the
+    heatmap ones.
+
+    With `compute_lower_bound=True`, a Held-Karp (1-tree) lower bound is
+    computed on a second thread during the search and returned as
+    `Lower_Bound`, with the `Certified_Gap` of the tour to it. With
+    `target_gap > 0` the bound is always computed, and the search stops as
+    soon as the tour is within `target_gap` (e.g. 0.01 for 1%) of the bound.
+
+    With `renumber="hilbert"` or `"greedy"`, the cities are numbered
+    internally along a Hilbert curve or a nearest-neighbor tour, which keeps
+    the search's memory accesses local on large instances given in random
+    order. Inputs and results stay in the caller's numbering.
+
+    `heatmap` may also be a `uint8` array, read as `heatmap * heatmap_scale`,
+    or a `float16` array. Such heatmaps are passed and stored in their own
+    format, 8 or 4 times smaller than float64. Any other dtype is converted
+    to float64.
+
+    With `island_num=T > 1`, T searches of the instance run concurrently on
+    T threads, each with its own tour and random generator, within the same
+    time budget. They share the shortest tour found so far and periodically
+    average their learned edge weights.
+
+    With `elite_pool_size=M >= 2`, the M shortest distinct tours reached at
+    the end of the restarts are kept, and a restart starts from the partition
+    crossover of two of them instead of a kick whenever that offspring is
+    shorter than the best tour.
+    """
     if (2 * max_depth > city_num):
         raise ValueError("max_depth should be less than city_num/2")
-    return mcts.solve(
+    if metric not in METRIC_SOLVERS:
+        raise ValueError(f"Unknown metric {metric}, expected one of {list(METRIC_SOLVERS)}")
+    return METRIC_SOLVERS[metric](
         city_num,
         alpha,
         beta,
@@ -32,5 +98,124 @@ def solve_one_instance(
         opt_solution,
         heatmap,
         log_len_time,
-        debug
-    )
\ No newline at end of file
+        debug,
+        restart_policy=restart_policy,
+        kick_segment_len=kick_segment_len,
+        mcts_patience=mcts_patience,
+        stagnation_threshold=stagnation_threshold,
+        init_method=init_method,
+        focused_sampling=focused_sampling,
+        checkpoint_path=checkpoint_path,
+        checkpoint_interval=checkpoint_interval,
+        resume_path=resume_path,
+        export_weight_num=export_weight_num,
+        prior_weight_city=None if prior_weight is None else prior_weight[0],
+        prior_weight=None if prior_weight is None else prior_weight[1],
+        compute_lower_bound=compute_lower_bound,
+        target_gap=target_gap,
+        renumber=renumber,
+        heatmap_scale=heatmap_scale,
+        island_num=island_num,
+        elite_pool_size=elite_pool_size
+    )
+def solve_large_instance(
+    coordinates: np.ndarray,
+    opt_solution: np.ndarray,
+    city_num: int,
+    alpha: float = 1,
+    beta: float = 10,
+    param_h: float = 10,
+    param_t: float = 0.01,
+    max_candidate_num: int = 5,
+    max_depth: int = 10,
+    window_size: int = 1000,
+    window_shift: int = 0,
+    round_num: int = 4,
+    num_threads: int = 0,
+    time_limit: float = 0.0,
+    kick_segment_len: int = 50,
+    debug: bool = False
+) -> TSP_Result:
+    """Solve one large EUC_2D instance (100k+ cities) by spatial decomposition.
+
+    A Hilbert-curve tour is split into windows of `window_size` consecutive
+    cities, which are optimized in parallel by MCTS with fixed endpoints and
+    stitched back, for `round_num` rounds with boundaries shifted by
+    `window_shift` cities (default: half a window). `param_t` is the time
+    budget per city of each window, `num_threads=0` uses all cores.
+    """
+    if (2 * max_depth + 2 > window_size):
+        raise ValueError("max_depth should be less than window_size/2")
+    return mcts.solve_decomposed(
+        city_num,
+        alpha,
+        beta,
+        param_h,
+        param_t,
+        max_candidate_num,
+        max_depth,
+        coordinates,
+        opt_solution,
+        window_size=window_size,
+        window_shift=window_shift,
+        round_num=round_num,
+        num_threads=num_threads,
+        time_limit=time_limit,
+        kick_segment_len=kick_segment_len,
+        debug=debug
+    )
+def solve_ensemble(
+    coordinates: np.ndarray,
+    opt_solution: np.ndarray,
+    heatmaps: np.ndarray,
+    city_num: int,
+    alpha: float = 1,
+    beta: float = 10,
+    param_h: float = 10,
+    param_t: float = 0.1,
+    max_candidate_num: int = 5,
+    candidate_use_heatmap: int = 1,
+    max_depth: int = 10,
+    log_len_time: bool = False,
+    debug: bool = False,
+    restart_policy: int = 0,
+    kick_segment_len: int = 50,
+    mcts_patience: int = 1,
+    stagnation_threshold: float = 0.0,
+    init_method: str = "heatmap_sampling",
+    focused_sampling: bool = False,
+    num_threads: int = 0,
+    metric: str = "EUC_2D"
+) -> TSP_Ensemble_Result:
+    """Solve one instance once per heatmap of `heatmaps` (S, N, N), concurrently.
+
+    The distance matrix, and the candidate sets when `candidate_use_heatmap`
+    is 0 or 2, are computed once and shared by the S searches. Returns a
+    TSP_Ensemble_Result holding the best member (`Best`, `Best_Index`) and
+    the per-member `MCTS_Distances`, `Gaps` and `Times`.
+    """
+    if (2 * max_depth > city_num):
+        raise ValueError("max_depth should be less than city_num/2")
+    return mcts.solve_ensemble(
+        city_num,
+        alpha,
+        beta,
+        param_h,
+        param_t,
+        max_candidate_num,
+        candidate_use_heatmap,
+        max_depth,
+        coordinates,
+        opt_solution,
+        heatmaps,
+        log_len_time=log_len_time,
+        debug=debug,
+        restart_policy=restart_policy,
+        kick_segment_len=kick_segment_len,
+        mcts_patience=mcts_patience,
+        stagnation_threshold=stagnation_threshold,
+        init_method=init_method,
+        focused_sampling=focused_sampling,
+        num_threads=num_threads,
+        metric=metric
+    )
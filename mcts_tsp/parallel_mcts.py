@@ -1,104 +1,132 @@
+import atexit
 import concurrent.futures
 import numpy as np
+import traceback
 from multiprocessing import shared_memory
-from multiprocessing.managers import SharedMemoryManager
 from .mcts_wrapper import solve_one_instance
 
-# Helper function for creating shared memory for one instance using SharedMemoryManager
-def create_shared_memory_for_one_instance(smm, data):
-    shm = smm.SharedMemory(size=data.nbytes)
-    # Create temporary array view to copy data, no need to return it
-    np.ndarray(data.shape, dtype=data.dtype, buffer=shm.buf)[:] = data[:]
-    return shm
+_ALIGNMENT = 64
 
-# Helper function for accessing shared memory in child processes
-def access_shared_memory(shm_name, shape, dtype):
-    shm = shared_memory.SharedMemory(name=shm_name)
-    return np.ndarray(shape, dtype=dtype, buffer=shm.buf), shm
+# Worker processes kept across calls, so that each call does not pay for
+# spawning them and importing the module again
+_executor = None
+_executor_workers = None
 
-# Function that processes shared memory access and performs calculations
-def solve_one_instance_with_shared_memory(shm_coords_name, shm_solutions_name, shm_heatmaps_name, 
-                                          coords_shape, sol_shape, heatmap_shape,
-                                          coords_dtype, sol_dtype, heatmap_dtype, 
-                                          city_num, alpha, beta, param_h, param_t,
-                                          max_candidate_num, candidate_use_heatmap, 
-                                          max_depth, log_len_time, debug):
-    # Access shared memory in child process
-    shm_coords_arr, shm_coords = access_shared_memory(shm_coords_name, coords_shape, coords_dtype)
-    shm_solutions_arr, shm_solutions = access_shared_memory(shm_solutions_name, sol_shape, sol_dtype)
-    shm_heatmaps_arr, shm_heatmaps = access_shared_memory(shm_heatmaps_name, heatmap_shape, heatmap_dtype)
+def _get_executor(num_threads):
+    global _executor, _executor_workers
+    if _executor is None or _executor_workers != num_threads:
+        shutdown_workers()
+        _executor = concurrent.futures.ProcessPoolExecutor(max_workers=num_threads)
+        _executor_workers = num_threads
+    return _executor
 
+def shutdown_workers():
+    """Stop the worker processes kept by parallel_mcts_solve."""
+    global _executor, _executor_workers
+    if _executor is not None:
+        _executor.shutdown()
+        _executor, _executor_workers = None, None
+
+atexit.register(shutdown_workers)
+
+# Copy the (B, ...) arrays into one shared memory segment, return the segment
+# and the (offset, shape, dtype) of each array in it
+def create_shared_slab(arrays):
+    layout, size = {}, 0
+    for name, data in arrays.items():
+        layout[name] = (size, data.shape, data.dtype.str)
+        size += -(-data.nbytes // _ALIGNMENT) * _ALIGNMENT
+    slab = shared_memory.SharedMemory(create=True, size=max(size, 1))
+    for name, data in arrays.items():
+        offset, shape, dtype = layout[name]
+        np.ndarray(shape, dtype=dtype, buffer=slab.buf, offset=offset)[...] = data
+    return slab, layout
+
+# Solve the instances [begin, end) of a slab in a worker process. The worker
+# only attaches to the slab, the caller owns and unlinks it
+def solve_chunk_of_slab(slab_name, layout, begin, end, city_num, params):
+    slab = shared_memory.SharedMemory(name=slab_name)
+    arrays = None
     try:
-        # Call the original solve function with the shared memory arrays
-        result = solve_one_instance(shm_coords_arr, shm_solutions_arr, shm_heatmaps_arr, city_num, alpha, beta, param_h, param_t,
-                                    max_candidate_num, candidate_use_heatmap, max_depth, log_len_time, debug)
+        arrays = {name: np.ndarray(shape, dtype=dtype, buffer=slab.buf, offset=offset)
+                  for name, (offset, shape, dtype) in layout.items()}
+        results = [solve_one_instance(arrays["coordinates"][i], arrays["opt_solutions"][i], arrays["heatmaps"][i],
+                                      city_num, **params)
+                   for i in range(begin, end)]
+    except BaseException as e:
+        # The frames of the traceback hold views of the slab too
+        traceback.clear_frames(e.__traceback__)
+        raise
     finally:
-        # Cleanup shared memory references in child process
-        shm_coords.close()
-        shm_coords.unlink()
-        shm_solutions.close()
-        shm_solutions.unlink()
-        shm_heatmaps.close()
-        shm_heatmaps.unlink()
-
-    return result
+        # close() raises a BufferError while views of the slab are alive,
+        # which would hide the error of the solve
+        arrays = None
+        slab.close()
+    return begin, results
 
 def parallel_mcts_solve(city_num, num_threads, coordinates_list, opt_solutions, heatmaps, alpha=1, beta=10, param_h=10, param_t=0.1,
-                        max_candidate_num=5, candidate_use_heatmap=1, max_depth=10, log_len_time=False, debug=False, batch_size=None):
-    
-    results = []
+                        max_candidate_num=5, candidate_use_heatmap=1, max_depth=10, log_len_time=False, debug=False, batch_size=None,
+                        restart_policy=0, kick_segment_len=50, metric="EUC_2D", mcts_patience=1, stagnation_threshold=0.0,
+                        init_method="heatmap_sampling", focused_sampling=False, chunk_size=None, renumber="none",
+                        heatmap_scale=1 / 255):
+    """Solve B instances of city_num cities in num_threads worker processes.
+
+    The inputs are copied into one shared memory slab per batch of
+    `batch_size` instances (default: all of them), and the workers are kept
+    for the next calls. Each task solves `chunk_size` consecutive instances,
+    by default about four tasks per worker, so small instances do not pay
+    one round trip each. The results are in the order of the inputs.
+    uint8 and float16 heatmaps keep their dtype in the shared memory slab.
+    """
+    params = dict(alpha=alpha, beta=beta, param_h=param_h, param_t=param_t, max_candidate_num=max_candidate_num,
+                  candidate_use_heatmap=candidate_use_heatmap, max_depth=max_depth, log_len_time=log_len_time,
+                  debug=debug, restart_policy=restart_policy, kick_segment_len=kick_segment_len, metric=metric,
+                  mcts_patience=mcts_patience, stagnation_threshold=stagnation_threshold, init_method=init_method,
+                  focused_sampling=focused_sampling, renumber=renumber,
+                  heatmap_scale=heatmap_scale)
     total_instances = len(coordinates_list)
-    
-    # Determine batch size if not specified (default to processing all instances at once if total is small)
     if batch_size is None:
-        batch_size = min(total_instances, max(1, num_threads * 2))
-    
-    # Process instances in batches to limit memory consumption
+        batch_size = max(total_instances, 1)
+    executor = _get_executor(num_threads)
+
+    results = [None] * total_instances
     for batch_start in range(0, total_instances, batch_size):
         batch_end = min(batch_start + batch_size, total_instances)
-        batch_results = []
-        
-        # Use SharedMemoryManager to automatically handle cleanup
-        with SharedMemoryManager() as smm:
-            futures = []  # Track futures for later collection
-            
-            # Step 1: Use ProcessPoolExecutor for parallel processing
-            with concurrent.futures.ProcessPoolExecutor(max_workers=num_threads) as executor:
-                
-                for i in range(batch_start, batch_end):
-                    # Step 2: Create shared memory for this instance - only keep the shared memory objects
-                    shm_coords = create_shared_memory_for_one_instance(smm, coordinates_list[i])
-                    shm_solutions = create_shared_memory_for_one_instance(smm, opt_solutions[i])
-                    shm_heatmaps = create_shared_memory_for_one_instance(smm, heatmaps[i])
-                    
-                    # Step 3: Submit the task
-                    future = executor.submit(
-                        solve_one_instance_with_shared_memory,
-                        shm_coords.name, shm_solutions.name, shm_heatmaps.name,
-                        coordinates_list[i].shape, opt_solutions[i].shape, heatmaps[i].shape,
-                        coordinates_list[i].dtype, opt_solutions[i].dtype, heatmaps[i].dtype,
-                        city_num, alpha, beta, param_h, param_t, 
-                        max_candidate_num, candidate_use_heatmap, max_depth, log_len_time, debug
-                    )
-                    futures.append(future)
-                    
-                # Collect the results as they are completed
-                for future in concurrent.futures.as_completed(futures):
-                    result = future.result()
-                    batch_results.append(result)
-                    
-            # The SharedMemoryManager context will automatically clean up all shared memory
-        
-        # Add batch results to overall results
-        results.extend(batch_results)
+        batch_num = batch_end - batch_start
+        cur_chunk_size = chunk_size or max(1, min(batch_num // (4 * num_threads), 64))
+
+        slab, layout = create_shared_slab(dict(
+            coordinates=np.asarray(coordinates_list[batch_start:batch_end]),
+            opt_solutions=np.asarray(opt_solutions[batch_start:batch_end]),
+            heatmaps=np.asarray(heatmaps[batch_start:batch_end]),
+        ))
+        futures = []
+        try:
+            for begin in range(0, batch_num, cur_chunk_size):
+                futures.append(executor.submit(solve_chunk_of_slab, slab.name, layout, begin,
+                                               min(begin + cur_chunk_size, batch_num), city_num, params))
+            for future in concurrent.futures.as_completed(futures):
+                begin, chunk_results = future.result()
+                results[batch_start + begin:batch_start + begin + len(chunk_results)] = chunk_results
+        except concurrent.futures.process.BrokenProcessPool:
+            shutdown_workers()  # Start fresh workers on the next call
+            raise
+        finally:
+            for future in futures:
+                future.cancel()
+            slab.close()
+            slab.unlink()
 
-    # Gather the results
-    concorde_distances = [result.Concorde_Distance for result in results if result is not None]
-    mcts_distances = [result.MCTS_Distance for result in results if result is not None]
-    gaps = [result.Gap for result in results if result is not None]
-    times = [result.Time for result in results if result is not None]
-    overall_times = [result.Overall_Time for result in results if result is not None]
-    solutions = [result.Solution for result in results if result is not None]
-    lengths_times = [result.Length_Time for result in results if result is not None]
+    # Gather the results into contiguous arrays
+    concorde_distances = np.fromiter((result.Concorde_Distance for result in results), dtype=np.float64, count=len(results))
+    mcts_distances = np.fromiter((result.MCTS_Distance for result in results), dtype=np.float64, count=len(results))
+    gaps = np.fromiter((result.Gap for result in results), dtype=np.float64, count=len(results))
+    times = np.fromiter((result.Time for result in results), dtype=np.float64, count=len(results))
+    overall_times = np.fromiter((result.Overall_Time for result in results), dtype=np.float64, count=len(results))
+    solutions = np.empty((len(results), city_num), dtype=np.int32)
+    for i, result in enumerate(results):
+        solutions[i] = result.Solution
+    # The number of records differs between instances, so keep one (M, 2) array per instance
+    lengths_times = [result.Length_Time for result in results]
 
     return concorde_distances, mcts_distances, gaps, times, overall_times, solutions, lengths_times
@@ -0,0 +1,111 @@
+import asyncio
+
+from . import _mcts_cpp as mcts
+
+# Default search parameters of a pool, any of them can be overridden per submission
+DEFAULT_PARAMS = dict(
+    alpha=1,
+    beta=10,
+    param_h=10,
+    param_t=0.1,
+    max_candidate_num=5,
+    candidate_use_heatmap=1,
+    max_depth=10,
+    log_len_time=False,
+    debug=False,
+    restart_policy=0,
+    kick_segment_len=50,
+    mcts_patience=1,
+    stagnation_threshold=0.0,
+    init_method="heatmap_sampling",
+    focused_sampling=False,
+    checkpoint_path="",
+    checkpoint_interval=300.0,
+    resume_path="",
+    metric="EUC_2D",
+)
+
+class SolverFuture:
+    """Handle of an instance submitted to a SolverPool.
+
+    `result()` blocks with the GIL released, and the future can be awaited
+    from asyncio: the native worker wakes the event loop when it finishes.
+    """
+
+    def __init__(self, native_future):
+        self._native = native_future
+
+    def done(self):
+        return self._native.done()
+
+    def result(self, timeout=None):
+        return self._native.result(timeout)
+
+    def add_done_callback(self, fn):
+        self._native.add_done_callback(lambda _: fn(self))
+
+    def __await__(self):
+        loop = asyncio.get_running_loop()
+        future = loop.create_future()
+
+        def resolve():
+            if future.cancelled():
+                return
+            try:
+                future.set_result(self._native.result(0))
+            except Exception as e:
+                future.set_exception(e)
+
+        # Called from the native worker thread, hop back onto the event loop
+        self._native.add_done_callback(lambda _: loop.call_soon_threadsafe(resolve))
+        return future.__await__()
+
+class SolverPool:
+    """A fixed pool of native solver threads fed through a bounded queue.
+
+    `submit()` copies the instance and returns immediately, unless
+    `max_queue_size` instances are already waiting, in which case it blocks
+    (with the GIL released) until a worker frees a slot. This lets a heatmap
+    producer overlap with the search while keeping its memory bounded.
+
+    With `share_budget` and a positive `stagnation_threshold`, the time left
+    over by instances that stop on stagnation is lent to the instances of the
+    pool that are still improving when their own budget runs out.
+    """
+
+    def __init__(self, city_num, num_threads=0, max_queue_size=0, share_budget=False, **params):
+        unknown = set(params) - set(DEFAULT_PARAMS)
+        if unknown:
+            raise TypeError(f"Unknown parameters {sorted(unknown)}")
+        self.city_num = city_num
+        self.params = {**DEFAULT_PARAMS, **params}
+        self._native = mcts.SolverPool(num_threads, max_queue_size, share_budget)
+
+    @property
+    def num_threads(self):
+        return self._native.num_threads
+
+    @property
+    def queue_size(self):
+        return self._native.queue_size
+
+    def submit(self, coordinates, opt_solution, heatmap, **params) -> SolverFuture:
+        params = {**self.params, **params}
+        if (2 * params["max_depth"] > self.city_num):
+            raise ValueError("max_depth should be less than city_num/2")
+        return SolverFuture(self._native.submit(self.city_num, coordinates=coordinates, opt_solution=opt_solution,
+                                                heatmap=heatmap, **params))
+
+    def shutdown(self, cancel_queued=False):
+        """Stop accepting instances and wait for the workers to finish.
+
+        Queued instances are solved first, unless `cancel_queued` is set, in
+        which case their futures fail immediately.
+        """
+        self._native.shutdown(cancel_queued)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc_info):
+        self.shutdown()
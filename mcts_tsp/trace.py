@@ -0,0 +1,32 @@
+import contextlib
+
+from . import _mcts_cpp as mcts
+
+def start_trace(capacity=1 << 16):
+    """Record the solver phases of every thread of this process.
+
+    Each thread keeps its last `capacity` phases. The events recorded before
+    are discarded.
+    """
+    mcts.start_trace(capacity)
+
+def stop_trace():
+    mcts.stop_trace()
+
+def export_trace(path):
+    """Write the recorded phases to `path` as Chrome trace JSON.
+
+    Returns the number of phases written. Open the file in
+    chrome://tracing or https://ui.perfetto.dev.
+    """
+    return mcts.export_trace(path)
+
+@contextlib.contextmanager
+def trace(path, capacity=1 << 16):
+    """Record the solver phases run inside the block and export them to `path`."""
+    start_trace(capacity)
+    try:
+        yield
+    finally:
+        stop_trace()
+        export_trace(path)
@@ -0,0 +1,69 @@
+import itertools
+
+import numpy as np
+
+from . import _mcts_cpp as mcts
+
+# Parameters that can be tuned, with the value used when the grid omits them
+TUNABLE_PARAMS = dict(
+    alpha=1,
+    beta=10,
+    param_h=10,
+    max_depth=10,
+    max_candidate_num=5,
+)
+
+def tune_parameters(coordinates_list, opt_solutions, heatmaps, city_num, grid, min_param_t=0.01, eta=2,
+                    num_threads=0, candidate_use_heatmap=1, restart_policy=0, kick_segment_len=50,
+                    init_method="heatmap_sampling", focused_sampling=False, metric="EUC_2D"):
+    """Pick the best search parameters for a sample of instances by successive halving.
+
+    `grid` maps some of `alpha`, `beta`, `param_h`, `max_depth` and
+    `max_candidate_num` to lists of values, every combination is a
+    configuration. Round r runs the surviving configurations on all sample
+    instances with `param_t = min_param_t * eta**r` and keeps the best
+    1/eta of them, until one remains. The distance matrices (and candidate
+    sets when `candidate_use_heatmap` is 0 or 2) are computed once per
+    instance.
+
+    Returns the best configuration as a dict, and the quality-versus-time
+    table as a list of dicts, one per configuration and round.
+    """
+    unknown = set(grid) - set(TUNABLE_PARAMS)
+    if unknown:
+        raise TypeError(f"Unknown parameters {sorted(unknown)}, expected some of {list(TUNABLE_PARAMS)}")
+    names = list(TUNABLE_PARAMS)
+    values = [list(grid.get(name, [TUNABLE_PARAMS[name]])) for name in names]
+    configs = [dict(zip(names, combination)) for combination in itertools.product(*values)]
+    if not configs:
+        raise ValueError("The grid holds no configuration")
+
+    result = mcts.tune(
+        city_num,
+        np.array([config["alpha"] for config in configs], dtype=np.float64),
+        np.array([config["beta"] for config in configs], dtype=np.float64),
+        np.array([config["param_h"] for config in configs], dtype=np.float64),
+        np.array([config["max_depth"] for config in configs], dtype=np.int32),
+        np.array([config["max_candidate_num"] for config in configs], dtype=np.int32),
+        np.asarray(coordinates_list),
+        np.asarray(opt_solutions),
+        np.asarray(heatmaps),
+        candidate_use_heatmap=candidate_use_heatmap,
+        min_param_t=min_param_t,
+        eta=eta,
+        restart_policy=restart_policy,
+        kick_segment_len=kick_segment_len,
+        init_method=init_method,
+        focused_sampling=focused_sampling,
+        num_threads=num_threads,
+        metric=metric
+    )
+
+    table = [
+        dict(configs[config], round=int(round_), param_t=float(param_t), mean_distance=float(distance),
+             mean_gap=float(gap), mean_time=float(time), score=float(score))
+        for config, round_, param_t, distance, gap, time, score in zip(
+            result.Config, result.Round, result.Param_T, result.Mean_Distance, result.Mean_Gap, result.Mean_Time,
+            result.Score)
+    ]
+    return configs[result.Best_Config], table
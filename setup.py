@@ -13,6 +13,7 @@ ext_modules = [
         "mcts_tsp._mcts_cpp",
         ["src/code/mcts.cpp"],
         define_macros=[("VERSION_INFO", get_version())],
+        cxx_std=17,
     ),
 ]
 
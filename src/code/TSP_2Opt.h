@@ -2,6 +2,7 @@
 #define TSP_2OPT_H
 
 #include "TSP_Basic_Functions.h"
+#include "TSP_Checkpoint.h"
 
 // Evaluate the delta after applying a 2-opt move (delta >0 indicates an
 // improving solution)
@@ -21,6 +22,8 @@ Distance_Type Get_2Opt_Delta(int First_City, int Second_City)
     // Chosen_Times[Second_City][First_City]++;
     Chosen_Times[First_Next_City][Second_Next_City]++;
     // Chosen_Times[Second_Next_City][First_Next_City]++;
+    Log_Edge_Change(First_City, Second_City);
+    Log_Edge_Change(First_Next_City, Second_Next_City);
     Total_Simulation_Times++;
 
     return Delta;
@@ -49,6 +52,10 @@ void Apply_2Opt_Move(int First_City, int Second_City)
     Weight[Second_City][First_City] += Increase_Rate;
     Weight[First_Next_City][Second_Next_City] += Increase_Rate;
     Weight[Second_Next_City][First_Next_City] += Increase_Rate;
+    Log_Edge_Change(First_City, Second_City);
+    Log_Edge_Change(Second_City, First_City);
+    Log_Edge_Change(First_Next_City, Second_Next_City);
+    Log_Edge_Change(Second_Next_City, First_Next_City);
 }
 
 bool Improve_By_2Opt_Move()
@@ -73,14 +80,10 @@ bool Improve_By_2Opt_Move()
     return If_Improved;
 }
 
-// Iteratively apply an improving 2-opt move until no improvement is possible
-void Local_Search_by_2Opt_Move()
+// Store the incumbent tour to Struct_Node *Best_All_Node if it improves the
+// best found solution
+void Update_Best_Solution()
 {
-    while (Improve_By_2Opt_Move() == true)
-        ;
-    if (MCTS_Debug)
-        cout << "Local search by 2-opt move finished." << endl;
-
     Distance_Type Cur_Solution_Total_Distance = Get_Solution_Total_Distance();
     if (Cur_Solution_Total_Distance < Current_Instance_Best_Distance)
     {
@@ -96,4 +99,73 @@ void Local_Search_by_2Opt_Move()
     }
 }
 
+// Iteratively apply an improving 2-opt move until no improvement is possible
+void Local_Search_by_2Opt_Move()
+{
+    while (Improve_By_2Opt_Move() == true)
+        ;
+    if (MCTS_Debug)
+        cout << "Local search by 2-opt move finished." << endl;
+
+    Update_Best_Solution();
+}
+
+// Push a city to the queue of cities examined by the restricted local search
+void Activate_City(int Cur_City)
+{
+    if (If_City_Active[Cur_City])
+        return;
+
+    Active_City[(Active_City_Head + Active_City_Num) % Virtual_City_Num] = Cur_City;
+    Active_City_Num++;
+    If_City_Active[Cur_City] = true;
+}
+
+// Pop the next city to be examined by the restricted local search
+int Pop_Active_City()
+{
+    int Cur_City = Active_City[Active_City_Head];
+    Active_City_Head = (Active_City_Head + 1) % Virtual_City_Num;
+    Active_City_Num--;
+    If_City_Active[Cur_City] = false;
+
+    return Cur_City;
+}
+
+// Try the 2-opt moves between Cur_City and its candidates, the endpoints of an
+// applied move are activated again
+bool Improve_Active_City_By_2Opt_Move(int Cur_City)
+{
+    for (int j = 0; j < Candidate_Num[Cur_City]; j++)
+    {
+        int Candidate_City = Candidate[Cur_City][j];
+        if (Get_2Opt_Delta(Cur_City, Candidate_City) > 0)
+        {
+            int First_Next_City = All_Node[Cur_City].Next_City;
+            int Second_Next_City = All_Node[Candidate_City].Next_City;
+            Apply_2Opt_Move(Cur_City, Candidate_City);
+
+            Activate_City(Cur_City);
+            Activate_City(Candidate_City);
+            Activate_City(First_Next_City);
+            Activate_City(Second_Next_City);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Apply improving 2-opt moves only around the activated cities (e.g. the
+// region perturbed by a kick), until none of them can be improved
+void Local_Search_by_2Opt_Move_Around_Active_Cities()
+{
+    while (Active_City_Num > 0)
+        Improve_Active_City_By_2Opt_Move(Pop_Active_City());
+    if (MCTS_Debug)
+        cout << "Restricted local search by 2-opt move finished." << endl;
+
+    Update_Best_Solution();
+}
+
 #endif // TSP_2OPT_H
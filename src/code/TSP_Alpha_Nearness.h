@@ -0,0 +1,363 @@
+#ifndef TSP_ALPHA_NEARNESS_H
+#define TSP_ALPHA_NEARNESS_H
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <queue>
+
+#include "TSP_Basic_Functions.h"
+
+// Alpha-nearness candidates (Helsgaun, LKH): alpha(i,j) is the increase of the
+// cost of a minimum 1-tree forced to contain the edge (i,j). The 1-tree is
+// taken under node penalties Pi[], raised by subgradient optimization until it
+// is as close to a tour as the ascent gets, so that its edges and alpha predict
+// the edges of good tours much better than the distance does. On large
+// instances the ascent only sees a sparse graph: the nearest cities of each
+// city, plus a minimum spanning tree that keeps the graph connected
+
+#define Dense_Graph_Max_City_Num 200 // smaller instances run the ascent on the complete graph
+#define Sparse_Graph_Degree 10       // nearest cities of each city in the sparse graph
+#define Max_Ascent_Period 50         // iterations of the first period of the ascent
+#define Max_Ascent_Iteration 500     // minimum 1-trees computed by the ascent at most
+
+// Graph of the ascent, the neighbors of city i are Neighbor[Begin[i]..Begin[i+1]).
+// The distances are copied along, the ascent reads them many times
+struct Ascent_Graph
+{
+    vector<int> Begin;
+    vector<int> Neighbor;
+    vector<Distance_Type> Cost;
+};
+
+// Minimum 1-tree under the penalties Pi[]: a minimum spanning tree (Dad[],
+// Prim order in Order[]) plus the edge (Special_City, Special_Neighbor)
+struct One_Tree
+{
+    vector<int> Dad;
+    vector<int> Order;
+    vector<int> Degree;
+    int Special_City;
+    int Special_Neighbor;
+    long long Cost; // including the penalties, W(Pi) = Cost - 2 * sum(Pi)
+};
+
+long long Get_Penalized_Distance(int First_City, int Second_City, const vector<int> &Pi)
+{
+    return (long long)Get_Distance(First_City, Second_City) + Pi[First_City] + Pi[Second_City];
+}
+
+bool If_Build_Cancelled(const std::atomic<bool> *If_Cancelled)
+{
+    return If_Cancelled != NULL && If_Cancelled->load(std::memory_order_relaxed);
+}
+
+// The complete graph on small instances, otherwise the Sparse_Graph_Degree
+// nearest cities of each city and the edges of a minimum spanning tree. The
+// sparse graph takes O(N^2) time: its construction is abandoned once
+// If_Cancelled is set, and false is then returned
+bool Build_Ascent_Graph(Ascent_Graph &Graph, const std::atomic<bool> *If_Cancelled = NULL)
+{
+    int N = Virtual_City_Num;
+    vector<std::pair<int, int>> Edge;
+    if (N <= Dense_Graph_Max_City_Num)
+    {
+        for (int i = 0; i < N; i++)
+            for (int j = 0; j < N; j++)
+                if (j != i && Get_Distance(i, j) < Inf_Cost)
+                    Edge.push_back(std::make_pair(i, j));
+    }
+    else
+    {
+        vector<int> Nearest_City(Sparse_Graph_Degree);
+        vector<double> Key(Sparse_Graph_Degree);
+        for (int i = 0; i < N; i++)
+        {
+            if (If_Build_Cancelled(If_Cancelled))
+                return false;
+            Top_Candidate_List List;
+            List.Init(Nearest_City.data(), Key.data(), Sparse_Graph_Degree);
+            for (int j = 0; j < N; j++)
+                if (j != i && Get_Distance(i, j) < Inf_Cost)
+                    List.Offer(j, -(double)Get_Distance(i, j));
+            for (int k = 0; k < List.Size; k++)
+            {
+                Edge.push_back(std::make_pair(i, Nearest_City[k]));
+                Edge.push_back(std::make_pair(Nearest_City[k], i));
+            }
+        }
+
+        // Prim on the complete graph, in O(N^2)
+        vector<Distance_Type> Link_Distance(N, Inf_Cost);
+        vector<int> Link_City(N, Null);
+        vector<char> If_In_Tree(N, false);
+        for (int Cur_City = 0; Cur_City != Null;)
+        {
+            if (If_Build_Cancelled(If_Cancelled))
+                return false;
+            If_In_Tree[Cur_City] = true;
+            if (Link_City[Cur_City] != Null)
+            {
+                Edge.push_back(std::make_pair(Cur_City, Link_City[Cur_City]));
+                Edge.push_back(std::make_pair(Link_City[Cur_City], Cur_City));
+            }
+            int Next_City = Null;
+            for (int j = 0; j < N; j++)
+            {
+                if (If_In_Tree[j])
+                    continue;
+                if (Get_Distance(Cur_City, j) < Link_Distance[j])
+                {
+                    Link_Distance[j] = Get_Distance(Cur_City, j);
+                    Link_City[j] = Cur_City;
+                }
+                if (Link_City[j] != Null && (Next_City == Null || Link_Distance[j] < Link_Distance[Next_City]))
+                    Next_City = j;
+            }
+            Cur_City = Next_City;
+        }
+    }
+
+    sort(Edge.begin(), Edge.end());
+    Edge.erase(unique(Edge.begin(), Edge.end()), Edge.end());
+    Graph.Begin.assign(N + 1, 0);
+    Graph.Neighbor.resize(Edge.size());
+    Graph.Cost.resize(Edge.size());
+    for (size_t k = 0; k < Edge.size(); k++)
+    {
+        Graph.Begin[Edge[k].first + 1]++;
+        Graph.Neighbor[k] = Edge[k].second;
+        Graph.Cost[k] = Get_Distance(Edge[k].first, Edge[k].second);
+    }
+    for (int i = 0; i < N; i++)
+        Graph.Begin[i + 1] += Graph.Begin[i];
+    return true;
+}
+
+// Compute the minimum 1-tree of the graph under the penalties Pi[]. The extra
+// edge is the second cheapest edge of the leaf where it is the most expensive,
+// as in LKH. Return false if the graph is not connected
+bool Compute_Minimum_One_Tree(const Ascent_Graph &Graph, const vector<int> &Pi, One_Tree &Tree)
+{
+    int N = Virtual_City_Num;
+    Tree.Dad.assign(N, Null);
+    Tree.Order.clear();
+    Tree.Degree.assign(N, 0);
+    Tree.Cost = 0;
+
+    vector<long long> Link_Cost(N, LLONG_MAX);
+    vector<char> If_In_Tree(N, false);
+    std::priority_queue<std::pair<long long, int>, vector<std::pair<long long, int>>,
+                        std::greater<std::pair<long long, int>>>
+        Queue;
+    Link_Cost[0] = 0;
+    Queue.push(std::make_pair(0LL, 0));
+    while (!Queue.empty())
+    {
+        int Cur_City = Queue.top().second;
+        Queue.pop();
+        if (If_In_Tree[Cur_City])
+            continue;
+        If_In_Tree[Cur_City] = true;
+        Tree.Order.push_back(Cur_City);
+        if (Tree.Dad[Cur_City] != Null)
+        {
+            Tree.Cost += Link_Cost[Cur_City];
+            Tree.Degree[Cur_City]++;
+            Tree.Degree[Tree.Dad[Cur_City]]++;
+        }
+
+        for (int k = Graph.Begin[Cur_City]; k < Graph.Begin[Cur_City + 1]; k++)
+        {
+            int Neighbor = Graph.Neighbor[k];
+            long long Cost = (long long)Graph.Cost[k] + Pi[Cur_City] + Pi[Neighbor];
+            if (!If_In_Tree[Neighbor] && Cost < Link_Cost[Neighbor])
+            {
+                Link_Cost[Neighbor] = Cost;
+                Tree.Dad[Neighbor] = Cur_City;
+                Queue.push(std::make_pair(Cost, Neighbor));
+            }
+        }
+    }
+    if ((int)Tree.Order.size() < N)
+        return false;
+
+    Tree.Special_City = Tree.Special_Neighbor = Null;
+    long long Special_Cost = LLONG_MIN;
+    for (int i = 0; i < N; i++)
+    {
+        if (Tree.Degree[i] != 1)
+            continue;
+        int Best_Neighbor = Null;
+        long long Best_Cost = LLONG_MAX;
+        for (int k = Graph.Begin[i]; k < Graph.Begin[i + 1]; k++)
+        {
+            int Neighbor = Graph.Neighbor[k];
+            if (Neighbor == Tree.Dad[i] || Tree.Dad[Neighbor] == i)
+                continue;
+            long long Cost = (long long)Graph.Cost[k] + Pi[i] + Pi[Neighbor];
+            if (Cost < Best_Cost)
+            {
+                Best_Cost = Cost;
+                Best_Neighbor = Neighbor;
+            }
+        }
+        if (Best_Neighbor != Null && Best_Cost > Special_Cost)
+        {
+            Special_Cost = Best_Cost;
+            Tree.Special_City = i;
+            Tree.Special_Neighbor = Best_Neighbor;
+        }
+    }
+    if (Tree.Special_City != Null)
+    {
+        Tree.Cost += Special_Cost;
+        Tree.Degree[Tree.Special_City]++;
+        Tree.Degree[Tree.Special_Neighbor]++;
+    }
+    return true;
+}
+
+// Subgradient optimization of the penalties (the ascent of LKH): move Pi[]
+// along the degree excess of the cities, doubling the step while the lower
+// bound W(Pi) keeps improving in the initial phase, then halving the step and
+// the period. Pi[] ends at the best bound found, which is returned. The
+// ascent stops early, keeping the best penalties, once If_Cancelled is set
+long long Optimize_Penalties(const Ascent_Graph &Graph, vector<int> &Pi, One_Tree &Tree,
+                             const std::atomic<bool> *If_Cancelled = NULL)
+{
+    int N = Virtual_City_Num;
+    auto Get_Bound = [&]() {
+        long long Bound = Tree.Cost;
+        for (int i = 0; i < N; i++)
+            Bound -= 2LL * Pi[i];
+        return Bound;
+    };
+
+    Pi.assign(N, 0);
+    if (!Compute_Minimum_One_Tree(Graph, Pi, Tree))
+        return LLONG_MIN;
+
+    long long Best_Bound = Get_Bound();
+    vector<int> Best_Pi(Pi);
+    vector<int> Last_V(N);
+    for (int i = 0; i < N; i++)
+        Last_V[i] = Tree.Degree[i] - 2;
+
+    long long Step = 1;
+    int Period = max(1, min(N / 2, Max_Ascent_Period));
+    int Iteration = 0;
+    bool If_Initial_Phase = true;
+    auto If_Stop = [&]() {
+        if (If_Cancelled != NULL && If_Cancelled->load(std::memory_order_relaxed))
+            return true;
+        for (int i = 0; i < N; i++)
+            if (Tree.Degree[i] != 2)
+                return false;
+        return true;
+    };
+    for (; Step > 0 && Period > 0 && !If_Stop() && Iteration < Max_Ascent_Iteration; Period /= 2, Step /= 2)
+    {
+        for (int P = 1; Step > 0 && P <= Period && !If_Stop() && Iteration < Max_Ascent_Iteration; P++)
+        {
+            for (int i = 0; i < N; i++)
+            {
+                int V = Tree.Degree[i] - 2;
+                if (V != 0)
+                    Pi[i] += Step * (7 * V + 3 * Last_V[i]) / 10;
+                Last_V[i] = V;
+            }
+            Compute_Minimum_One_Tree(Graph, Pi, Tree);
+            Iteration++;
+
+            long long Bound = Get_Bound();
+            if (Bound > Best_Bound)
+            {
+                Best_Bound = Bound;
+                Best_Pi = Pi;
+                if (If_Initial_Phase)
+                    Step *= 2;
+                if (P == Period)
+                    Period *= 2;
+            }
+            else if (If_Initial_Phase && P > Period / 2)
+            {
+                If_Initial_Phase = false;
+                P = 0;
+                Step = 3 * Step / 4;
+            }
+        }
+    }
+
+    Pi = Best_Pi;
+    Compute_Minimum_One_Tree(Graph, Pi, Tree);
+    return Best_Bound;
+}
+
+// Identify the candidates of each city by increasing alpha (ties by distance),
+// or, if Candidate_Use_Heatmap is Candidate_Alpha_Heatmap, by decreasing
+// Edge_Heatmap[i][j] - alpha(i,j) / (length of an average 1-tree edge).
+// Alpha is computed for all pairs in O(N^2) time and O(N) space, by sweeping
+// the tree once per city
+void Identify_Alpha_Nearness_Candidate_Set()
+{
+    int N = Virtual_City_Num;
+    Ascent_Graph Graph;
+    Build_Ascent_Graph(Graph);
+    vector<int> Pi;
+    One_Tree Tree;
+    long long Bound = Optimize_Penalties(Graph, Pi, Tree);
+    if (Bound == LLONG_MIN)
+    {
+        // Some cities cannot be reached, fall back on the nearest cities
+        int Mode = Candidate_Use_Heatmap;
+        Candidate_Use_Heatmap = Candidate_Nearest;
+        Identify_Candidate_Set();
+        Candidate_Use_Heatmap = Mode;
+        return;
+    }
+    double Alpha_Scale = max(1.0, (double)Bound / N);
+
+    // Beta[j]: most expensive edge on the tree path between the current city
+    // and j. The tree edges are read from Dad_Cost[] rather than from the
+    // rows of Distance[][], which the sweeps would visit in random order
+    vector<long long> Dad_Cost(N, 0);
+    for (int i = 0; i < N; i++)
+        if (Tree.Dad[i] != Null)
+            Dad_Cost[i] = Get_Penalized_Distance(i, Tree.Dad[i], Pi);
+    vector<long long> Beta(N);
+    vector<int> Mark(N, Null);
+    vector<double> Key(max(Max_Candidate_Num, 1));
+    for (int i = 0; i < N; i++)
+    {
+        Beta[i] = LLONG_MIN;
+        Mark[i] = i;
+        for (int Cur_City = i; Tree.Dad[Cur_City] != Null; Cur_City = Tree.Dad[Cur_City])
+        {
+            int Dad = Tree.Dad[Cur_City];
+            Beta[Dad] = max(Beta[Cur_City], Dad_Cost[Cur_City]);
+            Mark[Dad] = i;
+        }
+        for (int Cur_City : Tree.Order)
+            if (Mark[Cur_City] != i)
+                Beta[Cur_City] = max(Beta[Tree.Dad[Cur_City]], Dad_Cost[Cur_City]);
+
+        Top_Candidate_List List;
+        List.Init(Candidate[i], Key.data(), Max_Candidate_Num);
+        for (int j = 0; j < N; j++)
+        {
+            if (j == i || Get_Distance(i, j) >= Inf_Cost)
+                continue;
+            bool If_Special_Edge = (i == Tree.Special_City && j == Tree.Special_Neighbor) ||
+                                   (j == Tree.Special_City && i == Tree.Special_Neighbor);
+            double Alpha = If_Special_Edge ? 0 : (double)(Get_Penalized_Distance(i, j, Pi) - Beta[j]);
+            if (Candidate_Use_Heatmap == Candidate_Alpha_Heatmap)
+                List.Offer(j, Get_Edge_Heatmap(i, j) - Alpha / Alpha_Scale);
+            else
+                List.Offer(j, -(Alpha + (double)Get_Distance(i, j) / Inf_Cost));
+        }
+        Candidate_Num[i] = List.Size;
+    }
+}
+
+#endif // TSP_ALPHA_NEARNESS_H
@@ -2,39 +2,45 @@
 #define TSP_BASIC_FUNCTIONS_H
 
 #include "TSP_IO.h"
+#include "TSP_Metric.h"
 
-// Return an integer between [0,Divide_Num)
+// Seed the random number generator of the calling thread
+void Set_Random_Seed(unsigned long long Seed)
+{
+    Random_State = Seed ? Seed : Default_Random_Seed;
+}
+
+// Return an integer between [0,Divide_Num). Each thread owns its generator
+// (xorshift64*), so concurrent solves neither contend on nor perturb each other
 int Get_Random_Int(int Divide_Num)
 {
-    return rand() % Divide_Num;
+    Random_State ^= Random_State >> 12;
+    Random_State ^= Random_State << 25;
+    Random_State ^= Random_State >> 27;
+    return (int)(((Random_State * 2685821657736338717ULL) >> 33) % Divide_Num);
 }
 
-// Calculate the distance between two cities, rounded up to the nearest
-Distance_Type Calculate_Int_Distance(int First_City, int Second_City)
+// Calculate the distance between two cities, rounded to an integer as
+// defined by the metric
+template <typename Metric = Metric_EUC_2D> Distance_Type Calculate_Int_Distance(int First_City, int Second_City)
 {
-    return (Distance_Type)(0.5 + sqrt((Coordinate_X[First_City] - Coordinate_X[Second_City]) *
-                                (Coordinate_X[First_City] - Coordinate_X[Second_City]) +
-                            (Coordinate_Y[First_City] - Coordinate_Y[Second_City]) *
-                                (Coordinate_Y[First_City] - Coordinate_Y[Second_City])));
+    return Metric::Int_Distance(First_City, Second_City);
 }
 
 // Calculate the distance between two cities
-double Calculate_Double_Distance(int First_City, int Second_City)
+template <typename Metric = Metric_EUC_2D> double Calculate_Double_Distance(int First_City, int Second_City)
 {
-    return sqrt((Coordinate_X[First_City] - Coordinate_X[Second_City]) *
-                    (Coordinate_X[First_City] - Coordinate_X[Second_City]) +
-                (Coordinate_Y[First_City] - Coordinate_Y[Second_City]) *
-                    (Coordinate_Y[First_City] - Coordinate_Y[Second_City]));
+    return Metric::Double_Distance(First_City, Second_City);
 }
 
 // Calculate the distance (integer) between any two cities, stored in Distance[][]
-void Calculate_All_Pair_Distance()
+template <typename Metric = Metric_EUC_2D> void Calculate_All_Pair_Distance()
 {
     for (int i = 0; i < Virtual_City_Num; i++)
         for (int j = 0; j < Virtual_City_Num; j++)
         {
             if (i != j)
-                Distance[i][j] = Calculate_Int_Distance(i, j);
+                Distance[i][j] = Calculate_Int_Distance<Metric>(i, j);
             else
                 Distance[i][j] = Inf_Cost;
         }
@@ -46,6 +52,84 @@ Distance_Type Get_Distance(int First_City, int Second_City)
     return Distance[First_City][Second_City];
 }
 
+// Convert IEEE half precision bits to a float, exactly
+inline float Half_To_Float(uint16_t Half)
+{
+    uint32_t Sign = (uint32_t)(Half & 0x8000) << 16;
+    uint32_t Exponent = (Half >> 10) & 0x1f;
+    uint32_t Mantissa = Half & 0x3ff;
+    if (Exponent == 0)
+    {
+        float Value = Mantissa * 5.9604644775390625e-8f; // subnormal: Mantissa x 2^-24
+        return Sign ? -Value : Value;
+    }
+
+    uint32_t Bits = Exponent == 0x1f ? Sign | 0x7f800000 | (Mantissa << 13)
+                                     : Sign | ((Exponent + 112) << 23) | (Mantissa << 13);
+    float Value;
+    memcpy(&Value, &Bits, sizeof(Value));
+    return Value;
+}
+
+// Convert a float to IEEE half precision bits, rounding to nearest even
+inline uint16_t Float_To_Half(float Value)
+{
+    uint32_t Bits;
+    memcpy(&Bits, &Value, sizeof(Bits));
+    uint32_t Sign = (Bits >> 16) & 0x8000;
+    uint32_t Abs = Bits & 0x7fffffff;
+    if (Abs >= 0x7f800000)
+        return Sign | 0x7c00 | (Abs > 0x7f800000 ? 0x200 : 0); // infinity or NaN
+    if (Abs < 0x33000000)
+        return Sign; // below half the smallest subnormal
+
+    uint32_t Half, Remainder, Halfway;
+    if (Abs < 0x38800000)
+    {
+        // Subnormal: the value is Mantissa x 2^(Exponent - 150)
+        int Shift = 126 - (int)(Abs >> 23);
+        uint32_t Mantissa = (Abs & 0x7fffff) | 0x800000;
+        Half = Mantissa >> Shift;
+        Remainder = Mantissa & ((1u << Shift) - 1);
+        Halfway = 1u << (Shift - 1);
+    }
+    else
+    {
+        // Rebias the exponent, values too large carry into infinity
+        if (Abs >= 0x47800000)
+            return Sign | 0x7c00;
+        Half = (Abs - 0x38000000) >> 13;
+        Remainder = Abs & 0x1fff;
+        Halfway = 0x1000;
+    }
+    if (Remainder > Halfway || (Remainder == Halfway && (Half & 1)))
+        Half++;
+    return Sign | Half;
+}
+
+// Fetch the symmetrized heatmap value of an edge, dequantized from the
+// storage format of the heatmap
+inline float Get_Edge_Heatmap(int First_City, int Second_City)
+{
+    if (Heatmap_Format == Heatmap_Float16)
+        return Half_To_Float(Edge_Heatmap_Half[First_City][Second_City]);
+    if (Heatmap_Format == Heatmap_UInt8)
+        return Edge_Heatmap_Byte[First_City][Second_City] * (float)Heatmap_Scale;
+    return Edge_Heatmap[First_City][Second_City];
+}
+
+// Store the heatmap value of an edge, quantized to the storage format
+inline void Set_Edge_Heatmap(int First_City, int Second_City, float Value)
+{
+    if (Heatmap_Format == Heatmap_Float16)
+        Edge_Heatmap_Half[First_City][Second_City] = Float_To_Half(Value);
+    else if (Heatmap_Format == Heatmap_UInt8)
+        Edge_Heatmap_Byte[First_City][Second_City] =
+            (uint8_t)min(max(lround(Value / Heatmap_Scale), 0L), 255L);
+    else
+        Edge_Heatmap[First_City][Second_City] = Value;
+}
+
 // Using the information stored in Solution[] to update the information stored
 // in Struct_Node *All_Node
 void Convert_Solution_To_All_Node()
@@ -145,27 +229,27 @@ Distance_Type Get_Solution_Total_Distance()
     return Solution_Total_Distance;
 }
 
-double Get_Stored_Solution_Double_Distance()
+template <typename Metric = Metric_EUC_2D> double Get_Stored_Solution_Double_Distance()
 {
     double Stored_Solution_Double_Distance = 0;
     for (int i = 0; i < Virtual_City_Num - 1; i++)
-        Stored_Solution_Double_Distance += Calculate_Double_Distance(Opt_Solution[i], Opt_Solution[i + 1]);
+        Stored_Solution_Double_Distance += Calculate_Double_Distance<Metric>(Opt_Solution[i], Opt_Solution[i + 1]);
 
-    Stored_Solution_Double_Distance += Calculate_Double_Distance(Opt_Solution[Virtual_City_Num - 1], Opt_Solution[0]);
+    Stored_Solution_Double_Distance += Calculate_Double_Distance<Metric>(Opt_Solution[Virtual_City_Num - 1], Opt_Solution[0]);
     return Stored_Solution_Double_Distance;
 }
 
 // For TSP20-50-100 instances
 //  Return the total distance (double) of the solution stored in Struct_Node
 //  *All_Node
-double Get_Current_Solution_Double_Distance()
+template <typename Metric = Metric_EUC_2D> double Get_Current_Solution_Double_Distance()
 {
     double Current_Solution_Double_Distance = 0;
     for (int i = 0; i < Virtual_City_Num; i++)
     {
         int Temp_Next_City = All_Node[i].Next_City;
         if (Temp_Next_City != Null)
-            Current_Solution_Double_Distance += Calculate_Double_Distance(i, Temp_Next_City);
+            Current_Solution_Double_Distance += Calculate_Double_Distance<Metric>(i, Temp_Next_City);
         else
         {
             printf("\nGet_Current_Solution_Double_Distance() fail!\n");
@@ -187,11 +271,12 @@ int Get_Best_Unselected_City(int Cur_City)
         if (i == Cur_City || If_City_Selected[i] || Get_Distance(Cur_City, i) >= Inf_Cost)
             continue;
 
-        if (Best_Unselected_City == Null || Edge_Heatmap[Cur_City][i] > Edge_Heatmap[Cur_City][Best_Unselected_City])
+        if (Best_Unselected_City == Null ||
+            Get_Edge_Heatmap(Cur_City, i) > Get_Edge_Heatmap(Cur_City, Best_Unselected_City))
             Best_Unselected_City = i;
     }
 
-    if (Edge_Heatmap[Cur_City][Best_Unselected_City] >= 0.0001)
+    if (Get_Edge_Heatmap(Cur_City, Best_Unselected_City) >= 0.0001)
         return Best_Unselected_City;
     else
         return Null;
@@ -213,33 +298,70 @@ int Get_Nearest_Unselected_City(int Cur_City)
     return Neareast_Unselected_City;
 }
 
+// The Max_Size cities with the largest keys seen so far, sorted by
+// decreasing key. On equal keys the city offered first stays ahead, so
+// offering the cities by increasing index selects the same cities, in the
+// same order, as repeatedly taking the best unselected one
+struct Top_Candidate_List
+{
+    int *City;
+    double *Key;
+    int Size;
+    int Max_Size;
+
+    void Init(int *City_Buffer, double *Key_Buffer, int Max_List_Size)
+    {
+        City = City_Buffer;
+        Key = Key_Buffer;
+        Size = 0;
+        Max_Size = Max_List_Size;
+    }
+
+    inline void Offer(int Cur_City, double Cur_Key)
+    {
+        if (Size == Max_Size && (Size == 0 || !(Cur_Key > Key[Size - 1])))
+            return;
+
+        int Pos = Size < Max_Size ? Size++ : Size - 1;
+        while (Pos > 0 && Key[Pos - 1] < Cur_Key)
+        {
+            City[Pos] = City[Pos - 1];
+            Key[Pos] = Key[Pos - 1];
+            Pos--;
+        }
+        City[Pos] = Cur_City;
+        Key[Pos] = Cur_Key;
+    }
+};
+
 // Modified for ICML
 // Identify a set of candidate neighbors for each city, stored in
-// Candidate_Num[] and Candidate[][]
+// Candidate_Num[] and Candidate[][]: the Max_Candidate_Num cities with the
+// highest heatmap value (at least 0.0001), or the nearest ones. Each row is
+// scanned once. The alpha-nearness modes are handled in TSP_Alpha_Nearness.h
 void Identify_Candidate_Set()
 {
-    for (int i = 0; i < Virtual_City_Num; i++)
+    if (Candidate_Use_Heatmap == Candidate_Alpha_Nearness || Candidate_Use_Heatmap == Candidate_Alpha_Heatmap)
     {
-        Candidate_Num[i] = 0;
+        Identify_Alpha_Nearness_Candidate_Set();
+        return;
+    }
 
+    vector<double> Key(max(Max_Candidate_Num, 1));
+    for (int i = 0; i < Virtual_City_Num; i++)
+    {
+        Top_Candidate_List List;
+        List.Init(Candidate[i], Key.data(), Max_Candidate_Num);
         for (int j = 0; j < Virtual_City_Num; j++)
-            If_City_Selected[j] = false;
-
-        while (true)
         {
-            int Unselected_City = Null;
-            if (Candidate_Use_Heatmap)
-                Unselected_City = Get_Best_Unselected_City(i);
-            else
-                Unselected_City = Get_Nearest_Unselected_City(i);
-            if (Unselected_City != Null && Candidate_Num[i] < Max_Candidate_Num)
-            {
-                Candidate[i][Candidate_Num[i]++] = Unselected_City;
-                If_City_Selected[Unselected_City] = true;
-            }
-            else
-                break;
+            if (j == i || Get_Distance(i, j) >= Inf_Cost)
+                continue;
+            if (Candidate_Use_Heatmap == Candidate_Nearest)
+                List.Offer(j, -(double)Get_Distance(i, j));
+            else if (Get_Edge_Heatmap(i, j) >= 0.0001)
+                List.Offer(j, Get_Edge_Heatmap(i, j));
         }
+        Candidate_Num[i] = List.Size;
     }
 }
 
@@ -0,0 +1,448 @@
+#ifndef TSP_C_API_H
+#define TSP_C_API_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#include "TSP_Ensemble.h"
+#include "mcts_tsp.h"
+
+// Implementation of the C interface declared in mcts_tsp.h. Like the rest of
+// the solver it is header-only: it is compiled by mcts_tsp.cpp into
+// libmcts_tsp, and by mcts.cpp into the Python module, which calls it
+
+struct mcts_tsp_solver
+{
+    Search_Param Param{1, 10, 10, 0.1, 5, Candidate_Heatmap, 10, Restart_Random, 50, Init_Heatmap_Sampling, false,
+                       1, 0, false, false, "", 300, ""};
+    int Metric_Id = Metric_Id_EUC_2D;
+    int Thread_Num = 0;
+    int Prior_Weight_City_Num = 0; // 0: no prior weight
+    Sparse_Edge_Weight Prior_Weight;
+    std::atomic<unsigned> Cancel_Epoch{0};
+};
+
+struct mcts_tsp_result
+{
+    TSP_Output Output;
+    bool If_Cancelled = false;
+};
+
+// The helpers below are not part of the interface: they are given internal
+// linkage, so that libmcts_tsp only exports the mcts_tsp_* functions
+namespace
+{
+
+thread_local std::string C_API_Last_Error;
+
+// Record the message of an error for mcts_tsp_last_error(), return its code
+int Set_C_API_Error(int Code, const std::string &Message)
+{
+    C_API_Last_Error = Message;
+    return Code;
+}
+
+// Check the arguments of a solve of city_num cities, shared by the single and
+// batch entry points
+int Check_C_API_Instance(const mcts_tsp_solver *Solver, int City_Num, const double *Coordinates,
+                         const int *Distance_Matrix, const void *Heatmap)
+{
+    if (Solver == NULL)
+        return Set_C_API_Error(MCTS_TSP_ERROR_INVALID_ARGUMENT, "solver is NULL");
+    if (2 * Solver->Param.Max_Depth > City_Num)
+        return Set_C_API_Error(MCTS_TSP_ERROR_INVALID_ARGUMENT, "max_depth should be less than city_num/2");
+    if (Solver->Metric_Id == Metric_Id_Explicit ? Distance_Matrix == NULL : Coordinates == NULL)
+        return Set_C_API_Error(MCTS_TSP_ERROR_INVALID_ARGUMENT,
+                               Solver->Metric_Id == Metric_Id_Explicit ? "distance_matrix is NULL"
+                                                                       : "coordinates is NULL");
+    if (Heatmap == NULL && (Solver->Param.Candidate_Use_Heatmap == Candidate_Heatmap ||
+                            Solver->Param.Candidate_Use_Heatmap == Candidate_Alpha_Heatmap))
+        return Set_C_API_Error(MCTS_TSP_ERROR_INVALID_ARGUMENT, "heatmap is NULL but the candidates depend on it");
+    return MCTS_TSP_OK;
+}
+
+// Solve one instance in the calling thread, recording the cancellations of
+// the solver issued since Start_Epoch
+mcts_tsp_result *Solve_C_API_Instance(mcts_tsp_solver *Solver, unsigned Start_Epoch, int City_Num,
+                                      const double *Coordinates, const int *Distance_Matrix, const int *Opt_Tour,
+                                      const void *Heatmap, const Sparse_Edge_Weight *Prior_Weight)
+{
+    vector<int> Identity_Tour;
+    if (Opt_Tour == NULL)
+    {
+        Identity_Tour.resize(City_Num);
+        for (int i = 0; i < City_Num; i++)
+            Identity_Tour[i] = i;
+        Opt_Tour = Identity_Tour.data();
+    }
+
+    std::unique_ptr<mcts_tsp_result> Result(new mcts_tsp_result);
+    Cancel_Epoch = &Solver->Cancel_Epoch;
+    Solve_Epoch = Start_Epoch;
+    try
+    {
+        if (Solver->Param.Island_Num > 1)
+            Result->Output = Solve_Islands_By_Metric(Solver->Metric_Id, City_Num, Solver->Param, Coordinates,
+                                                     Distance_Matrix, Opt_Tour, Heatmap, Prior_Weight);
+        else
+            Result->Output = Solve_Instance_By_Metric(Solver->Metric_Id, City_Num, Solver->Param, Coordinates,
+                                                      Distance_Matrix, Opt_Tour, Heatmap, Prior_Weight);
+    }
+    catch (...)
+    {
+        Cancel_Epoch = NULL;
+        throw;
+    }
+    Result->If_Cancelled = If_Search_Cancelled();
+    Cancel_Epoch = NULL;
+    return Result.release();
+}
+
+} // namespace
+
+extern "C" {
+
+int mcts_tsp_abi_version(void)
+{
+    return MCTS_TSP_ABI_VERSION;
+}
+
+const char *mcts_tsp_last_error(void)
+{
+    return C_API_Last_Error.c_str();
+}
+
+mcts_tsp_solver *mcts_tsp_solver_create(void)
+{
+    return new (std::nothrow) mcts_tsp_solver;
+}
+
+void mcts_tsp_solver_destroy(mcts_tsp_solver *solver)
+{
+    delete solver;
+}
+
+int mcts_tsp_solver_set_param(mcts_tsp_solver *solver, const char *name, double value)
+{
+    if (solver == NULL || name == NULL)
+        return Set_C_API_Error(MCTS_TSP_ERROR_INVALID_ARGUMENT, "solver or name is NULL");
+
+    Search_Param &Param = solver->Param;
+    std::string Name = name;
+    int Int_Value = (int)value;
+    if (Name == "alpha")
+        Param.Alpha = value;
+    else if (Name == "beta")
+        Param.Beta = value;
+    else if (Name == "param_h")
+        Param.Param_H = value;
+    else if (Name == "param_t")
+        Param.Param_T = value;
+    else if (Name == "max_candidate_num" && Int_Value >= 1)
+        Param.Max_Candidate_Num = Int_Value;
+    else if (Name == "candidate_use_heatmap" && Int_Value >= Candidate_Nearest && Int_Value <= Candidate_Alpha_Heatmap)
+        Param.Candidate_Use_Heatmap = Int_Value;
+    else if (Name == "max_depth" && Int_Value >= 1)
+        Param.Max_Depth = Int_Value;
+    else if (Name == "restart_policy" && Int_Value >= Restart_Random && Int_Value <= Restart_Segment_Random)
+        Param.Restart_Policy = Int_Value;
+    else if (Name == "kick_segment_len" && Int_Value >= 1)
+        Param.Kick_Segment_Len = Int_Value;
+    else if (Name == "focused_sampling")
+        Param.Focused_Sampling = value != 0;
+    else if (Name == "mcts_patience" && Int_Value >= 1)
+        Param.MCTS_Patience = Int_Value;
+    else if (Name == "stagnation_threshold")
+        Param.Stagnation_Threshold = value;
+    else if (Name == "log_len_time")
+        Param.Log_Length_Time = value != 0;
+    else if (Name == "debug")
+        Param.MCTS_Debug = value != 0;
+    else if (Name == "checkpoint_interval")
+        Param.Checkpoint_Interval = value;
+    else if (Name == "export_weight_num" && Int_Value >= 0)
+        Param.Export_Weight_Num = Int_Value;
+    else if (Name == "compute_lower_bound")
+        Param.Compute_Lower_Bound = value != 0;
+    else if (Name == "target_gap" && value >= 0)
+        Param.Target_Gap = value;
+    else if (Name == "heatmap_scale" && value > 0)
+        Param.Heatmap_Scale = value;
+    else if (Name == "island_num" && Int_Value >= 1)
+        Param.Island_Num = Int_Value;
+    else if (Name == "elite_pool_size" && Int_Value >= 0)
+        Param.Elite_Pool_Size = Int_Value;
+    else if (Name == "thread_num" && Int_Value >= 0)
+        solver->Thread_Num = Int_Value;
+    else
+        return Set_C_API_Error(MCTS_TSP_ERROR_INVALID_ARGUMENT,
+                               "Unknown parameter or invalid value for " + Name);
+    return MCTS_TSP_OK;
+}
+
+int mcts_tsp_solver_set_string_param(mcts_tsp_solver *solver, const char *name, const char *value)
+{
+    if (solver == NULL || name == NULL || value == NULL)
+        return Set_C_API_Error(MCTS_TSP_ERROR_INVALID_ARGUMENT, "solver, name or value is NULL");
+
+    std::string Name = name;
+    if (Name == "metric")
+    {
+        int Metric_Id = Get_Metric_Id(value);
+        if (Metric_Id == Null)
+            return Set_C_API_Error(MCTS_TSP_ERROR_INVALID_ARGUMENT, std::string("Unknown metric ") + value);
+        solver->Metric_Id = Metric_Id;
+    }
+    else if (Name == "init_method")
+    {
+        int Init_Method_Id = Get_Init_Method_Id(value);
+        if (Init_Method_Id == Null)
+            return Set_C_API_Error(MCTS_TSP_ERROR_INVALID_ARGUMENT, std::string("Unknown init_method ") + value);
+        solver->Param.Init_Method = Init_Method_Id;
+    }
+    else if (Name == "heatmap_format")
+    {
+        int Heatmap_Format_Id = Get_Heatmap_Format_Id(value);
+        if (Heatmap_Format_Id == Null)
+            return Set_C_API_Error(MCTS_TSP_ERROR_INVALID_ARGUMENT, std::string("Unknown heatmap_format ") + value);
+        solver->Param.Heatmap_Format = Heatmap_Format_Id;
+    }
+    else if (Name == "renumber")
+    {
+        int Renumber_Method_Id = Get_Renumber_Method_Id(value);
+        if (Renumber_Method_Id == Null)
+            return Set_C_API_Error(MCTS_TSP_ERROR_INVALID_ARGUMENT, std::string("Unknown renumber ") + value);
+        solver->Param.Renumber_Method = Renumber_Method_Id;
+    }
+    else if (Name == "checkpoint_path")
+        solver->Param.Checkpoint_Path = value;
+    else if (Name == "resume_path")
+        solver->Param.Resume_Path = value;
+    else
+        return Set_C_API_Error(MCTS_TSP_ERROR_INVALID_ARGUMENT, "Unknown parameter " + Name);
+    return MCTS_TSP_OK;
+}
+
+int mcts_tsp_solver_set_prior_weight(mcts_tsp_solver *solver, int city_num, int k, const int *city,
+                                     const float *weight)
+{
+    if (solver == NULL)
+        return Set_C_API_Error(MCTS_TSP_ERROR_INVALID_ARGUMENT, "solver is NULL");
+    if (city == NULL)
+    {
+        solver->Prior_Weight_City_Num = 0;
+        solver->Prior_Weight = Sparse_Edge_Weight();
+        return MCTS_TSP_OK;
+    }
+    if (city_num <= 0 || k < 0 || weight == NULL)
+        return Set_C_API_Error(MCTS_TSP_ERROR_INVALID_ARGUMENT, "Invalid prior weight dimensions");
+
+    try
+    {
+        size_t Size = (size_t)city_num * k;
+        solver->Prior_Weight.K = k;
+        solver->Prior_Weight.City.assign(city, city + Size);
+        solver->Prior_Weight.Weight.assign(weight, weight + Size);
+        solver->Prior_Weight_City_Num = city_num;
+    }
+    catch (const std::bad_alloc &)
+    {
+        return Set_C_API_Error(MCTS_TSP_ERROR_OUT_OF_MEMORY, "Out of memory");
+    }
+    return MCTS_TSP_OK;
+}
+
+void mcts_tsp_solver_cancel(mcts_tsp_solver *solver)
+{
+    if (solver != NULL)
+        solver->Cancel_Epoch.fetch_add(1);
+}
+
+int mcts_tsp_solve(mcts_tsp_solver *solver, int city_num, const double *coordinates, const int *distance_matrix,
+                   const int *opt_solution, const void *heatmap, mcts_tsp_result **result)
+{
+    int Status = Check_C_API_Instance(solver, city_num, coordinates, distance_matrix, heatmap);
+    if (Status != MCTS_TSP_OK)
+        return Status;
+    if (result == NULL)
+        return Set_C_API_Error(MCTS_TSP_ERROR_INVALID_ARGUMENT, "result is NULL");
+    if (solver->Prior_Weight_City_Num != 0 && solver->Prior_Weight_City_Num != city_num)
+        return Set_C_API_Error(MCTS_TSP_ERROR_INVALID_ARGUMENT, "The prior weight is not of city_num cities");
+
+    try
+    {
+        *result = Solve_C_API_Instance(solver, solver->Cancel_Epoch.load(), city_num, coordinates,
+                                       distance_matrix, opt_solution, heatmap,
+                                       solver->Prior_Weight_City_Num != 0 ? &solver->Prior_Weight : NULL);
+    }
+    catch (const std::bad_alloc &)
+    {
+        return Set_C_API_Error(MCTS_TSP_ERROR_OUT_OF_MEMORY, "Out of memory");
+    }
+    catch (const std::exception &e)
+    {
+        return Set_C_API_Error(MCTS_TSP_ERROR_SOLVE_FAILED, e.what());
+    }
+    return MCTS_TSP_OK;
+}
+
+int mcts_tsp_solve_batch(mcts_tsp_solver *solver, int instance_num, int city_num, const double *coordinates,
+                         const int *distance_matrices, const int *opt_solutions, const void *heatmaps,
+                         mcts_tsp_result **results)
+{
+    int Status = Check_C_API_Instance(solver, city_num, coordinates, distance_matrices, heatmaps);
+    if (Status != MCTS_TSP_OK)
+        return Status;
+    if (instance_num < 0 || results == NULL)
+        return Set_C_API_Error(MCTS_TSP_ERROR_INVALID_ARGUMENT, "instance_num is negative or results is NULL");
+
+    size_t N = city_num;
+    size_t Input_Size = N * Get_Metric_Input_Dim(solver->Metric_Id, city_num);
+    size_t Heatmap_Size = N * N * Get_Heatmap_Entry_Size(solver->Param.Heatmap_Format);
+    int Thread_Num = solver->Thread_Num > 0 ? solver->Thread_Num : max((int)std::thread::hardware_concurrency(), 1);
+    Thread_Num = max(min(Thread_Num, instance_num), 1);
+
+    // Instances are handed out one at a time, the first error stops the batch
+    unsigned Start_Epoch = solver->Cancel_Epoch.load();
+    std::atomic<int> Next_Instance{0};
+    std::atomic<bool> If_Failed{false};
+    std::mutex Error_Mutex;
+    int Error_Code = MCTS_TSP_OK;
+    std::string Error_Message;
+    auto Worker = [&]() {
+        for (int i; !If_Failed.load() && (i = Next_Instance.fetch_add(1)) < instance_num;)
+        {
+            int Code = MCTS_TSP_ERROR_SOLVE_FAILED;
+            std::string Message = "Out of memory";
+            try
+            {
+                results[i] = Solve_C_API_Instance(
+                    solver, Start_Epoch, city_num, coordinates == NULL ? NULL : coordinates + i * Input_Size,
+                    distance_matrices == NULL ? NULL : distance_matrices + i * Input_Size,
+                    opt_solutions == NULL ? NULL : opt_solutions + i * N, heatmaps == NULL ? NULL : (const char *)heatmaps + i * Heatmap_Size,
+                    NULL);
+                continue;
+            }
+            catch (const std::bad_alloc &)
+            {
+                Code = MCTS_TSP_ERROR_OUT_OF_MEMORY;
+            }
+            catch (const std::exception &e)
+            {
+                Message = e.what();
+            }
+            std::lock_guard<std::mutex> Lock(Error_Mutex);
+            if (Error_Code == MCTS_TSP_OK)
+            {
+                Error_Code = Code;
+                Error_Message = Message;
+            }
+            If_Failed.store(true);
+        }
+    };
+
+    for (int i = 0; i < instance_num; i++)
+        results[i] = NULL;
+    vector<std::thread> Workers;
+    for (int i = 1; i < Thread_Num; i++)
+        Workers.emplace_back(Worker);
+    Worker();
+    for (auto &Thread : Workers)
+        Thread.join();
+
+    if (If_Failed.load())
+    {
+        for (int i = 0; i < instance_num; i++)
+        {
+            delete results[i];
+            results[i] = NULL;
+        }
+        return Set_C_API_Error(Error_Code, Error_Message);
+    }
+    return MCTS_TSP_OK;
+}
+
+void mcts_tsp_result_destroy(mcts_tsp_result *result)
+{
+    delete result;
+}
+
+int mcts_tsp_result_city_num(const mcts_tsp_result *result)
+{
+    return (int)result->Output.Solution.size();
+}
+
+double mcts_tsp_result_concorde_distance(const mcts_tsp_result *result)
+{
+    return result->Output.Concorde_Distance;
+}
+
+double mcts_tsp_result_mcts_distance(const mcts_tsp_result *result)
+{
+    return result->Output.MCTS_Distance;
+}
+
+double mcts_tsp_result_gap(const mcts_tsp_result *result)
+{
+    return result->Output.Gap;
+}
+
+double mcts_tsp_result_time(const mcts_tsp_result *result)
+{
+    return result->Output.Time;
+}
+
+double mcts_tsp_result_overall_time(const mcts_tsp_result *result)
+{
+    return result->Output.Overall_Time;
+}
+
+double mcts_tsp_result_lower_bound(const mcts_tsp_result *result)
+{
+    return result->Output.Lower_Bound;
+}
+
+double mcts_tsp_result_certified_gap(const mcts_tsp_result *result)
+{
+    return result->Output.Certified_Gap;
+}
+
+int mcts_tsp_result_cancelled(const mcts_tsp_result *result)
+{
+    return result->If_Cancelled;
+}
+
+int mcts_tsp_result_tour(const mcts_tsp_result *result, int *tour, int capacity)
+{
+    const vector<int> &Solution = result->Output.Solution;
+    if (tour != NULL && capacity >= (int)Solution.size())
+        std::copy(Solution.begin(), Solution.end(), tour);
+    return (int)Solution.size();
+}
+
+int mcts_tsp_result_length_time(const mcts_tsp_result *result, double *records, int capacity)
+{
+    const vector<double> &Length_Time = result->Output.Length_Time;
+    int Record_Num = (int)Length_Time.size() / 2;
+    if (records != NULL && capacity >= Record_Num)
+        std::copy(Length_Time.begin(), Length_Time.end(), records);
+    return Record_Num;
+}
+
+int mcts_tsp_result_learned_weight(const mcts_tsp_result *result, int *city, float *weight, int capacity)
+{
+    const Sparse_Edge_Weight &Learned_Weight = result->Output.Learned_Weight;
+    if (city != NULL && weight != NULL && capacity >= (int)Learned_Weight.City.size())
+    {
+        std::copy(Learned_Weight.City.begin(), Learned_Weight.City.end(), city);
+        std::copy(Learned_Weight.Weight.begin(), Learned_Weight.Weight.end(), weight);
+    }
+    return Learned_Weight.K;
+}
+
+} // extern "C"
+
+#endif // TSP_C_API_H
@@ -0,0 +1,407 @@
+#ifndef TSP_CHECKPOINT_H
+#define TSP_CHECKPOINT_H
+
+#include <cerrno>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "TSP_Basic_Functions.h"
+
+#define Checkpoint_Magic 0x54434d43 // "CMCT"
+#define Checkpoint_Version 2
+
+thread_local std::string Checkpoint_Path;       // snapshot file written periodically during the search ("" disables)
+thread_local double Checkpoint_Interval = 300;  // seconds between two snapshots
+thread_local std::string Resume_Path;           // snapshot the search resumes from ("" disables)
+thread_local unsigned long long Checkpoint_Instance_Hash; // hash of the instance being solved, see Get_Instance_Hash()
+
+// Edges whose statistics changed since the last snapshot. The search logs an
+// edge the first time it changes, so that a snapshot copies only these
+// instead of scanning Weight[][] and Chosen_Times[][]
+thread_local vector<unsigned long long> If_Edge_Logged; // one bit per edge, empty unless checkpointing
+thread_local vector<std::pair<int, int>> Logged_Edge;
+
+// Called wherever Weight[First_City][Second_City] or
+// Chosen_Times[First_City][Second_City] changes
+void Log_Edge_Change(int First_City, int Second_City)
+{
+    if (If_Edge_Logged.empty())
+        return;
+    size_t Edge = (size_t)First_City * Virtual_City_Num + Second_City;
+    unsigned long long Bit = 1ULL << (Edge & 63);
+    if (If_Edge_Logged[Edge >> 6] & Bit)
+        return;
+    If_Edge_Logged[Edge >> 6] |= Bit;
+    Logged_Edge.push_back(std::make_pair(First_City, Second_City));
+}
+
+// One non-default entry of the MCTS edge statistics
+struct Checkpoint_Edge
+{
+    int First_City;
+    int Second_City;
+    float Weight;
+    int Chosen_Times;
+};
+
+// Everything needed to resume a search: the best tour, the learned edge
+// statistics (only the entries differing from their initial value), the RNG
+// state and the consumed time budget
+struct Checkpoint_Snapshot
+{
+    int City_Num;
+    unsigned long long Instance_Hash;
+    Distance_Type Best_Distance;
+    int Total_Simulation_Times;
+    unsigned long long Random_State;
+    double Elapsed_Time;
+    vector<int> Best_Tour;
+    vector<Checkpoint_Edge> Edges;
+    vector<std::pair<double, double>> Length_Time;
+};
+
+// Copy the state of the search running in the calling thread into Snapshot.
+// Only the edges logged since the previous snapshot are copied, appended to
+// Snapshot.Edges if If_Keep_Edges (the edges of a snapshot not written yet)
+void Take_Checkpoint_Snapshot(Checkpoint_Snapshot &Snapshot, bool If_Keep_Edges = false)
+{
+    Snapshot.City_Num = Virtual_City_Num;
+    Snapshot.Instance_Hash = Checkpoint_Instance_Hash;
+    Snapshot.Best_Distance = Current_Instance_Best_Distance;
+    Snapshot.Total_Simulation_Times = Total_Simulation_Times;
+    Snapshot.Random_State = Random_State;
+    Snapshot.Elapsed_Time = Get_Elapsed_Time(Current_Instance_Begin_Time);
+    Snapshot.Length_Time = Length_Time;
+
+    Snapshot.Best_Tour.resize(Virtual_City_Num);
+    int Cur_City = Start_City;
+    for (int i = 0; i < Virtual_City_Num; i++)
+    {
+        Snapshot.Best_Tour[i] = Cur_City;
+        Cur_City = Best_All_Node[Cur_City].Next_City;
+    }
+
+    if (!If_Keep_Edges)
+        Snapshot.Edges.clear();
+    for (auto &Edge : Logged_Edge)
+    {
+        int i = Edge.first, j = Edge.second;
+        Snapshot.Edges.push_back(Checkpoint_Edge{i, j, Weight[i][j], Chosen_Times[i][j]});
+        size_t Index = (size_t)i * Virtual_City_Num + j;
+        If_Edge_Logged[Index >> 6] &= ~(1ULL << (Index & 63));
+    }
+    Logged_Edge.clear();
+}
+
+template <typename T> void Write_Vector(FILE *File, const vector<T> &Data)
+{
+    unsigned long long Size = Data.size();
+    fwrite(&Size, sizeof(Size), 1, File);
+    if (Size > 0)
+        fwrite(Data.data(), sizeof(T), Size, File);
+}
+
+// Read a vector written by Write_Vector(). Fail on a size beyond the end of
+// the file, as in a truncated or corrupt file
+template <typename T> bool Read_Vector(FILE *File, vector<T> &Data)
+{
+    unsigned long long Size;
+    if (fread(&Size, sizeof(Size), 1, File) != 1)
+        return false;
+    long Position = ftell(File);
+    if (Position < 0 || fseek(File, 0, SEEK_END) != 0)
+        return false;
+    long End = ftell(File);
+    if (End < Position || fseek(File, Position, SEEK_SET) != 0 ||
+        Size > (unsigned long long)(End - Position) / sizeof(T))
+        return false;
+    Data.resize(Size);
+    return Size == 0 || fread(Data.data(), sizeof(T), Size, File) == Size;
+}
+
+// Write Snapshot to a temporary file renamed over Path, so that a job
+// preempted while writing never leaves a truncated snapshot behind
+bool Write_Checkpoint_File(const Checkpoint_Snapshot &Snapshot, const std::string &Path)
+{
+    std::string Temp_Path = Path + ".tmp";
+    FILE *File = fopen(Temp_Path.c_str(), "wb");
+    if (File == NULL)
+        return false;
+
+    int Header[2] = {Checkpoint_Magic, Checkpoint_Version};
+    fwrite(Header, sizeof(int), 2, File);
+    fwrite(&Snapshot.City_Num, sizeof(Snapshot.City_Num), 1, File);
+    fwrite(&Snapshot.Instance_Hash, sizeof(Snapshot.Instance_Hash), 1, File);
+    fwrite(&Snapshot.Best_Distance, sizeof(Snapshot.Best_Distance), 1, File);
+    fwrite(&Snapshot.Total_Simulation_Times, sizeof(Snapshot.Total_Simulation_Times), 1, File);
+    fwrite(&Snapshot.Random_State, sizeof(Snapshot.Random_State), 1, File);
+    fwrite(&Snapshot.Elapsed_Time, sizeof(Snapshot.Elapsed_Time), 1, File);
+    Write_Vector(File, Snapshot.Best_Tour);
+    Write_Vector(File, Snapshot.Edges);
+    Write_Vector(File, Snapshot.Length_Time);
+
+    bool If_Written = ferror(File) == 0;
+    If_Written = (fclose(File) == 0) && If_Written;
+    return If_Written && rename(Temp_Path.c_str(), Path.c_str()) == 0;
+}
+
+bool Read_Checkpoint_File(Checkpoint_Snapshot &Snapshot, const std::string &Path)
+{
+    FILE *File = fopen(Path.c_str(), "rb");
+    if (File == NULL)
+        return false;
+
+    int Header[2];
+    bool If_Read = fread(Header, sizeof(int), 2, File) == 2 && Header[0] == Checkpoint_Magic &&
+                   Header[1] == Checkpoint_Version &&
+                   fread(&Snapshot.City_Num, sizeof(Snapshot.City_Num), 1, File) == 1 &&
+                   fread(&Snapshot.Instance_Hash, sizeof(Snapshot.Instance_Hash), 1, File) == 1 &&
+                   fread(&Snapshot.Best_Distance, sizeof(Snapshot.Best_Distance), 1, File) == 1 &&
+                   fread(&Snapshot.Total_Simulation_Times, sizeof(Snapshot.Total_Simulation_Times), 1, File) == 1 &&
+                   fread(&Snapshot.Random_State, sizeof(Snapshot.Random_State), 1, File) == 1 &&
+                   fread(&Snapshot.Elapsed_Time, sizeof(Snapshot.Elapsed_Time), 1, File) == 1 &&
+                   Read_Vector(File, Snapshot.Best_Tour) && Read_Vector(File, Snapshot.Edges) &&
+                   Read_Vector(File, Snapshot.Length_Time);
+    fclose(File);
+
+    return If_Read;
+}
+
+// Background writer with two snapshot buffers: the search thread fills the
+// buffer the writer is not busy with, then returns to the search while the
+// writer merges its edges into the full set and writes the file. If a newer
+// snapshot is taken before the pending one was picked up, it replaces the
+// pending one, keeping its edges
+struct Checkpoint_Writer
+{
+    std::string Path;
+    Checkpoint_Snapshot Buffers[2];
+    int Writing_Index = Null; // buffer being merged by the writer thread
+    int Pending_Index = Null; // buffer waiting to be merged
+    bool If_Stopping = false;
+    std::mutex Mutex;
+    std::condition_variable Condition;
+    std::thread Writer_Thread;
+
+    // Owned by the writer thread: the state written to the file, with the
+    // edges of all the snapshots so far
+    Checkpoint_Snapshot Merged;
+    std::unordered_map<size_t, size_t> Merged_Edge_Index; // edge -> index in Merged.Edges
+
+    explicit Checkpoint_Writer(const std::string &Checkpoint_File) : Path(Checkpoint_File)
+    {
+        Writer_Thread = std::thread(&Checkpoint_Writer::Writer_Loop, this);
+    }
+
+    ~Checkpoint_Writer()
+    {
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            If_Stopping = true;
+        }
+        Condition.notify_all();
+        Writer_Thread.join();
+    }
+
+    // Snapshot the search of the calling thread and queue it for writing
+    void Checkpoint()
+    {
+        int Fill_Index;
+        bool If_Keep_Edges;
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            If_Keep_Edges = Pending_Index != Null;
+            Fill_Index = If_Keep_Edges ? Pending_Index : (Writing_Index == 0 ? 1 : 0);
+            Pending_Index = Null;
+        }
+
+        Take_Checkpoint_Snapshot(Buffers[Fill_Index], If_Keep_Edges);
+
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            Pending_Index = Fill_Index;
+        }
+        Condition.notify_all();
+    }
+
+    void Merge_Snapshot(const Checkpoint_Snapshot &Snapshot)
+    {
+        Merged.City_Num = Snapshot.City_Num;
+        Merged.Instance_Hash = Snapshot.Instance_Hash;
+        Merged.Best_Distance = Snapshot.Best_Distance;
+        Merged.Total_Simulation_Times = Snapshot.Total_Simulation_Times;
+        Merged.Random_State = Snapshot.Random_State;
+        Merged.Elapsed_Time = Snapshot.Elapsed_Time;
+        Merged.Best_Tour = Snapshot.Best_Tour;
+        Merged.Length_Time = Snapshot.Length_Time;
+
+        for (auto &Edge : Snapshot.Edges)
+        {
+            size_t Key = (size_t)Edge.First_City * Snapshot.City_Num + Edge.Second_City;
+            auto Found = Merged_Edge_Index.emplace(Key, Merged.Edges.size());
+            if (Found.second)
+                Merged.Edges.push_back(Edge);
+            else
+                Merged.Edges[Found.first->second] = Edge;
+        }
+    }
+
+    void Writer_Loop()
+    {
+        std::unique_lock<std::mutex> Lock(Mutex);
+        while (true)
+        {
+            Condition.wait(Lock, [this] { return If_Stopping || Pending_Index != Null; });
+            if (Pending_Index == Null)
+                return;
+
+            Writing_Index = Pending_Index;
+            Pending_Index = Null;
+            Lock.unlock();
+            Merge_Snapshot(Buffers[Writing_Index]);
+            if (!Write_Checkpoint_File(Merged, Path))
+                std::cerr << "Failed to write the checkpoint " << Path << endl;
+            Lock.lock();
+            Writing_Index = Null;
+        }
+    }
+};
+
+thread_local Checkpoint_Writer *Active_Checkpoint_Writer = NULL;
+thread_local double Last_Checkpoint_Time;
+
+// Start checkpointing the search of the calling thread, if requested. The
+// edges already changed (prior weights, initial local search, resumed
+// snapshot) are found by a single scan and go into the first snapshot
+void Begin_Checkpointing()
+{
+    if (Checkpoint_Path.empty())
+        return;
+
+    If_Edge_Logged.assign(((size_t)Virtual_City_Num * Virtual_City_Num + 63) / 64, 0);
+    Logged_Edge.clear();
+    for (int i = 0; i < Virtual_City_Num; i++)
+        for (int j = 0; j < Virtual_City_Num; j++)
+            if (Chosen_Times[i][j] != 0 || Weight[i][j] != Get_Edge_Heatmap(i, j) * 100)
+                Log_Edge_Change(i, j);
+
+    Active_Checkpoint_Writer = new Checkpoint_Writer(Checkpoint_Path);
+    Last_Checkpoint_Time = Get_Elapsed_Time(Current_Instance_Begin_Time);
+}
+
+// Called regularly by the search: take a snapshot once Checkpoint_Interval
+// seconds elapsed since the previous one
+void Checkpoint_If_Due()
+{
+    if (Active_Checkpoint_Writer == NULL)
+        return;
+
+    double Elapsed_Time = Get_Elapsed_Time(Current_Instance_Begin_Time);
+    if (Elapsed_Time - Last_Checkpoint_Time < Checkpoint_Interval)
+        return;
+
+    Active_Checkpoint_Writer->Checkpoint();
+    Last_Checkpoint_Time = Elapsed_Time;
+}
+
+// Flush the pending snapshot and stop the writer thread
+void End_Checkpointing()
+{
+    delete Active_Checkpoint_Writer;
+    Active_Checkpoint_Writer = NULL;
+    vector<unsigned long long>().swap(If_Edge_Logged);
+    vector<std::pair<int, int>>().swap(Logged_Edge);
+}
+
+// Return true if the content of Snapshot, read for an instance of N cities,
+// can be restored: a tour visiting each city once, edges between cities and
+// a consumed budget that is a duration
+bool Check_Snapshot_Content(const Checkpoint_Snapshot &Snapshot, int N)
+{
+    vector<char> If_Visited(N, false);
+    for (int City : Snapshot.Best_Tour)
+    {
+        if (City < 0 || City >= N || If_Visited[City])
+            return false;
+        If_Visited[City] = true;
+    }
+    for (auto &Edge : Snapshot.Edges)
+        if (Edge.First_City < 0 || Edge.First_City >= N || Edge.Second_City < 0 || Edge.Second_City >= N ||
+            Edge.Chosen_Times < 0)
+            return false;
+    return Snapshot.Total_Simulation_Times >= 0 && Snapshot.Elapsed_Time >= 0 && std::isfinite(Snapshot.Elapsed_Time);
+}
+
+thread_local Checkpoint_Snapshot Resume_Snapshot; // read by Load_Resume_Snapshot() for the next search
+thread_local bool If_Resume_Snapshot_Loaded = false;
+
+// Read the snapshot at Resume_Path for an instance of N cities hashed to
+// Checkpoint_Instance_Hash, before the solve allocates anything. Return false
+// if there is no snapshot to resume from (no Resume_Path, or no file there
+// yet), throw std::runtime_error if the file cannot be read, is corrupt or
+// belongs to another instance
+bool Load_Resume_Snapshot(int N)
+{
+    If_Resume_Snapshot_Loaded = false;
+    if (Resume_Path.empty())
+        return false;
+
+    FILE *File = fopen(Resume_Path.c_str(), "rb");
+    if (File == NULL)
+    {
+        if (errno == ENOENT)
+            return false;
+        throw std::runtime_error("Cannot open the checkpoint " + Resume_Path);
+    }
+    fclose(File);
+
+    if (!Read_Checkpoint_File(Resume_Snapshot, Resume_Path))
+        throw std::runtime_error("Invalid checkpoint " + Resume_Path);
+    if (Resume_Snapshot.City_Num != N || (int)Resume_Snapshot.Best_Tour.size() != N ||
+        Resume_Snapshot.Instance_Hash != Checkpoint_Instance_Hash)
+        throw std::runtime_error("The checkpoint " + Resume_Path + " belongs to another instance");
+    if (!Check_Snapshot_Content(Resume_Snapshot, N))
+        throw std::runtime_error("Invalid checkpoint " + Resume_Path);
+    If_Resume_Snapshot_Loaded = true;
+    return true;
+}
+
+// Restore the search state of the calling thread from the snapshot loaded by
+// Load_Resume_Snapshot(). Must be called after MCTS_Init(), and returns false
+// (leaving the state untouched) if no snapshot was loaded
+bool Resume_From_Checkpoint()
+{
+    if (!If_Resume_Snapshot_Loaded)
+        return false;
+    If_Resume_Snapshot_Loaded = false;
+    Checkpoint_Snapshot Snapshot = std::move(Resume_Snapshot);
+
+    for (int i = 0; i < Virtual_City_Num; i++)
+        Solution[i] = Snapshot.Best_Tour[i];
+    Convert_Solution_To_All_Node();
+    Store_Best_Solution();
+
+    for (auto &Edge : Snapshot.Edges)
+    {
+        Weight[Edge.First_City][Edge.Second_City] = Edge.Weight;
+        Chosen_Times[Edge.First_City][Edge.Second_City] = Edge.Chosen_Times;
+    }
+
+    Current_Instance_Best_Distance = Get_Solution_Total_Distance();
+    Total_Simulation_Times = Snapshot.Total_Simulation_Times;
+    Random_State = Snapshot.Random_State;
+    Length_Time = Snapshot.Length_Time;
+
+    // Charge the time already spent to the budget of this run
+    Current_Instance_Begin_Time -=
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(Snapshot.Elapsed_Time));
+
+    return true;
+}
+
+#endif // TSP_CHECKPOINT_H
@@ -0,0 +1,178 @@
+#ifndef TSP_DECOMPOSITION_H
+#define TSP_DECOMPOSITION_H
+
+#include <atomic>
+#include <thread>
+
+#include "TSP_Hilbert.h"
+#include "TSP_Solver.h"
+
+// Euclidean length of the closed tour Tour[0..N) over the (unscaled)
+// coordinates X[], Y[]
+double Get_Tour_Double_Distance(int N, const int *Tour, const double *X, const double *Y)
+{
+    double Tour_Distance = 0;
+    for (int i = 0; i < N; i++)
+    {
+        int First_City = Tour[i];
+        int Second_City = Tour[(i + 1) % N];
+        Tour_Distance += sqrt((X[First_City] - X[Second_City]) * (X[First_City] - X[Second_City]) +
+                              (Y[First_City] - Y[Second_City]) * (Y[First_City] - Y[Second_City]));
+    }
+
+    return Tour_Distance;
+}
+
+// Optimize the path Path[0..Path_Len) (global city ids) by MCTS with its
+// endpoints Path[0] and Path[Path_Len-1] fixed. The subproblem is solved in the
+// calling thread and the improved path is written back to Path[]
+void Optimize_Sub_Path(int *Path, int Path_Len, const double *X, const double *Y)
+{
+    if (Path_Len < max(8, 2 * Max_Depth + 2))
+        return;
+
+    City_Num = Path_Len;
+    Start_City = 0;
+    Salesman_Num = 1;
+    Virtual_City_Num = City_Num + Salesman_Num - 1;
+    Heatmap_Format = Heatmap_Float64;
+    Allocate_Memory(Virtual_City_Num);
+
+    for (int i = 0; i < Virtual_City_Num; i++)
+    {
+        Coordinate_X[i] = X[Path[i]] * Magnify_Rate;
+        Coordinate_Y[i] = Y[Path[i]] * Magnify_Rate;
+    }
+    Calculate_All_Pair_Distance();
+
+    // Candidates are the nearest neighbors, and only the candidate edges are
+    // promising in the surrogate heatmap
+    Candidate_Use_Heatmap = Candidate_Nearest;
+    Identify_Candidate_Set();
+    Set_Candidate_Edge_Heatmap();
+
+    // Pin the edge closing the path into a cycle: it costs nothing, while any
+    // other edge at an endpoint costs Penalty, more than any move can gain
+    int Last_City = Virtual_City_Num - 1;
+    Distance_Type Path_Distance = 0;
+    for (int i = 0; i < Last_City; i++)
+        Path_Distance += Get_Distance(i, i + 1);
+    Distance_Type Penalty = Path_Distance + 1;
+    if (Penalty >= Inf_Cost / 4)
+    {
+        Release_Memory(Virtual_City_Num);
+        return;
+    }
+    for (int i = 1; i < Last_City; i++)
+    {
+        Distance[0][i] += Penalty;
+        Distance[i][0] += Penalty;
+        Distance[Last_City][i] += Penalty;
+        Distance[i][Last_City] += Penalty;
+    }
+    Distance[0][Last_City] = 0;
+    Distance[Last_City][0] = 0;
+
+    // Start from the given path and restart by kicking the best tour, so
+    // that the search never discards the quality of the global tour
+    for (int i = 0; i < Virtual_City_Num; i++)
+        Solution[i] = i;
+    Use_Warm_Start = true;
+    Restart_Policy = Restart_Double_Bridge;
+    Log_Length_Time = false;
+    Current_Instance_Begin_Time = std::chrono::steady_clock::now();
+    Current_Instance_Best_Distance = Inf_Cost;
+    Markov_Decision_Process();
+    Use_Warm_Start = false;
+
+    // Cut the best found cycle at the pinned edge
+    if (All_Node[0].Pre_City == Last_City || All_Node[0].Next_City == Last_City)
+    {
+        bool If_Forward = All_Node[0].Pre_City == Last_City;
+        vector<int> Old_Path(Path, Path + Path_Len);
+        int Cur_City = 0;
+        for (int i = 0; i < Path_Len; i++)
+        {
+            Path[i] = Old_Path[Cur_City];
+            Cur_City = If_Forward ? All_Node[Cur_City].Next_City : All_Node[Cur_City].Pre_City;
+        }
+    }
+
+    Release_Memory(Virtual_City_Num);
+}
+
+// Solve a large instance by spatial decomposition. A global tour is built
+// along the Hilbert curve, then each round splits it into windows of
+// Window_Size consecutive cities, optimizes the windows in parallel as
+// fixed-endpoint subpaths and stitches them back. The window boundaries shift
+// by Window_Shift cities between rounds. The tour is stored in Tour[0..N) and
+// its length after each round is appended to Round_Length_Time
+double Solve_By_Decomposition(int N, const double *X, const double *Y, int *Tour, const Search_Param &Param,
+                              int Window_Size, int Window_Shift, int Round_Num, int Thread_Num, double Time_Limit,
+                              vector<std::pair<double, double>> &Round_Length_Time)
+{
+    auto Begin_Time = std::chrono::steady_clock::now();
+    if (Thread_Num <= 0)
+        Thread_Num = max(1u, std::thread::hardware_concurrency());
+    if (Window_Shift <= 0)
+        Window_Shift = max(1, Window_Size / 2);
+    Window_Size = min(Window_Size, N);
+
+    Get_Hilbert_Order(N, X, Y, Tour);
+    Round_Length_Time.push_back(
+        std::make_pair(Get_Tour_Double_Distance(N, Tour, X, Y), Get_Elapsed_Time(Begin_Time)));
+
+    vector<int> Rotated_Tour(N);
+    for (int Round = 0; Round < Round_Num; Round++)
+    {
+        if (Time_Limit > 0 && Get_Elapsed_Time(Begin_Time) >= Time_Limit)
+            break;
+
+        // Rotate the tour so that the windows of this round are contiguous,
+        // a too short trailing window is merged into the previous one
+        int Offset = (int)(((long long)Round * Window_Shift) % N);
+        for (int i = 0; i < N; i++)
+            Rotated_Tour[i] = Tour[(Offset + i) % N];
+
+        vector<int> Window_Begin;
+        for (int Begin = 0; Begin < N; Begin += Window_Size)
+        {
+            if (!Window_Begin.empty() && N - Begin < Window_Size / 2)
+                break;
+            Window_Begin.push_back(Begin);
+        }
+        Window_Begin.push_back(N);
+
+        std::atomic<int> Next_Window(0);
+        auto Worker = [&](int Worker_Index) {
+            Set_Search_Param(Param);
+            Set_Random_Seed(Random_Seed + (unsigned long long)Round * Thread_Num + Worker_Index);
+            while (true)
+            {
+                int Window = Next_Window++;
+                if (Window >= (int)Window_Begin.size() - 1)
+                    break;
+                if (Time_Limit > 0 && Get_Elapsed_Time(Begin_Time) >= Time_Limit)
+                    break;
+
+                int Begin = Window_Begin[Window];
+                Optimize_Sub_Path(&Rotated_Tour[Begin], Window_Begin[Window + 1] - Begin, X, Y);
+            }
+        };
+
+        vector<std::thread> Workers;
+        for (int i = 0; i < Thread_Num; i++)
+            Workers.emplace_back(Worker, i);
+        for (auto &Cur_Worker : Workers)
+            Cur_Worker.join();
+
+        for (int i = 0; i < N; i++)
+            Tour[i] = Rotated_Tour[i];
+        Round_Length_Time.push_back(
+            std::make_pair(Get_Tour_Double_Distance(N, Tour, X, Y), Get_Elapsed_Time(Begin_Time)));
+    }
+
+    return Get_Tour_Double_Distance(N, Tour, X, Y);
+}
+
+#endif // TSP_DECOMPOSITION_H
@@ -0,0 +1,461 @@
+#ifndef TSP_DYNAMIC_H
+#define TSP_DYNAMIC_H
+
+#include <algorithm>
+
+#include "TSP_Solver.h"
+
+#define Update_Region_City_Num 20 // cities searched per changed city when an update is given no time budget
+
+// An instance kept alive between solves, for instances that change by a few
+// cities at a time. Update() patches the coordinates and only the distance and
+// candidate rows of the changed cities, repairs the best tour by cheapest
+// insertion and runs a short search around the changed cities, starting from
+// the edge weights learned so far. The heatmap and MCTS statistics are kept
+// in the instance, and only those of the edges at the changed cities are
+// reset, so that an update does not pass over all the edges. The candidates
+// are the nearest cities
+template <typename Metric> struct Dynamic_Instance
+{
+    static_assert(Metric::Dim > 0, "the cities of a dynamic instance are given by their coordinates");
+
+    Search_Param Param;
+    Shared_Instance Shared; // rows of Distance[][] and of the kept matrices hold Capacity entries
+    int Capacity = 0;
+    vector<double> Input; // input coordinates, City_Num x Metric::Dim
+    vector<int> Tour;     // best found tour
+
+    Dynamic_Instance(const Search_Param &Search) : Param(Search)
+    {
+        Param.Candidate_Use_Heatmap = Candidate_Nearest;
+        Param.Heatmap_Format = Heatmap_Float64; // the heatmap of Solve() is given as double
+    }
+
+    int Get_City_Num() const
+    {
+        return Shared.City_Num;
+    }
+
+    // Solve an instance of N cities from scratch (Heatmap may be NULL)
+    TSP_Output Solve(int N, const double *City_Input, const int *Opt_Tour, const double *Heatmap)
+    {
+        for (int i = 0; i < Shared.City_Num; i++)
+            Release_Row(i);
+        Shared.City_Num = 0;
+
+        Reserve(N);
+        Input.assign(City_Input, City_Input + (size_t)N * Metric::Dim);
+        for (int i = 0; i < N; i++)
+            Add_Row(i);
+        Shared.City_Num = N;
+        for (int i = 0; i < N; i++)
+            Load_City(i);
+
+        Set_Search_Param(Param);
+        Attach_Globals();
+        Calculate_All_Pair_Distance<Metric>();
+        Identify_Candidate_Set();
+
+        return Search(Opt_Tour, Heatmap, 0, vector<int>(), false);
+    }
+
+    // Apply a change and re-optimize the tour around it. Removed and moved
+    // cities are given by their index before the update, Move_Input holds the
+    // new coordinates of the moved ones. Removals are applied by decreasing
+    // index, the last city taking the index of each removed one, then the
+    // Add_Input cities are appended. Budget is the search time in seconds (0:
+    // Param_T per city, for Update_Region_City_Num cities per changed city).
+    // The reference tour of the output is the repaired tour. Throw
+    // std::runtime_error, leaving the instance untouched, if the change is
+    // invalid (see Check_Update())
+    TSP_Output Update(const vector<double> &Add_Input, const vector<int> &Remove_City, const vector<int> &Move_City,
+                      const vector<double> &Move_Input, double Budget)
+    {
+        auto Update_Start = std::chrono::steady_clock::now();
+        Check_Update(Add_Input, Remove_City, Move_City, Move_Input);
+        int N = Shared.City_Num;
+        Set_Search_Param(Param);
+        Attach_Globals();
+
+        // Take the removed and moved cities out of the tour. The cities
+        // joined over the gaps are re-optimized as well
+        vector<int> Next(N), Pre(N);
+        for (int i = 0; i < N; i++)
+        {
+            Next[Tour[i]] = Tour[(i + 1) % N];
+            Pre[Tour[(i + 1) % N]] = Tour[i];
+        }
+        vector<char> If_Kept(N, true);
+        vector<int> Gap_City;
+        auto Unlink = [&](int City) {
+            Next[Pre[City]] = Next[City];
+            Pre[Next[City]] = Pre[City];
+            Gap_City.push_back(Pre[City]);
+            Gap_City.push_back(Next[City]);
+            If_Kept[City] = false;
+        };
+        for (int City : Remove_City)
+            Unlink(City);
+        for (int City : Move_City)
+            Unlink(City);
+
+        // The candidate rows that lose a city are identified again
+        vector<char> If_Row_Stale(N, false);
+        for (int i = 0; i < N; i++)
+            for (int j = 0; j < Shared.Candidate_Num[i] && !If_Row_Stale[i]; j++)
+                If_Row_Stale[i] = !If_Kept[Shared.Candidate[i][j]];
+
+        // Renumber: the last city takes the place of each removed one
+        vector<int> New_Index(N), Old_City(N);
+        for (int i = 0; i < N; i++)
+            New_Index[i] = Old_City[i] = i;
+        vector<int> Sorted_Remove_City(Remove_City);
+        sort(Sorted_Remove_City.rbegin(), Sorted_Remove_City.rend());
+        for (int City : Sorted_Remove_City)
+        {
+            int Last = --Shared.City_Num;
+            Release_Row(City);
+            New_Index[City] = Null;
+            if (City == Last)
+                continue;
+
+            New_Index[Old_City[Last]] = City;
+            Old_City[City] = Old_City[Last];
+            Move_Row(Shared.Distance, City, Last);
+            Move_Row(Shared.Edge_Heatmap, City, Last);
+            Move_Row(Shared.Weight, City, Last);
+            Move_Row(Shared.Chosen_Times, City, Last);
+            Shared.Candidate[City] = Shared.Candidate[Last];
+            Shared.Candidate_Num[City] = Shared.Candidate_Num[Last];
+            Shared.Coordinate_X[City] = Shared.Coordinate_X[Last];
+            Shared.Coordinate_Y[City] = Shared.Coordinate_Y[Last];
+            Shared.Coordinate_Z[City] = Shared.Coordinate_Z[Last];
+            std::copy_n(&Input[(size_t)Last * Metric::Dim], Metric::Dim, &Input[(size_t)City * Metric::Dim]);
+        }
+        int Kept_Num = Shared.City_Num;
+        Input.resize((size_t)Kept_Num * Metric::Dim);
+        for (int i = 0; i < Kept_Num; i++)
+            for (int j = 0; j < Shared.Candidate_Num[i]; j++)
+                Shared.Candidate[i][j] = New_Index[Shared.Candidate[i][j]];
+
+        // Load the moved and added cities
+        vector<int> Changed;
+        for (size_t k = 0; k < Move_City.size(); k++)
+        {
+            int City = New_Index[Move_City[k]];
+            std::copy_n(&Move_Input[k * Metric::Dim], Metric::Dim, &Input[(size_t)City * Metric::Dim]);
+            Changed.push_back(City);
+        }
+        int Add_Num = Add_Input.size() / Metric::Dim;
+        Reserve(Kept_Num + Add_Num);
+        Input.insert(Input.end(), Add_Input.begin(), Add_Input.begin() + (size_t)Add_Num * Metric::Dim);
+        for (int City = Kept_Num; City < Kept_Num + Add_Num; City++)
+        {
+            Add_Row(City);
+            Changed.push_back(City);
+        }
+        Shared.City_Num = Kept_Num + Add_Num;
+        Attach_Globals();
+
+        vector<char> If_Changed(Shared.City_Num, false);
+        for (int City : Changed)
+        {
+            If_Changed[City] = true;
+            Load_City(City);
+            Calculate_Distance_Row(City);
+        }
+        for (int City : Changed)
+            Identify_Candidates_Of(City);
+        for (int i = 0; i < Kept_Num; i++)
+        {
+            if (If_Changed[i])
+                continue;
+            if (If_Row_Stale[Old_City[i]])
+                Identify_Candidates_Of(i);
+            else
+                for (int City : Changed)
+                    Offer_Candidate(i, City);
+        }
+        Reset_Edge_Statistics(Changed, If_Changed);
+
+        // Repair the tour, then search around the changed cities
+        vector<int> New_Next(Shared.City_Num, Null), New_Pre(Shared.City_Num, Null);
+        int Tour_City_Num = 0;
+        for (int i = 0; i < Kept_Num; i++)
+            if (!If_Changed[i])
+            {
+                New_Next[i] = New_Index[Next[Old_City[i]]];
+                New_Pre[i] = New_Index[Pre[Old_City[i]]];
+                Tour_City_Num++;
+            }
+        for (int City : Changed)
+            Insert_City(City, New_Next, New_Pre, Tour_City_Num++);
+
+        Tour.resize(Shared.City_Num);
+        for (int i = 0, Cur_City = 0; i < Shared.City_Num; i++, Cur_City = New_Next[Cur_City])
+            Tour[i] = Cur_City;
+
+        for (int City : Gap_City)
+            if (If_Kept[City] && !If_Changed[New_Index[City]])
+            {
+                If_Changed[New_Index[City]] = true;
+                Changed.push_back(New_Index[City]);
+            }
+
+        if (Budget <= 0)
+        {
+            int Change_Num = max<int>(1, Remove_City.size() + Move_City.size() + Add_Num);
+            Budget = Param.Param_T * min(Shared.City_Num, Update_Region_City_Num * Change_Num);
+        }
+        vector<int> Repaired_Tour(Tour);
+        TSP_Output Output = Search(Repaired_Tour.data(), NULL, Budget, Changed, true);
+        Output.Overall_Time = Get_Elapsed_Time(Update_Start);
+        return Output;
+    }
+
+    // Throw std::runtime_error unless the instance was solved, the removed and
+    // moved cities are distinct indices of current cities, the coordinates
+    // match the cities, and Max_Depth still fits the updated instance
+    void Check_Update(const vector<double> &Add_Input, const vector<int> &Remove_City, const vector<int> &Move_City,
+                      const vector<double> &Move_Input) const
+    {
+        int N = Shared.City_Num;
+        if (N == 0)
+            throw std::runtime_error("The instance should be solved before being updated");
+        if (Add_Input.size() % Metric::Dim != 0 || Move_Input.size() != Move_City.size() * Metric::Dim)
+            throw std::runtime_error("Invalid added or moved city coordinates");
+
+        vector<char> If_Listed(N, false);
+        for (const vector<int> *Cities : {&Remove_City, &Move_City})
+            for (int City : *Cities)
+            {
+                if (City < 0 || City >= N || If_Listed[City])
+                    throw std::runtime_error("Invalid or repeated city index " + std::to_string(City));
+                If_Listed[City] = true;
+            }
+
+        int Add_Num = Add_Input.size() / Metric::Dim;
+        if (2 * Param.Max_Depth > N - (int)Remove_City.size() + Add_Num)
+            throw std::runtime_error("max_depth should be less than city_num/2 after the update");
+    }
+
+    // Grow the arrays to hold at least New_Capacity cities
+    void Reserve(int New_Capacity)
+    {
+        if (New_Capacity <= Capacity)
+            return;
+        New_Capacity = max(New_Capacity, 2 * Capacity);
+
+        int N = Shared.City_Num;
+        Grow_Array(Shared.Coordinate_X, N, New_Capacity);
+        Grow_Array(Shared.Coordinate_Y, N, New_Capacity);
+        Grow_Array(Shared.Coordinate_Z, N, New_Capacity);
+        Grow_Array(Shared.Candidate_Num, N, New_Capacity);
+        Grow_Array(Shared.Candidate, N, New_Capacity);
+        Grow_Matrix(Shared.Distance, N, New_Capacity);
+        Grow_Matrix(Shared.Edge_Heatmap, N, New_Capacity);
+        Grow_Matrix(Shared.Weight, N, New_Capacity);
+        Grow_Matrix(Shared.Chosen_Times, N, New_Capacity);
+        Capacity = New_Capacity;
+    }
+
+    template <typename T> static void Grow_Array(T *&Array, int Size, int New_Size)
+    {
+        T *New_Array = new T[New_Size];
+        if (Size > 0)
+            std::copy_n(Array, Size, New_Array);
+        delete[] Array;
+        Array = New_Array;
+    }
+
+    // Grow the Size rows of Matrix, and the array of rows, to New_Size entries
+    template <typename T> static void Grow_Matrix(T **&Matrix, int Size, int New_Size)
+    {
+        Grow_Array(Matrix, Size, New_Size);
+        for (int i = 0; i < Size; i++)
+            Grow_Array(Matrix[i], Size, New_Size);
+    }
+
+    // Give the row and the column of Last to City, whose row was released
+    template <typename T> static void Move_Row(T **Matrix, int City, int Last)
+    {
+        Matrix[City] = Matrix[Last];
+        for (int i = 0; i < Last; i++)
+            Matrix[i][City] = Matrix[i][Last];
+    }
+
+    void Add_Row(int City)
+    {
+        Shared.Distance[City] = new Distance_Type[Capacity];
+        Shared.Edge_Heatmap[City] = new float[Capacity];
+        Shared.Weight[City] = new float[Capacity];
+        Shared.Chosen_Times[City] = new int[Capacity];
+        Shared.Candidate[City] = new int[Param.Max_Candidate_Num];
+        Shared.Candidate_Num[City] = 0;
+    }
+
+    void Release_Row(int City)
+    {
+        delete[] Shared.Distance[City];
+        delete[] Shared.Edge_Heatmap[City];
+        delete[] Shared.Weight[City];
+        delete[] Shared.Chosen_Times[City];
+        delete[] Shared.Candidate[City];
+    }
+
+    // Point the globals of the calling thread to the structures of the instance
+    void Attach_Globals()
+    {
+        Virtual_City_Num = Shared.City_Num;
+        Coordinate_X = Shared.Coordinate_X;
+        Coordinate_Y = Shared.Coordinate_Y;
+        Coordinate_Z = Shared.Coordinate_Z;
+        Distance = Shared.Distance;
+        Candidate = Shared.Candidate;
+        Candidate_Num = Shared.Candidate_Num;
+    }
+
+    // Copy the input coordinates of City as Load_Instance_Input() does.
+    // Metric::Prepare() transforms the first Virtual_City_Num cities, so it is
+    // pointed to City alone
+    void Load_City(int City)
+    {
+        const double *Coordinate = &Input[(size_t)City * Metric::Dim];
+        Shared.Coordinate_X[City] = Coordinate[0] * Metric::Scale;
+        Shared.Coordinate_Y[City] = Coordinate[1] * Metric::Scale;
+        Shared.Coordinate_Z[City] = Metric::Dim > 2 ? Coordinate[Metric::Dim - 1] * Metric::Scale : 0;
+
+        Coordinate_X = Shared.Coordinate_X + City;
+        Coordinate_Y = Shared.Coordinate_Y + City;
+        Coordinate_Z = Shared.Coordinate_Z + City;
+        Virtual_City_Num = 1;
+        Metric::Prepare();
+        Attach_Globals();
+    }
+
+    void Calculate_Distance_Row(int City)
+    {
+        for (int i = 0; i < Shared.City_Num; i++)
+            Shared.Distance[City][i] = Shared.Distance[i][City] =
+                i == City ? Inf_Cost : Calculate_Int_Distance<Metric>(City, i);
+    }
+
+    void Identify_Candidates_Of(int City)
+    {
+        vector<double> Key(max(Param.Max_Candidate_Num, 1));
+        Top_Candidate_List List;
+        List.Init(Shared.Candidate[City], Key.data(), Param.Max_Candidate_Num);
+        for (int i = 0; i < Shared.City_Num; i++)
+            if (i != City && Shared.Distance[City][i] < Inf_Cost)
+                List.Offer(i, -(double)Shared.Distance[City][i]);
+        Shared.Candidate_Num[City] = List.Size;
+    }
+
+    // Add New_City to the candidates of City if it is among the nearest ones
+    void Offer_Candidate(int City, int New_City)
+    {
+        vector<double> Key(max(Param.Max_Candidate_Num, 1));
+        Top_Candidate_List List;
+        List.Init(Shared.Candidate[City], Key.data(), Param.Max_Candidate_Num);
+        List.Size = Shared.Candidate_Num[City];
+        for (int i = 0; i < List.Size; i++)
+            Key[i] = -(double)Shared.Distance[City][List.City[i]];
+        if (Shared.Distance[City][New_City] < Inf_Cost)
+            List.Offer(New_City, -(double)Shared.Distance[City][New_City]);
+        Shared.Candidate_Num[City] = List.Size;
+    }
+
+    // Insert City into the tour of Tour_City_Num cities where it adds the least
+    // length. Only the edges at its candidates are tried, unless none of them
+    // is in the tour yet
+    void Insert_City(int City, vector<int> &Next, vector<int> &Pre, int Tour_City_Num)
+    {
+        if (Tour_City_Num == 0)
+        {
+            Next[City] = Pre[City] = City;
+            return;
+        }
+
+        int Best_City = Null;
+        Distance_Type Best_Delta = 0;
+        auto Try_Edge = [&](int First_City) {
+            int Second_City = Next[First_City];
+            Distance_Type Delta = Shared.Distance[First_City][City] + Shared.Distance[City][Second_City] -
+                                  (First_City == Second_City ? 0 : Shared.Distance[First_City][Second_City]);
+            if (Best_City == Null || Delta < Best_Delta)
+            {
+                Best_City = First_City;
+                Best_Delta = Delta;
+            }
+        };
+        for (int j = 0; j < Shared.Candidate_Num[City]; j++)
+        {
+            int Candidate_City = Shared.Candidate[City][j];
+            if (Next[Candidate_City] == Null)
+                continue;
+            Try_Edge(Candidate_City);
+            Try_Edge(Pre[Candidate_City]);
+        }
+        if (Best_City == Null)
+            for (int i = 0; i < Shared.City_Num; i++)
+                if (Next[i] != Null)
+                    Try_Edge(i);
+
+        Next[City] = Next[Best_City];
+        Pre[City] = Best_City;
+        Pre[Next[Best_City]] = City;
+        Next[Best_City] = City;
+    }
+
+    // Set the heatmap and MCTS statistics of the edges at the changed cities
+    // as a cold search does from the candidate edge heatmap (see
+    // Set_Candidate_Edge_Heatmap() and MCTS_Init()). Those of the other edges
+    // are kept for the next search
+    void Reset_Edge_Statistics(const vector<int> &Changed, const vector<char> &If_Changed)
+    {
+        auto Set_Edge = [this](int First_City, int Second_City, float Value) {
+            Shared.Edge_Heatmap[First_City][Second_City] = Shared.Edge_Heatmap[Second_City][First_City] = Value;
+            Shared.Weight[First_City][Second_City] = Shared.Weight[Second_City][First_City] = Value * 100;
+            Shared.Chosen_Times[First_City][Second_City] = Shared.Chosen_Times[Second_City][First_City] = 0;
+        };
+        for (int City : Changed)
+            for (int i = 0; i < Shared.City_Num; i++)
+                Set_Edge(City, i, 0);
+        for (int i = 0; i < Shared.City_Num; i++)
+            for (int j = 0; j < Shared.Candidate_Num[i]; j++)
+                if (If_Changed[i] || If_Changed[Shared.Candidate[i][j]])
+                    Set_Edge(i, Shared.Candidate[i][j], 1);
+    }
+
+    // Run the MDP on the instance, from Start_Tour and the kept MCTS
+    // statistics if If_Warm_Start. A non-empty Region restricts the search to
+    // the region of these cities
+    TSP_Output Search(const int *Start_Tour, const double *Heatmap, double Budget, const vector<int> &Region,
+                      bool If_Warm_Start)
+    {
+        Search_Param Cur_Param = Param;
+        if (Budget > 0)
+            Cur_Param.Param_T = Budget / Shared.City_Num;
+        if (If_Warm_Start)
+        {
+            // Kicks keep the quality of the tour, and the rollouts start
+            // around the changed cities first
+            Cur_Param.Restart_Policy = Restart_Double_Bridge;
+            Cur_Param.Focused_Sampling = true;
+        }
+        else if (Heatmap == NULL &&
+                 (Param.Init_Method == Init_Heatmap_Sampling || Param.Init_Method == Init_Heatmap_Greedy))
+            Cur_Param.Init_Method = Init_Greedy_Edge; // there is no heatmap to construct from
+
+        Use_Warm_Start = If_Warm_Start;
+        Changed_City = Region;
+        TSP_Output Output = Solve_Instance<Metric>(Shared.City_Num, Cur_Param, NULL, Start_Tour, Heatmap, &Shared);
+        Use_Warm_Start = false;
+        Changed_City.clear();
+
+        Tour = Output.Solution;
+        return Output;
+    }
+};
+
+#endif // TSP_DYNAMIC_H
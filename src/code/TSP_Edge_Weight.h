@@ -0,0 +1,57 @@
+#ifndef TSP_EDGE_WEIGHT_H
+#define TSP_EDGE_WEIGHT_H
+
+#include "TSP_Basic_Functions.h"
+
+// Sparse MCTS edge weights, used to carry what a search learned over to a
+// later solve of the same cities: for each of the N cities, K neighbors
+// (Null padded) and the weights of the edges to them, both N x K row-major
+struct Sparse_Edge_Weight
+{
+    int K = 0;
+    vector<int> City;
+    vector<float> Weight;
+};
+
+// Prior of the current solve (NULL: Weight[][] starts from the heatmap)
+thread_local const Sparse_Edge_Weight *Prior_Edge_Weight = NULL;
+
+// Overwrite the initial Weight[][] with the prior weights, in both directions
+// since the weights are kept symmetric. Called by MCTS_Init()
+void Apply_Prior_Edge_Weight()
+{
+    if (Prior_Edge_Weight == NULL)
+        return;
+
+    int K = Prior_Edge_Weight->K;
+    for (int i = 0; i < Virtual_City_Num; i++)
+        for (int k = 0; k < K; k++)
+        {
+            int Neighbor = Prior_Edge_Weight->City[(size_t)i * K + k];
+            if (Neighbor < 0 || Neighbor >= Virtual_City_Num || Neighbor == i)
+                continue;
+            Weight[i][Neighbor] = Weight[Neighbor][i] = Prior_Edge_Weight->Weight[(size_t)i * K + k];
+        }
+}
+
+// Store in Output the K heaviest edges of each city, by decreasing weight
+void Export_Edge_Weight(int K, Sparse_Edge_Weight &Output)
+{
+    Output.K = K;
+    Output.City.assign((size_t)Virtual_City_Num * K, Null);
+    Output.Weight.assign((size_t)Virtual_City_Num * K, 0);
+
+    vector<double> Key(max(K, 1));
+    for (int i = 0; i < Virtual_City_Num; i++)
+    {
+        Top_Candidate_List List;
+        List.Init(Output.City.data() + (size_t)i * K, Key.data(), K);
+        for (int j = 0; j < Virtual_City_Num; j++)
+            if (j != i)
+                List.Offer(j, Weight[i][j]);
+        for (int k = 0; k < List.Size; k++)
+            Output.Weight[(size_t)i * K + k] = (float)Key[k];
+    }
+}
+
+#endif // TSP_EDGE_WEIGHT_H
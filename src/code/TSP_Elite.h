@@ -0,0 +1,252 @@
+#ifndef TSP_ELITE_H
+#define TSP_ELITE_H
+
+#include "TSP_2Opt.h"
+
+// Elite pool (Elite_Pool_Size): the shortest distinct tours reached at the end
+// of the restarts, which are otherwise lost unless they beat the best tour.
+// A restart starts from the offspring of two of them by partition crossover
+// instead of a kick if that offspring is shorter than the best tour: the
+// edges of both parents, minus the shared ones, split into components, and
+// each component that both parents enter only once can take its path from
+// either parent. The offspring starts from the shorter parent and takes the
+// shorter path of each such component, so it keeps every shared edge and
+// combines the best parts of both. It costs O(N)
+
+thread_local vector<vector<int>> Elite_Tour; // tours in Solution[] order, from Start_City
+thread_local vector<Distance_Type> Elite_Distance;
+thread_local vector<char> If_Elite_Pair_Crossed; // Elite_Pool_Size x Elite_Pool_Size, pairs already recombined
+
+// Work arrays of the crossover
+thread_local vector<int> Parent_Pre[2], Parent_Next[2];
+thread_local vector<int> Elite_Component, Elite_Stack;
+thread_local vector<int> Component_Run_Num[2];
+thread_local vector<Distance_Type> Component_Cost[2];
+thread_local vector<char> If_Take_Second_Path;
+thread_local vector<std::pair<int, int>> Elite_Pair;
+
+void Init_Elite_Pool()
+{
+    Elite_Tour.clear();
+    Elite_Distance.clear();
+    If_Elite_Pair_Crossed.assign((size_t)Elite_Pool_Size * Elite_Pool_Size, false);
+}
+
+// Return true if the two tours from Start_City have the same edges
+bool If_Same_Tour(const vector<int> &First_Tour, const vector<int> &Second_Tour)
+{
+    if (First_Tour == Second_Tour)
+        return true;
+    int N = (int)First_Tour.size();
+    for (int i = 1; i < N; i++)
+        if (First_Tour[i] != Second_Tour[N - i])
+            return false;
+    return true;
+}
+
+// Add the tour stored in All_Node to the pool if it is shorter than the
+// longest elite tour and not already in the pool
+void Add_Elite_Tour()
+{
+    if (Elite_Pool_Size < 2)
+        return;
+
+    Distance_Type Distance = Get_Solution_Total_Distance();
+    int Slot = (int)Elite_Tour.size();
+    if (Slot == Elite_Pool_Size)
+    {
+        Slot = (int)(std::max_element(Elite_Distance.begin(), Elite_Distance.end()) - Elite_Distance.begin());
+        if (Distance >= Elite_Distance[Slot])
+            return;
+    }
+
+    vector<int> Tour;
+    Tour.reserve(Virtual_City_Num);
+    int Cur_City = Start_City;
+    do
+    {
+        Tour.push_back(Cur_City);
+        Cur_City = All_Node[Cur_City].Next_City;
+    } while (Cur_City != Null && Cur_City != Start_City);
+    if ((int)Tour.size() != Virtual_City_Num)
+        return;
+
+    for (int i = 0; i < (int)Elite_Tour.size(); i++)
+        if (Elite_Distance[i] == Distance && If_Same_Tour(Elite_Tour[i], Tour))
+            return;
+
+    if (Slot == (int)Elite_Tour.size())
+    {
+        Elite_Tour.push_back(std::move(Tour));
+        Elite_Distance.push_back(Distance);
+    }
+    else
+    {
+        Elite_Tour[Slot] = std::move(Tour);
+        Elite_Distance[Slot] = Distance;
+    }
+    // The new tour may be recombined with every other one
+    for (int i = 0; i < Elite_Pool_Size; i++)
+        If_Elite_Pair_Crossed[(size_t)Slot * Elite_Pool_Size + i] =
+            If_Elite_Pair_Crossed[(size_t)i * Elite_Pool_Size + Slot] = false;
+}
+
+// Return true if the edge (First_City, Second_City) belongs to the parent
+bool If_Parent_Edge(int Parent, int First_City, int Second_City)
+{
+    return Parent_Next[Parent][First_City] == Second_City || Parent_Pre[Parent][First_City] == Second_City;
+}
+
+// Partition crossover of the elite tours First and Second, the shorter one
+// being the base. Store the offspring in Solution[] and activate the cities
+// whose path was taken from the other parent. Return false if the offspring
+// would be one of the parents or not shorter than the best tour
+bool Partition_Crossover(int First, int Second)
+{
+    if (Elite_Distance[Second] < Elite_Distance[First])
+        std::swap(First, Second);
+    const vector<int> *Tour[2] = {&Elite_Tour[First], &Elite_Tour[Second]};
+    int N = Virtual_City_Num;
+    for (int p = 0; p < 2; p++)
+    {
+        Parent_Pre[p].resize(N);
+        Parent_Next[p].resize(N);
+        for (int i = 0; i < N; i++)
+        {
+            int Cur_City = (*Tour[p])[i];
+            int Next_City = (*Tour[p])[(i + 1) % N];
+            Parent_Next[p][Cur_City] = Next_City;
+            Parent_Pre[p][Next_City] = Cur_City;
+        }
+    }
+
+    // Components of the edges that are in one parent only, Null for the
+    // cities whose two edges are shared
+    Elite_Component.assign(N, Null);
+    int Component_Num = 0;
+    for (int i = 0; i < N; i++)
+    {
+        if (Elite_Component[i] != Null ||
+            (If_Parent_Edge(1, i, Parent_Next[0][i]) && If_Parent_Edge(1, i, Parent_Pre[0][i])))
+            continue;
+
+        Elite_Component[i] = Component_Num;
+        Elite_Stack.assign(1, i);
+        while (!Elite_Stack.empty())
+        {
+            int Cur_City = Elite_Stack.back();
+            Elite_Stack.pop_back();
+            for (int p = 0; p < 2; p++)
+            {
+                int Neighbor[2] = {Parent_Next[p][Cur_City], Parent_Pre[p][Cur_City]};
+                for (int Next_City : Neighbor)
+                    if (!If_Parent_Edge(1 - p, Cur_City, Next_City) && Elite_Component[Next_City] == Null)
+                    {
+                        Elite_Component[Next_City] = Component_Num;
+                        Elite_Stack.push_back(Next_City);
+                    }
+            }
+        }
+        Component_Num++;
+    }
+    if (Component_Num < 2)
+        return false;
+
+    // Number of times each parent enters each component, and length of the
+    // edges of each component that are in one parent only. A shared path
+    // leaving a component and coming back to it does not count as an entry:
+    // it is the same in both parents whatever the path inside
+    for (int p = 0; p < 2; p++)
+    {
+        Component_Run_Num[p].assign(Component_Num, 0);
+        Component_Cost[p].assign(Component_Num, 0);
+        int Last_Component = Null;
+        for (int i = N - 1; i >= 0 && Last_Component == Null; i--)
+            Last_Component = Elite_Component[(*Tour[p])[i]];
+        for (int i = 0; i < N; i++)
+        {
+            int Cur_City = (*Tour[p])[i];
+            int Pre_City = Parent_Pre[p][Cur_City];
+            int Component = Elite_Component[Cur_City];
+            if (Component == Null)
+                continue;
+            if (Component != Last_Component)
+                Component_Run_Num[p][Component]++;
+            Last_Component = Component;
+            if (!If_Parent_Edge(1 - p, Cur_City, Pre_City))
+                Component_Cost[p][Component] += Get_Distance(Pre_City, Cur_City);
+        }
+    }
+
+    // A component entered once by both parents is left at the same cities
+    // by both, so its path can be taken from either
+    int Taken_Num = 0;
+    Distance_Type Offspring_Distance = Elite_Distance[First];
+    If_Take_Second_Path.resize(Component_Num);
+    for (int c = 0; c < Component_Num; c++)
+    {
+        If_Take_Second_Path[c] = Component_Run_Num[0][c] == 1 && Component_Run_Num[1][c] == 1 &&
+                                 Component_Cost[1][c] < Component_Cost[0][c];
+        if (If_Take_Second_Path[c])
+        {
+            Taken_Num++;
+            Offspring_Distance -= Component_Cost[0][c] - Component_Cost[1][c];
+        }
+    }
+    if (Taken_Num == 0 || Taken_Num == Component_Num || Offspring_Distance >= Current_Instance_Best_Distance)
+        return false;
+
+    // Walk the offspring: each city keeps the neighbors of the parent its
+    // component is taken from
+    int Pre_City = Null;
+    int Cur_City = Start_City;
+    for (int i = 0; i < N; i++)
+    {
+        if (Cur_City == Null || (i > 0 && Cur_City == Start_City))
+            return false;
+        Solution[i] = Cur_City;
+        int Component = Elite_Component[Cur_City];
+        int p = Component != Null && If_Take_Second_Path[Component] ? 1 : 0;
+        int Next_City = Parent_Next[p][Cur_City];
+        if (Next_City == Pre_City)
+            Next_City = Parent_Pre[p][Cur_City];
+        Pre_City = Cur_City;
+        Cur_City = Next_City;
+    }
+    if (Cur_City != Start_City)
+        return false;
+
+    for (int i = 0; i < N; i++)
+        if (Elite_Component[i] != Null && If_Take_Second_Path[Elite_Component[i]])
+            Activate_City(i);
+    return true;
+}
+
+// Store in Solution[] the offspring of a pair of elite tours not recombined
+// yet, and activate the cities to re-optimize. Return false if no pair gives
+// an offspring
+bool Recombine_Elite_Tours()
+{
+    int Elite_Num = (int)Elite_Tour.size();
+    Elite_Pair.clear();
+    for (int i = 0; i < Elite_Num; i++)
+        for (int j = i + 1; j < Elite_Num; j++)
+            if (!If_Elite_Pair_Crossed[(size_t)i * Elite_Pool_Size + j])
+                Elite_Pair.push_back(std::make_pair(i, j));
+
+    while (!Elite_Pair.empty())
+    {
+        int Index = Get_Random_Int(Elite_Pair.size());
+        std::pair<int, int> Pair = Elite_Pair[Index];
+        Elite_Pair[Index] = Elite_Pair.back();
+        Elite_Pair.pop_back();
+
+        If_Elite_Pair_Crossed[(size_t)Pair.first * Elite_Pool_Size + Pair.second] =
+            If_Elite_Pair_Crossed[(size_t)Pair.second * Elite_Pool_Size + Pair.first] = true;
+        if (Partition_Crossover(Pair.first, Pair.second))
+            return true;
+    }
+    return false;
+}
+
+#endif // TSP_ELITE_H
@@ -0,0 +1,189 @@
+#ifndef TSP_ENSEMBLE_H
+#define TSP_ENSEMBLE_H
+
+#include <atomic>
+#include <exception>
+#include <thread>
+
+#include "TSP_Solver.h"
+
+// Solve one instance of N cities once per heatmap of an ensemble (Heatmaps
+// holds Heatmap_Num row-major N x N heatmaps). The coordinates, Distance[][]
+// and the heatmap-independent candidate sets are built once and shared
+// read-only, while each member search owns its tour and Weight[][]. Up to
+// Thread_Num members run concurrently (0: one per core), and the time left
+// over by members stopped on stagnation goes to the ones still improving
+template <typename Metric>
+vector<TSP_Output> Solve_Ensemble(int N, const Search_Param &Param, const typename Metric::Input_Type *Input,
+                                  const int *Opt_Tour, const double *Heatmaps, int Heatmap_Num, int Thread_Num)
+{
+    Shared_Instance Shared;
+    Shared.Build<Metric>(N, Param, Input);
+
+    if (Thread_Num <= 0)
+        Thread_Num = max(1u, std::thread::hardware_concurrency());
+    Thread_Num = min(Thread_Num, Heatmap_Num);
+
+    vector<TSP_Output> Outputs(Heatmap_Num);
+    vector<std::exception_ptr> Errors(Heatmap_Num);
+    Budget_Bank Bank;
+    std::atomic<int> Next_Member(0);
+    auto Worker = [&]() {
+        Shared_Budget_Bank = &Bank;
+        while (true)
+        {
+            int Member = Next_Member++;
+            if (Member >= Heatmap_Num)
+                break;
+
+            try
+            {
+                Outputs[Member] = Solve_Instance<Metric>(N, Param, Input, Opt_Tour,
+                                                         Heatmaps + (size_t)Member * N * N, &Shared);
+            }
+            catch (...)
+            {
+                Errors[Member] = std::current_exception();
+            }
+        }
+        Shared_Budget_Bank = NULL;
+    };
+
+    vector<std::thread> Workers;
+    for (int i = 0; i < Thread_Num; i++)
+        Workers.emplace_back(Worker);
+    for (auto &Cur_Worker : Workers)
+        Cur_Worker.join();
+
+    for (auto &Error : Errors)
+        if (Error)
+            std::rethrow_exception(Error);
+
+    return Outputs;
+}
+
+// Solve one instance of N cities with Param.Island_Num concurrent searches,
+// the islands of TSP_Island.h, and return the output of the island that found
+// the shortest tour. The instance is built once and shared read-only, as for
+// an ensemble, and so is the lower bound, computed once for all islands. Only
+// the first island checkpoints or resumes. The cancellation of the calling
+// thread applies to all islands
+template <typename Metric>
+TSP_Output Solve_Islands(int N, const Search_Param &Param, const typename Metric::Input_Type *Input,
+                         const int *Opt_Tour, const void *Heatmap, const Sparse_Edge_Weight *Prior_Weight = NULL)
+{
+    auto Overall_Start = std::chrono::steady_clock::now();
+    int Cur_Island_Num = max(Param.Island_Num, 1);
+    Shared_Instance Shared;
+    Shared.Build<Metric>(N, Param, Input);
+
+    Island_Board Board;
+    Lower_Bound_Task Lower_Bound;
+    if (Param.Compute_Lower_Bound || Param.Target_Gap > 0)
+    {
+        Lower_Bound.Start(); // on the shared Distance[][], which Build() left to the calling thread
+        Board.Lower_Bound = &Lower_Bound.Bound;
+    }
+
+    const std::atomic<unsigned> *Caller_Cancel_Epoch = Cancel_Epoch;
+    unsigned Caller_Solve_Epoch = Solve_Epoch;
+    vector<TSP_Output> Outputs(Cur_Island_Num);
+    vector<std::exception_ptr> Errors(Cur_Island_Num);
+    auto Worker = [&](int Index) {
+        Shared_Island_Board = &Board;
+        Island_Index = Index;
+        Cancel_Epoch = Caller_Cancel_Epoch;
+        Solve_Epoch = Caller_Solve_Epoch;
+        Search_Param Island_Param = Param;
+        Island_Param.Island_Num = 1;
+        if (Index > 0)
+            Island_Param.Checkpoint_Path = Island_Param.Resume_Path = "";
+        try
+        {
+            Outputs[Index] = Solve_Instance<Metric>(N, Island_Param, Input, Opt_Tour, Heatmap, &Shared, Prior_Weight);
+        }
+        catch (...)
+        {
+            Errors[Index] = std::current_exception();
+        }
+        Shared_Island_Board = NULL;
+        Island_Index = 0;
+        Cancel_Epoch = NULL;
+    };
+
+    vector<std::thread> Workers;
+    for (int i = 0; i < Cur_Island_Num; i++)
+        Workers.emplace_back(Worker, i);
+    for (auto &Cur_Worker : Workers)
+        Cur_Worker.join();
+
+    for (auto &Error : Errors)
+        if (Error)
+            std::rethrow_exception(Error);
+
+    int Best_Island = 0;
+    for (int i = 1; i < Cur_Island_Num; i++)
+        if (Outputs[i].MCTS_Distance < Outputs[Best_Island].MCTS_Distance)
+            Best_Island = i;
+    TSP_Output Output = std::move(Outputs[Best_Island]);
+
+    long long Bound = Lower_Bound.Finish();
+    Distance_Type Best_Distance = Board.Best_Distance.load();
+    if (Bound > 0 && Best_Distance < Inf_Cost)
+    {
+        Output.Lower_Bound = Bound / Metric::Scale;
+        Output.Certified_Gap = (double)(Best_Distance - Bound) / Bound;
+    }
+    Output.Overall_Time = Get_Elapsed_Time(Overall_Start);
+    return Output;
+}
+
+// Dispatch an island solve to the metric policy chosen at run time, as
+// Solve_Instance_By_Metric does for a single search
+TSP_Output Solve_Islands_By_Metric(int Metric_Id, int N, const Search_Param &Param, const double *Coordinates,
+                                   const int *Distance_Matrix, const int *Opt_Tour, const void *Heatmap,
+                                   const Sparse_Edge_Weight *Prior_Weight = NULL)
+{
+    switch (Metric_Id)
+    {
+    case Metric_Id_EUC_3D:
+        return Solve_Islands<Metric_EUC_3D>(N, Param, Coordinates, Opt_Tour, Heatmap, Prior_Weight);
+    case Metric_Id_CEIL_2D:
+        return Solve_Islands<Metric_CEIL_2D>(N, Param, Coordinates, Opt_Tour, Heatmap, Prior_Weight);
+    case Metric_Id_GEO:
+        return Solve_Islands<Metric_GEO>(N, Param, Coordinates, Opt_Tour, Heatmap, Prior_Weight);
+    case Metric_Id_ATT:
+        return Solve_Islands<Metric_ATT>(N, Param, Coordinates, Opt_Tour, Heatmap, Prior_Weight);
+    case Metric_Id_Explicit:
+        return Solve_Islands<Metric_Explicit>(N, Param, Distance_Matrix, Opt_Tour, Heatmap, Prior_Weight);
+    default:
+        return Solve_Islands<Metric_EUC_2D>(N, Param, Coordinates, Opt_Tour, Heatmap, Prior_Weight);
+    }
+}
+
+// Dispatch an ensemble to the metric policy chosen at run time, as
+// Solve_Instance_By_Metric does for a single solve
+vector<TSP_Output> Solve_Ensemble_By_Metric(int Metric_Id, int N, const Search_Param &Param,
+                                            const double *Coordinates, const int *Distance_Matrix,
+                                            const int *Opt_Tour, const double *Heatmaps, int Heatmap_Num,
+                                            int Thread_Num)
+{
+    switch (Metric_Id)
+    {
+    case Metric_Id_EUC_3D:
+        return Solve_Ensemble<Metric_EUC_3D>(N, Param, Coordinates, Opt_Tour, Heatmaps, Heatmap_Num, Thread_Num);
+    case Metric_Id_CEIL_2D:
+        return Solve_Ensemble<Metric_CEIL_2D>(N, Param, Coordinates, Opt_Tour, Heatmaps, Heatmap_Num, Thread_Num);
+    case Metric_Id_GEO:
+        return Solve_Ensemble<Metric_GEO>(N, Param, Coordinates, Opt_Tour, Heatmaps, Heatmap_Num, Thread_Num);
+    case Metric_Id_ATT:
+        return Solve_Ensemble<Metric_ATT>(N, Param, Coordinates, Opt_Tour, Heatmaps, Heatmap_Num, Thread_Num);
+    case Metric_Id_Explicit:
+        return Solve_Ensemble<Metric_Explicit>(N, Param, Distance_Matrix, Opt_Tour, Heatmaps, Heatmap_Num,
+                                               Thread_Num);
+    default:
+        return Solve_Ensemble<Metric_EUC_2D>(N, Param, Coordinates, Opt_Tour, Heatmaps, Heatmap_Num, Thread_Num);
+    }
+}
+
+#endif // TSP_ENSEMBLE_H
@@ -0,0 +1,168 @@
+#ifndef TSP_FOCUS_H
+#define TSP_FOCUS_H
+
+#include <algorithm>
+
+#include "TSP_Basic_Functions.h"
+
+// Focused sampling: instead of drawing the start city of each rollout
+// uniformly, take first the cities around the edges changed by the last
+// executed actions, then the cities whose tour edge is not among their
+// candidates, by decreasing variance of their learned edge weights. A share of
+// the rollouts still starts from random cities, so that no city is starved.
+// The number of rollouts of a simulation follows the observed success rate
+
+#define Random_Start_Rate 4 // one rollout in Random_Start_Rate starts from a random city
+#define Success_Count_Decay 0.99 // decay of the success statistics at each simulation
+#define Min_Fruitless_Share 0.25 // least share of MCTS_Patience a fruitless simulation counts for
+
+// Decayed numbers of rollouts and of successful simulations of the instance
+thread_local double Rollout_Count;
+thread_local double Success_Count;
+
+void Push_Focus_City_Front(int City)
+{
+    if (If_City_Focused[City])
+        return;
+    Focus_City_Head = (Focus_City_Head - 1 + Virtual_City_Num) % Virtual_City_Num;
+    Focus_City[Focus_City_Head] = City;
+    If_City_Focused[City] = true;
+    Focus_City_Num++;
+}
+
+void Push_Focus_City_Back(int City)
+{
+    if (If_City_Focused[City])
+        return;
+    Focus_City[(Focus_City_Head + Focus_City_Num) % Virtual_City_Num] = City;
+    If_City_Focused[City] = true;
+    Focus_City_Num++;
+}
+
+int Pop_Focus_City()
+{
+    int City = Focus_City[Focus_City_Head];
+    Focus_City_Head = (Focus_City_Head + 1) % Virtual_City_Num;
+    Focus_City_Num--;
+    If_City_Focused[City] = false;
+    return City;
+}
+
+void Init_Focused_Sampling()
+{
+    while (Focus_City_Num > 0)
+        Pop_Focus_City();
+    Rollout_Count = 0;
+    Success_Count = 0;
+}
+
+bool If_Candidate_Edge(int First_City, int Second_City)
+{
+    for (int i = 0; i < Candidate_Num[First_City]; i++)
+        if (Candidate[First_City][i] == Second_City)
+            return true;
+    return false;
+}
+
+// Variance of the weights of the candidate edges of City
+float Get_Candidate_Weight_Variance(int City)
+{
+    if (Candidate_Num[City] == 0)
+        return 0;
+
+    float Total_Weight = 0, Total_Square_Weight = 0;
+    for (int i = 0; i < Candidate_Num[City]; i++)
+    {
+        float Cur_Weight = Weight[City][Candidate[City][i]];
+        Total_Weight += Cur_Weight;
+        Total_Square_Weight += Cur_Weight * Cur_Weight;
+    }
+    float Mean_Weight = Total_Weight / Candidate_Num[City];
+    return Total_Square_Weight / Candidate_Num[City] - Mean_Weight * Mean_Weight;
+}
+
+// Queue the cities whose tour edge is not a candidate edge, by decreasing
+// variance of their candidate weights. Called at the start of each MCTS
+void Prioritize_Start_Cities()
+{
+    vector<std::pair<float, int>> Priority;
+    for (int i = 0; i < Virtual_City_Num; i++)
+        if (!If_Candidate_Edge(i, All_Node[i].Next_City))
+            Priority.push_back(std::make_pair(-Get_Candidate_Weight_Variance(i), i));
+    sort(Priority.begin(), Priority.end());
+
+    for (auto &Cur_Priority : Priority)
+        Push_Focus_City_Back(Cur_Priority.second);
+}
+
+// Put the cities of the action just executed (stored in City_Sequence[]) and
+// their candidates at the front of the queue
+void Focus_On_Changed_Cities()
+{
+    for (int i = 0; i < 2 * Pair_City_Num; i++)
+    {
+        int City = City_Sequence[i];
+        for (int j = 0; j < Candidate_Num[City]; j++)
+            Push_Focus_City_Front(Candidate[City][j]);
+        Push_Focus_City_Front(City);
+    }
+}
+
+// Put the given cities and their candidates at the front of the queue
+void Focus_On_Cities(const vector<int> &Cities)
+{
+    for (int City : Cities)
+    {
+        for (int j = 0; j < Candidate_Num[City]; j++)
+            Push_Focus_City_Front(Candidate[City][j]);
+        Push_Focus_City_Front(City);
+    }
+}
+
+// Start city of the next rollout
+int Get_Begin_City()
+{
+    if (!Focused_Sampling || Focus_City_Num == 0 || Get_Random_Int(Random_Start_Rate) == 0)
+        return Get_Random_Int(Virtual_City_Num);
+    return Pop_Focus_City();
+}
+
+// Maximum number of rollouts of a simulation without focused sampling
+int Get_Full_Simulation_Budget()
+{
+    return Param_H * Virtual_City_Num;
+}
+
+// Maximum number of rollouts of the next simulation: Param_H divided by the
+// success rate per rollout, estimated with a prior of one success per
+// Virtual_City_Num rollouts (which gives the full budget), and no more than
+// the rollouts left after the fruitless simulations in a row, which end the
+// MCTS once their shares reach MCTS_Patience (see Get_Fruitless_Share())
+int Get_Simulation_Budget(double Fruitless_Share)
+{
+    int Full_Budget = Get_Full_Simulation_Budget();
+    if (!Focused_Sampling)
+        return Full_Budget;
+
+    double Success_Rate = (Success_Count + 1) / (Rollout_Count + Virtual_City_Num);
+    double Budget = min(Param_H / Success_Rate, (MCTS_Patience - Fruitless_Share) * Full_Budget);
+    return max(1, (int)min(Budget, (double)Full_Budget));
+}
+
+// Share of MCTS_Patience a fruitless simulation of Budget rollouts counts
+// for: its share of the full budget, so that a short focused simulation does
+// not end the MCTS on its own, but at least Min_Fruitless_Share, so that a
+// few of them do. The fruitless simulations ending a MCTS thus take at most
+// the rollouts of MCTS_Patience full ones
+double Get_Fruitless_Share(int Budget)
+{
+    return max((double)Budget / Get_Full_Simulation_Budget(), Min_Fruitless_Share);
+}
+
+void Record_Simulation(int Rollout_Num, bool If_Success)
+{
+    Rollout_Count = Success_Count_Decay * Rollout_Count + Rollout_Num;
+    Success_Count = Success_Count_Decay * Success_Count + (If_Success ? 1 : 0);
+}
+
+#endif // TSP_FOCUS_H
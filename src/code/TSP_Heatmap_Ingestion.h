@@ -0,0 +1,212 @@
+#ifndef TSP_HEATMAP_INGESTION_H
+#define TSP_HEATMAP_INGESTION_H
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include "TSP_Basic_Functions.h"
+
+#define Ingestion_Tile_Size 64            // rows and columns of a tile, 2 x 32KB of input doubles
+#define Min_Ingestion_Row_Per_Thread 1024 // smaller instances are ingested by the calling thread
+
+// Symmetrization of the input entries H[i][j] and H[j][i] in the storage
+// format, and dequantization of a stored entry. Float16 entries are averaged
+// in float, uint8 ones are averaged rounding half up
+inline float Get_Symmetric_Heatmap_Entry(double First, double Second)
+{
+    return ((float)First + (float)Second) / 2;
+}
+
+inline uint16_t Get_Symmetric_Heatmap_Entry(uint16_t First, uint16_t Second)
+{
+    return Float_To_Half((Half_To_Float(First) + Half_To_Float(Second)) / 2);
+}
+
+inline uint8_t Get_Symmetric_Heatmap_Entry(uint8_t First, uint8_t Second)
+{
+    return (uint8_t)((First + Second + 1) / 2);
+}
+
+inline float Dequantize_Heatmap_Entry(float Entry, float)
+{
+    return Entry;
+}
+
+inline float Dequantize_Heatmap_Entry(uint16_t Entry, float)
+{
+    return Half_To_Float(Entry);
+}
+
+inline float Dequantize_Heatmap_Entry(uint8_t Entry, float Scale)
+{
+    return Entry * Scale;
+}
+
+// Ingest_Heatmap() for a heatmap of Input_Type entries, stored in the rows
+// Cur_Edge_Heatmap of Stored_Type entries
+template <typename Input_Type, typename Stored_Type>
+void Ingest_Heatmap_In_Format(const Input_Type *Heatmap, Stored_Type **Cur_Edge_Heatmap, bool If_Select_Candidate,
+                              const int *Order)
+{
+    // The workers do not see the thread_local state of the caller
+    int N = Virtual_City_Num;
+    float Scale = (float)Heatmap_Scale;
+    float **Cur_Weight = Weight;
+    int **Cur_Chosen_Times = Chosen_Times;
+    Distance_Type **Cur_Distance = Distance;
+    int **Cur_Candidate = Candidate;
+    int *Cur_Candidate_Num = Candidate_Num;
+    int Cur_Max_Candidate_Num = Max_Candidate_Num;
+
+    int Thread_Num = min((int)std::thread::hardware_concurrency(), N / Min_Ingestion_Row_Per_Thread);
+    auto Run_Workers = [Thread_Num](const std::function<void()> &Worker) {
+        vector<std::thread> Workers;
+        for (int i = 1; i < Thread_Num; i++)
+            Workers.emplace_back(Worker);
+        Worker();
+        for (auto &Cur_Worker : Workers)
+            Cur_Worker.join();
+    };
+
+    // A band of rows covers the tiles of its diagonal and on its right. Each
+    // tile (I, J) is symmetrized with its transpose (J, I) from one read of
+    // both input tiles, and stored into both. Bands are handed out by
+    // decreasing size
+    int Band_Num = (N + Ingestion_Tile_Size - 1) / Ingestion_Tile_Size;
+    std::atomic<int> Next_Band(0);
+    Run_Workers([&]() {
+        for (int Band; (Band = Next_Band++) < Band_Num;)
+        {
+            int Row_Begin = Band * Ingestion_Tile_Size;
+            int Row_End = min(Row_Begin + Ingestion_Tile_Size, N);
+            for (int Col_Begin = Row_Begin; Col_Begin < N; Col_Begin += Ingestion_Tile_Size)
+            {
+                int Col_End = min(Col_Begin + Ingestion_Tile_Size, N);
+                for (int i = Row_Begin; i < Row_End; i++)
+                {
+                    int First_Col = max(Col_Begin, i); // the diagonal tile is its own transpose
+                    Stored_Type *Edge_Heatmap_Row = Cur_Edge_Heatmap[i];
+                    if (Order == NULL)
+                    {
+                        const Input_Type *Row = Heatmap + (size_t)i * N;
+                        for (int j = First_Col; j < Col_End; j++)
+                            Edge_Heatmap_Row[j] = Get_Symmetric_Heatmap_Entry(Row[j], Heatmap[(size_t)j * N + i]);
+                    }
+                    else
+                    {
+                        const Input_Type *Row = Heatmap + (size_t)Order[i] * N;
+                        for (int j = First_Col; j < Col_End; j++)
+                            Edge_Heatmap_Row[j] =
+                                Get_Symmetric_Heatmap_Entry(Row[Order[j]], Heatmap[(size_t)Order[j] * N + Order[i]]);
+                    }
+                }
+                // The transposed tile is copied from the stored one, still in
+                // cache
+                if (Col_Begin != Row_Begin)
+                    for (int j = Col_Begin; j < Col_End; j++)
+                    {
+                        Stored_Type *Edge_Heatmap_Row = Cur_Edge_Heatmap[j];
+                        for (int i = Row_Begin; i < Row_End; i++)
+                            Edge_Heatmap_Row[i] = Cur_Edge_Heatmap[i][j];
+                    }
+                else
+                    for (int i = Row_Begin; i < Row_End; i++)
+                        for (int j = Row_Begin; j < i; j++)
+                            Cur_Edge_Heatmap[i][j] = Cur_Edge_Heatmap[j][i];
+
+                // Then the weights of both tiles are initialized row by row
+                for (int Tile = 0; Tile < (Col_Begin != Row_Begin ? 2 : 1); Tile++)
+                {
+                    int Tile_Row_Begin = Tile == 0 ? Row_Begin : Col_Begin;
+                    int Tile_Row_End = Tile == 0 ? Row_End : Col_End;
+                    int Tile_Col_Begin = Tile == 0 ? Col_Begin : Row_Begin;
+                    int Tile_Col_End = Tile == 0 ? Col_End : Row_End;
+                    for (int i = Tile_Row_Begin; i < Tile_Row_End; i++)
+                    {
+                        const Stored_Type *Edge_Heatmap_Row = Cur_Edge_Heatmap[i];
+                        float *Weight_Row = Cur_Weight[i];
+                        for (int j = Tile_Col_Begin; j < Tile_Col_End; j++)
+                            Weight_Row[j] = Dequantize_Heatmap_Entry(Edge_Heatmap_Row[j], Scale) * 100;
+                        std::fill(Cur_Chosen_Times[i] + Tile_Col_Begin, Cur_Chosen_Times[i] + Tile_Col_End, 0);
+                    }
+                }
+            }
+        }
+    });
+
+    // The candidates are selected from the stored rows, whose columns are
+    // visited by increasing index as the candidate lists require
+    std::atomic<int> Next_City(0);
+    if (If_Select_Candidate)
+        Run_Workers([&]() {
+            vector<double> Key(max(Cur_Max_Candidate_Num, 1));
+            Top_Candidate_List List;
+            for (int i; (i = Next_City++) < N;)
+            {
+                const Stored_Type *Edge_Heatmap_Row = Cur_Edge_Heatmap[i];
+                const Distance_Type *Distance_Row = Cur_Distance[i];
+                List.Init(Cur_Candidate[i], Key.data(), Cur_Max_Candidate_Num);
+                for (int j = 0; j < N; j++)
+                {
+                    float Value = Dequantize_Heatmap_Entry(Edge_Heatmap_Row[j], Scale);
+                    if (j != i && Value >= 0.0001 && Distance_Row[j] < Inf_Cost)
+                        List.Offer(j, Value);
+                }
+                Cur_Candidate_Num[i] = List.Size;
+            }
+        });
+
+    If_Weight_Initialized = true;
+}
+
+// Read the row-major N x N Heatmap, of Heatmap_Format entries, once and, tile
+// by tile, store its symmetrization ((H[i][j] + H[j][i]) / 2) in the heatmap
+// matrix of that format, initialize Weight[][] and Chosen_Times[][] as
+// MCTS_Init() does, and, if If_Select_Candidate, select the candidates by
+// heatmap as Identify_Candidate_Set() does. Each entry is read with its
+// transposed one, and both symmetric entries are written from them. If Order
+// is given, city i is city Order[i] of the heatmap (see TSP_Renumber.h)
+void Ingest_Heatmap(const void *Heatmap, bool If_Select_Candidate, const int *Order = NULL)
+{
+    if (Heatmap_Format == Heatmap_Float16)
+        Ingest_Heatmap_In_Format((const uint16_t *)Heatmap, Edge_Heatmap_Half, If_Select_Candidate, Order);
+    else if (Heatmap_Format == Heatmap_UInt8)
+        Ingest_Heatmap_In_Format((const uint8_t *)Heatmap, Edge_Heatmap_Byte, If_Select_Candidate, Order);
+    else
+        Ingest_Heatmap_In_Format((const double *)Heatmap, Edge_Heatmap, If_Select_Candidate, Order);
+}
+
+// Return the identifier of a heatmap format given its name, or Null
+int Get_Heatmap_Format_Id(const std::string &Heatmap_Format_Name)
+{
+    const char *Heatmap_Format_Names[] = {"float64", "float16", "uint8"};
+    for (int i = 0; i <= Heatmap_UInt8; i++)
+        if (Heatmap_Format_Name == Heatmap_Format_Names[i])
+            return i;
+
+    return Null;
+}
+
+// Bytes of an entry of an input heatmap of the given format
+size_t Get_Heatmap_Entry_Size(int Format)
+{
+    return Format == Heatmap_Float16 ? 2 : Format == Heatmap_UInt8 ? 1 : sizeof(double);
+}
+
+// Surrogate heatmap used when no heatmap is given: only the candidate edges
+// (nearest cities) are promising. Requires Candidate[][]
+void Set_Candidate_Edge_Heatmap()
+{
+    for (int i = 0; i < Virtual_City_Num; i++)
+        for (int j = 0; j < Virtual_City_Num; j++)
+            Set_Edge_Heatmap(i, j, 0);
+    for (int i = 0; i < Virtual_City_Num; i++)
+        for (int j = 0; j < Candidate_Num[i]; j++)
+        {
+            Set_Edge_Heatmap(i, Candidate[i][j], 1);
+            Set_Edge_Heatmap(Candidate[i][j], i, 1);
+        }
+}
+
+#endif // TSP_HEATMAP_INGESTION_H
@@ -0,0 +1,67 @@
+#ifndef TSP_HILBERT_H
+#define TSP_HILBERT_H
+
+#include <algorithm>
+
+#include "TSP_IO.h"
+
+#define Hilbert_Order 16 // the bounding box is quantized to a 2^16 x 2^16 grid
+
+// Return the position of the grid cell (X,Y) along the Hilbert curve filling a
+// 2^Order x 2^Order grid
+unsigned long long Get_Hilbert_Index(unsigned int X, unsigned int Y, int Order)
+{
+    unsigned int Side = 1u << Order;
+    unsigned long long Index = 0;
+    for (unsigned int S = Side / 2; S > 0; S /= 2)
+    {
+        unsigned int RX = (X & S) > 0;
+        unsigned int RY = (Y & S) > 0;
+        Index += (unsigned long long)S * S * ((3 * RX) ^ RY);
+
+        // Rotate the quadrant so that the curve keeps its orientation
+        if (RY == 0)
+        {
+            if (RX == 1)
+            {
+                X = Side - 1 - X;
+                Y = Side - 1 - Y;
+            }
+            unsigned int Temp = X;
+            X = Y;
+            Y = Temp;
+        }
+    }
+
+    return Index;
+}
+
+// Store in Order[] the N cities sorted along the Hilbert curve over the
+// bounding box of (X[],Y[]), in O(N log N)
+void Get_Hilbert_Order(int N, const double *X, const double *Y, int *Order)
+{
+    double Min_X = X[0], Max_X = X[0], Min_Y = Y[0], Max_Y = Y[0];
+    for (int i = 1; i < N; i++)
+    {
+        Min_X = min(Min_X, X[i]);
+        Max_X = max(Max_X, X[i]);
+        Min_Y = min(Min_Y, Y[i]);
+        Max_Y = max(Max_Y, Y[i]);
+    }
+
+    double Cell_Num = (double)((1u << Hilbert_Order) - 1);
+    double Scale = Cell_Num / max(max(Max_X - Min_X, Max_Y - Min_Y), 1e-12);
+    vector<pair<unsigned long long, int>> Keys(N);
+    for (int i = 0; i < N; i++)
+    {
+        unsigned int Cell_X = (unsigned int)((X[i] - Min_X) * Scale);
+        unsigned int Cell_Y = (unsigned int)((Y[i] - Min_Y) * Scale);
+        Keys[i] = make_pair(Get_Hilbert_Index(Cell_X, Cell_Y, Hilbert_Order), i);
+    }
+    sort(Keys.begin(), Keys.end());
+
+    for (int i = 0; i < N; i++)
+        Order[i] = Keys[i].second;
+}
+
+#endif // TSP_HILBERT_H
@@ -7,6 +7,8 @@
 #include <string.h>
 #include <time.h>
 
+#include <stdint.h>
+
 #include <chrono>
 #include <fstream>
 #include <iostream>
@@ -19,24 +21,75 @@ int Total_Instance_Num = 1;
 #define Null -1
 #define Inf_Cost 1000000000
 #define Magnify_Rate 100000
-#define Coord_Dim 2
+#define Coord_Dim 2 // dimension of the default (EUC_2D) coordinates
 // Hyper parameters
 thread_local double Alpha = 1;              // used in estimating the potential of each edge
 thread_local double Beta = 10;              // used in back propagation
 thread_local double Param_H = 10;           // used to control the number of sampling actions
 thread_local double Param_T = 0.10;         // used to control the termination condition
 thread_local int Max_Candidate_Num = 5;     // used to control the number of candidate neighbors of each city
-thread_local int Candidate_Use_Heatmap = 1; // used to control whether to use the heatmap information
+thread_local int Candidate_Use_Heatmap = 1; // used to control how the candidate neighbors are selected (see below)
 thread_local int Max_Depth = 10;            // used to control the depth of the search tree
 thread_local bool Log_Length_Time = false;  // used to control whether to log the length-time information
+thread_local bool Use_Warm_Start = false;   // used to start the MDP from the tour stored in Solution[] by the caller
+thread_local vector<int> Changed_City;      // used to restrict a warm started search to the region of these cities (empty: whole tour)
+thread_local int Restart_Policy = 0;        // used to control how a restart perturbs the search (see below)
+thread_local int Kick_Segment_Len = 50;     // used to control the size of the region perturbed by a kick
+thread_local int Init_Method = 0;           // used to control how the initial state of the MDP is constructed (see below)
+thread_local bool Focused_Sampling = false; // used to start the rollouts from prioritized cities with an adaptive budget
+thread_local int MCTS_Patience = 1;         // used to control how many fruitless simulations in a row end an MCTS
+thread_local double Stagnation_Threshold = 0; // used to stop restarting once the expected relative gain is below it (0 disables)
+thread_local int Export_Weight_Num = 0;     // used to return the learned weights of the heaviest edges of each city (0 disables)
+thread_local bool Compute_Lower_Bound = false; // used to compute a 1-tree lower bound on a background thread during the search
+thread_local double Target_Gap = 0;         // used to stop the search once the tour is certified within this gap of the lower bound (0 disables)
+thread_local int Renumber_Method = 0;       // used to renumber the cities internally for locality (see below)
+thread_local int Heatmap_Format = 0;        // used to read the dense heatmap as float64, float16 or scaled uint8 (see below)
+thread_local double Heatmap_Scale = 1.0 / 255; // used to dequantize uint8 heatmaps (value = entry * Heatmap_Scale)
+thread_local int Island_Num = 1;            // used to run that many concurrent searches of one instance sharing their best tour (see TSP_Island.h)
+thread_local int Elite_Pool_Size = 0;       // used to keep that many restart tours and restart from their crossovers (see TSP_Elite.h, < 2 disables)
 
 thread_local bool MCTS_Debug = false;
 
-#define Default_Random_Seed 489663920;
+#define Default_Random_Seed 489663920
 unsigned Random_Seed = Default_Random_Seed;
+thread_local unsigned long long Random_State = Default_Random_Seed; // state of the per-thread random number generator
 
 typedef int Distance_Type;
 
+// Restart policies of the MDP: rebuild the tour from scratch, or kick the best found tour
+#define Restart_Random 0
+#define Restart_Double_Bridge 1
+#define Restart_Segment_Random 2
+
+// Selection of the candidate neighbors (Candidate_Use_Heatmap): the nearest
+// cities, the highest heatmap values, the lowest alpha-nearness (see
+// TSP_Alpha_Nearness.h), or alpha-nearness mixed with the heatmap values
+#define Candidate_Nearest 0
+#define Candidate_Heatmap 1
+#define Candidate_Alpha_Nearness 2
+#define Candidate_Alpha_Heatmap 3
+
+// Internal renumbering of the cities (see TSP_Renumber.h): input order, along
+// a Hilbert curve, or along a nearest-neighbor tour
+#define Renumber_None 0
+#define Renumber_Hilbert 1
+#define Renumber_Greedy 2
+
+// Formats of the dense heatmap (Heatmap_Format). Float64 heatmaps are stored
+// as float32 in Edge_Heatmap[][], float16 and uint8 ones keep their format in
+// Edge_Heatmap_Half[][] and Edge_Heatmap_Byte[][], and are dequantized when
+// read (see Get_Edge_Heatmap())
+#define Heatmap_Float64 0
+#define Heatmap_Float16 1
+#define Heatmap_UInt8 2
+
+// Constructors of the initial state of the MDP (see TSP_Init.h)
+#define Init_Heatmap_Sampling 0
+#define Init_Greedy_Edge 1
+#define Init_Hilbert_Curve 2
+#define Init_Heatmap_Greedy 3
+#define Init_Random_Insertion 4
+
 /* 2020-02-11 */
 thread_local int Temp_City_Num;
 
@@ -48,6 +101,11 @@ thread_local int Salesman_Num; // This program was proposed for the multiple TSP
 thread_local int Virtual_City_Num;
 thread_local double *Coordinate_X;
 thread_local double *Coordinate_Y;
+thread_local double *Coordinate_Z; // only used by 3D metrics
+thread_local bool If_Has_Coordinates = true; // false if the distances are given as an explicit matrix
+thread_local bool If_Shared_Instance = false;  // coordinates and Distance[][] are owned by a Shared_Instance
+thread_local bool If_Shared_Candidate = false; // the rows of Candidate[][] are owned by a Shared_Instance
+thread_local bool If_Shared_Weight = false;    // Edge_Heatmap[][], Weight[][] and Chosen_Times[][] are owned by a Shared_Instance
 thread_local Distance_Type **Distance;
 thread_local int *Opt_Solution;
 
@@ -55,6 +113,7 @@ thread_local int *Opt_Solution;
 thread_local vector<std::pair<double, double>> Length_Time;
 
 thread_local std::chrono::steady_clock::time_point Current_Instance_Begin_Time;
+thread_local double Time_Budget; // seconds granted to the search of the current instance
 thread_local Distance_Type Current_Instance_Best_Distance;
 
 // Used to store a solution in double link
@@ -85,26 +144,54 @@ thread_local Distance_Type *Gain;
 thread_local Distance_Type *Real_Gain;
 
 // Used in MCTS
-thread_local float **Edge_Heatmap;
+thread_local float **Edge_Heatmap;          // Heatmap_Float64
+thread_local uint16_t **Edge_Heatmap_Half;   // Heatmap_Float16, IEEE half precision bits
+thread_local uint8_t **Edge_Heatmap_Byte;    // Heatmap_UInt8, scaled by Heatmap_Scale
 thread_local float **Weight;
 thread_local float Avg_Weight;
 thread_local int **Chosen_Times;
+thread_local bool If_Weight_Initialized = false; // Weight[][] and Chosen_Times[][] were set during the heatmap ingestion
 thread_local int *Promising_City;
 thread_local int *Probabilistic;
 thread_local int Promising_City_Num;
 thread_local int Total_Simulation_Times;
 
+// Used in the local search restricted to the perturbed region
+thread_local int *Active_City;   // FIFO queue (ring buffer) of cities to be re-examined
+thread_local bool *If_City_Active;
+thread_local int Active_City_Head;
+thread_local int Active_City_Num;
+
+// Used to choose the start cities of the rollouts (see TSP_Focus.h)
+thread_local int *Focus_City; // ring buffer of prioritized start cities, the front is taken first
+thread_local bool *If_City_Focused;
+thread_local int Focus_City_Head;
+thread_local int Focus_City_Num;
+
 Distance_Type Get_Solution_Total_Distance();
 void Convert_Solution_To_All_Node();
+void Identify_Alpha_Nearness_Candidate_Set();
 
+// Whether the candidate neighbors depend on the heatmap
+bool If_Candidate_From_Heatmap()
+{
+    return Candidate_Use_Heatmap == Candidate_Heatmap || Candidate_Use_Heatmap == Candidate_Alpha_Heatmap;
+}
+
+// The structures owned by a Shared_Instance (see TSP_Solver.h) are neither
+// allocated nor released here
 void Allocate_Memory(int City_Num)
 {
-    Coordinate_X = new double[City_Num];
-    Coordinate_Y = new double[City_Num];
+    if (!If_Shared_Instance)
+    {
+        Coordinate_X = new double[City_Num];
+        Coordinate_Y = new double[City_Num];
+        Coordinate_Z = new double[City_Num];
 
-    Distance = new Distance_Type *[City_Num];
-    for (int i = 0; i < City_Num; i++)
-        Distance[i] = new Distance_Type[City_Num];
+        Distance = new Distance_Type *[City_Num];
+        for (int i = 0; i < City_Num; i++)
+            Distance[i] = new Distance_Type[City_Num];
+    }
 
     Opt_Solution = new int[City_Num];
 
@@ -113,9 +200,12 @@ void Allocate_Memory(int City_Num)
     Solution = new int[City_Num];
 
     Candidate_Num = new int[City_Num];
-    Candidate = new int *[City_Num];
-    for (int i = 0; i < City_Num; i++)
-        Candidate[i] = new int[Max_Candidate_Num];
+    if (!If_Shared_Candidate)
+    {
+        Candidate = new int *[City_Num];
+        for (int i = 0; i < City_Num; i++)
+            Candidate[i] = new int[Max_Candidate_Num];
+    }
     If_City_Selected = new bool[City_Num];
 
     City_Sequence = new int[2 * City_Num];
@@ -123,27 +213,70 @@ void Allocate_Memory(int City_Num)
     Gain = new Distance_Type[2 * City_Num];
     Real_Gain = new Distance_Type[2 * City_Num];
 
-    Edge_Heatmap = new float *[City_Num];
-    for (int i = 0; i < City_Num; i++)
-        Edge_Heatmap[i] = new float[City_Num];
+    // Only the matrix of the heatmap format is allocated
+    Edge_Heatmap = NULL;
+    Edge_Heatmap_Half = NULL;
+    Edge_Heatmap_Byte = NULL;
+    if (!If_Shared_Weight)
+    {
+        if (Heatmap_Format == Heatmap_Float16)
+        {
+            Edge_Heatmap_Half = new uint16_t *[City_Num];
+            for (int i = 0; i < City_Num; i++)
+                Edge_Heatmap_Half[i] = new uint16_t[City_Num];
+        }
+        else if (Heatmap_Format == Heatmap_UInt8)
+        {
+            Edge_Heatmap_Byte = new uint8_t *[City_Num];
+            for (int i = 0; i < City_Num; i++)
+                Edge_Heatmap_Byte[i] = new uint8_t[City_Num];
+        }
+        else
+        {
+            Edge_Heatmap = new float *[City_Num];
+            for (int i = 0; i < City_Num; i++)
+                Edge_Heatmap[i] = new float[City_Num];
+        }
+
+        Weight = new float *[City_Num];
+        for (int i = 0; i < City_Num; i++)
+            Weight[i] = new float[City_Num];
+
+        Chosen_Times = new int *[City_Num];
+        for (int i = 0; i < City_Num; i++)
+            Chosen_Times[i] = new int[City_Num];
+    }
 
-    Weight = new float *[City_Num];
-    for (int i = 0; i < City_Num; i++)
-        Weight[i] = new float[City_Num];
+    Promising_City = new int[City_Num];
+    Probabilistic = new int[City_Num];
 
-    Chosen_Times = new int *[City_Num];
+    Active_City = new int[City_Num];
+    If_City_Active = new bool[City_Num];
     for (int i = 0; i < City_Num; i++)
-        Chosen_Times[i] = new int[City_Num];
+        If_City_Active[i] = false;
+    Active_City_Head = 0;
+    Active_City_Num = 0;
 
-    Promising_City = new int[City_Num];
-    Probabilistic = new int[City_Num];
+    Focus_City = new int[City_Num];
+    If_City_Focused = new bool[City_Num];
+    for (int i = 0; i < City_Num; i++)
+        If_City_Focused[i] = false;
+    Focus_City_Head = 0;
+    Focus_City_Num = 0;
 }
 
 void Release_Memory(int City_Num)
 {
-    for (int i = 0; i < City_Num; i++)
-        delete[] Distance[i];
-    delete[] Distance;
+    if (!If_Shared_Instance)
+    {
+        delete[] Coordinate_X;
+        delete[] Coordinate_Y;
+        delete[] Coordinate_Z;
+
+        for (int i = 0; i < City_Num; i++)
+            delete[] Distance[i];
+        delete[] Distance;
+    }
 
     delete[] Opt_Solution;
 
@@ -152,9 +285,12 @@ void Release_Memory(int City_Num)
     delete[] Solution;
 
     delete[] Candidate_Num;
-    for (int i = 0; i < City_Num; i++)
-        delete[] Candidate[i];
-    delete[] Candidate;
+    if (!If_Shared_Candidate)
+    {
+        for (int i = 0; i < City_Num; i++)
+            delete[] Candidate[i];
+        delete[] Candidate;
+    }
     delete[] If_City_Selected;
 
     delete[] City_Sequence;
@@ -162,20 +298,44 @@ void Release_Memory(int City_Num)
     delete[] Gain;
     delete[] Real_Gain;
 
-    for (int i = 0; i < City_Num; i++)
-        delete[] Edge_Heatmap[i];
-    delete[] Edge_Heatmap;
-
-    for (int i = 0; i < City_Num; i++)
-        delete[] Weight[i];
-    delete[] Weight;
-
-    for (int i = 0; i < City_Num; i++)
-        delete[] Chosen_Times[i];
-    delete[] Chosen_Times;
+    if (!If_Shared_Weight)
+    {
+        if (Edge_Heatmap != NULL)
+        {
+            for (int i = 0; i < City_Num; i++)
+                delete[] Edge_Heatmap[i];
+            delete[] Edge_Heatmap;
+        }
+        if (Edge_Heatmap_Half != NULL)
+        {
+            for (int i = 0; i < City_Num; i++)
+                delete[] Edge_Heatmap_Half[i];
+            delete[] Edge_Heatmap_Half;
+        }
+        if (Edge_Heatmap_Byte != NULL)
+        {
+            for (int i = 0; i < City_Num; i++)
+                delete[] Edge_Heatmap_Byte[i];
+            delete[] Edge_Heatmap_Byte;
+        }
+
+        for (int i = 0; i < City_Num; i++)
+            delete[] Weight[i];
+        delete[] Weight;
+
+        for (int i = 0; i < City_Num; i++)
+            delete[] Chosen_Times[i];
+        delete[] Chosen_Times;
+    }
 
     delete[] Promising_City;
     delete[] Probabilistic;
+
+    delete[] Active_City;
+    delete[] If_City_Active;
+
+    delete[] Focus_City;
+    delete[] If_City_Focused;
 }
 
 // Print the cities of a solution one by one
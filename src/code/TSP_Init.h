@@ -1,7 +1,12 @@
 #ifndef TSP_INIT_H
 #define TSP_INIT_H
 
+#include <algorithm>
+#include <string>
+
 #include "TSP_Basic_Functions.h"
+#include "TSP_Hilbert.h"
+#include "TSP_Spatial_Grid.h"
 
 // Estimate the potential of each edge by upper bound confidence function
 float Temp_Get_Potential(int First_City, int Second_City)
@@ -114,115 +119,289 @@ bool Generate_Initial_Solution()
     return true;
 }
 
-// Generates an initial solution using the random insertion method
-bool Generate_Initial_Solution_Random_Insert()
+// Convert the tour stored in Solution[] and check its feasibility, shared by
+// the constructors below
+bool Finish_Initial_Solution(const char *Constructor_Name)
 {
+    Convert_Solution_To_All_Node();
     if (MCTS_Debug)
-        cout << "Generate_Initial_Solution_Random_Insert() begin" << endl;
-    
-    // Reset solution and city selection markers
+        cout << Constructor_Name << "() end" << endl;
+
+    if (Check_Solution_Feasible() == false)
+    {
+        cout << "\nError! The constructed solution is unfeasible" << endl;
+        getchar();
+        return false;
+    }
+
+    return true;
+}
+
+// Used by the greedy constructors to keep the selected edges a set of paths
+thread_local vector<int> Fragment_Parent; // union-find forest over the cities
+thread_local vector<int> Fragment_Adjacent; // two neighbors of each city in the selected edges, Null if none
+
+int Get_Fragment_Root(int City)
+{
+    while (Fragment_Parent[City] != City)
+    {
+        Fragment_Parent[City] = Fragment_Parent[Fragment_Parent[City]];
+        City = Fragment_Parent[City];
+    }
+    return City;
+}
+
+// Return the neighbor of Cur_City in its fragment other than Pre_City, Null at
+// the end of the fragment
+int Get_Next_Fragment_City(int Cur_City, int Pre_City)
+{
+    int First_Adjacent = Fragment_Adjacent[2 * Cur_City];
+    return First_Adjacent != Pre_City ? First_Adjacent : Fragment_Adjacent[2 * Cur_City + 1];
+}
+
+// Build a tour from the candidate edges (Candidate[][]) in increasing order of
+// Edge_Score: an edge is selected if both its cities have degree < 2 and it
+// closes no cycle. The resulting paths are then joined end to end, each time
+// to the nearest free path end when coordinates are known. O(N log N) for a
+// bounded number of candidates per city, on average over roughly uniform
+// coordinates: the grid of the free ends shrinks as they are used (see
+// Spatial_Grid::Remove()), so each nearest end query visits O(1) cells
+template <typename Score_Function> bool Greedy_Edge_Matching(const char *Constructor_Name, Score_Function Edge_Score)
+{
+    if (MCTS_Debug)
+        cout << Constructor_Name << "() begin" << endl;
+
+    vector<std::pair<int, int>> Candidate_Edges;
+    for (int i = 0; i < Virtual_City_Num; i++)
+        for (int j = 0; j < Candidate_Num[i]; j++)
+            Candidate_Edges.push_back(std::make_pair(min(i, Candidate[i][j]), max(i, Candidate[i][j])));
+    sort(Candidate_Edges.begin(), Candidate_Edges.end());
+    Candidate_Edges.erase(unique(Candidate_Edges.begin(), Candidate_Edges.end()), Candidate_Edges.end());
+    stable_sort(Candidate_Edges.begin(), Candidate_Edges.end(),
+                [&](const std::pair<int, int> &A, const std::pair<int, int> &B) {
+                    return Edge_Score(A.first, A.second) < Edge_Score(B.first, B.second);
+                });
+
+    Fragment_Parent.resize(Virtual_City_Num);
+    Fragment_Adjacent.assign(2 * Virtual_City_Num, Null);
+    vector<int> Degree(Virtual_City_Num, 0);
     for (int i = 0; i < Virtual_City_Num; i++)
+        Fragment_Parent[i] = i;
+
+    for (auto &Edge : Candidate_Edges)
     {
-        Solution[i] = Null;
-        If_City_Selected[i] = false;
+        int First_City = Edge.first;
+        int Second_City = Edge.second;
+        if (Degree[First_City] >= 2 || Degree[Second_City] >= 2)
+            continue;
+        int First_Root = Get_Fragment_Root(First_City);
+        int Second_Root = Get_Fragment_Root(Second_City);
+        if (First_Root == Second_Root)
+            continue;
+
+        Fragment_Parent[First_Root] = Second_Root;
+        Fragment_Adjacent[2 * First_City + Degree[First_City]++] = Second_City;
+        Fragment_Adjacent[2 * Second_City + Degree[Second_City]++] = First_City;
     }
-    
-    // Start with Start_City
-    Solution[0] = Start_City;
-    If_City_Selected[Start_City] = true;
-    
-    // Find a second city (could be random, but using closest city for better results)
-    int second_city = Null;
-    Distance_Type min_dist = Inf_Cost;
+
+    // Pair the two ends of each fragment (a single city is both ends of its own)
+    vector<int> Other_End(Virtual_City_Num, Null);
+    vector<int> Free_Ends;
     for (int i = 0; i < Virtual_City_Num; i++)
     {
-        if (i != Start_City && Distance[Start_City][i] < min_dist)
+        if (Degree[i] >= 2 || Other_End[i] != Null)
+            continue;
+        int Pre_City = Null;
+        int Cur_City = i;
+        int Next_City;
+        while ((Next_City = Get_Next_Fragment_City(Cur_City, Pre_City)) != Null)
         {
-            min_dist = Distance[Start_City][i];
-            second_city = i;
+            Pre_City = Cur_City;
+            Cur_City = Next_City;
         }
+        Other_End[i] = Cur_City;
+        Other_End[Cur_City] = i;
+        Free_Ends.push_back(i);
+        if (Cur_City != i)
+            Free_Ends.push_back(Cur_City);
+    }
+
+    Spatial_Grid Grid;
+    if (If_Has_Coordinates)
+    {
+        Grid.Build(Virtual_City_Num, Coordinate_X, Coordinate_Y);
+        for (int End_City : Free_Ends)
+            Grid.Insert(End_City);
     }
-    
-    // Add second city to form initial subtour
-    Solution[1] = second_city;
-    If_City_Selected[second_city] = true;
-    int current_tour_size = 2;
-    
-    // Random insertion for each remaining city
-    for (int i = 2; i < Virtual_City_Num; i++)
+    vector<bool> If_End_Used(Virtual_City_Num, false);
+
+    // Walk the fragments one after the other, entering each by one of its ends
+    int Selected_City_Num = 0;
+    int Cur_End = Free_Ends[0];
+    int Next_Free_End_Index = 0;
+    while (Cur_End != Null)
     {
-        // Select a random unvisited city
-        Promising_City_Num = 0;
-        for (int j = 0; j < Virtual_City_Num; j++)
+        If_End_Used[Cur_End] = If_End_Used[Other_End[Cur_End]] = true;
+        if (If_Has_Coordinates)
         {
-            if (!If_City_Selected[j])
-                Promising_City[Promising_City_Num++] = j;
+            Grid.Remove(Cur_End);
+            Grid.Remove(Other_End[Cur_End]);
         }
-        
-        if (Promising_City_Num == 0)
-            break;  // No more cities to insert
-        
-        int random_index = Get_Random_Int(Promising_City_Num);
-        int next_city = Promising_City[random_index];
-        
-        // Find the best position to insert the new city
-        int best_pos = -1;
-        Distance_Type min_increase = Inf_Cost;
-        
-        for (int pos = 0; pos < current_tour_size; pos++)
-        {
-            int prev = Solution[pos];
-            int next;
-            if (pos == current_tour_size - 1)
-                next = Solution[0]; // Close the loop for the last position
-            else
-                next = Solution[pos + 1];
-            
-            // Calculate increase in tour length if we insert next_city between prev and next
-            Distance_Type increase = Distance[prev][next_city] + Distance[next_city][next] - Distance[prev][next];
-            
-            if (increase < min_increase)
-            {
-                min_increase = increase;
-                best_pos = pos;
-            }
-        }
-        
-        // Insert the city at the best position
-        if (best_pos == current_tour_size - 1)
+
+        int Pre_City = Null;
+        int Cur_City = Cur_End;
+        while (Cur_City != Null)
         {
-            // Insert at the end
-            Solution[current_tour_size] = next_city;
+            Solution[Selected_City_Num++] = Cur_City;
+            int Next_City = Get_Next_Fragment_City(Cur_City, Pre_City);
+            Pre_City = Cur_City;
+            Cur_City = Next_City;
         }
+
+        if (If_Has_Coordinates)
+            Cur_End = Grid.Get_Nearest(Pre_City);
         else
         {
-            // Shift cities to make room
-            for (int j = current_tour_size; j > best_pos + 1; j--)
-            {
-                Solution[j] = Solution[j - 1];
-            }
-            Solution[best_pos + 1] = next_city;
+            while (Next_Free_End_Index < (int)Free_Ends.size() && If_End_Used[Free_Ends[Next_Free_End_Index]])
+                Next_Free_End_Index++;
+            Cur_End = Next_Free_End_Index < (int)Free_Ends.size() ? Free_Ends[Next_Free_End_Index] : Null;
         }
-        
-        If_City_Selected[next_city] = true;
-        current_tour_size++;
     }
-    
-    // Convert the solution to the linked structure
-    Convert_Solution_To_All_Node();
-    
+
+    return Finish_Initial_Solution(Constructor_Name);
+}
+
+// Greedy edge matching over the candidate edges, shortest edges first
+bool Generate_Initial_Solution_Greedy_Edge()
+{
+    return Greedy_Edge_Matching("Generate_Initial_Solution_Greedy_Edge",
+                                [](int First_City, int Second_City) { return (double)Get_Distance(First_City, Second_City); });
+}
+
+// Greedy decoding of the heatmap over the candidate edges, most promising
+// edges first
+bool Generate_Initial_Solution_Heatmap_Greedy()
+{
+    return Greedy_Edge_Matching("Generate_Initial_Solution_Heatmap_Greedy", [](int First_City, int Second_City) {
+        return -(double)Get_Edge_Heatmap(First_City, Second_City);
+    });
+}
+
+// Visit the cities in the order of the Hilbert curve over their coordinates,
+// in O(N log N). Falls back to the heatmap sampler without coordinates
+bool Generate_Initial_Solution_Hilbert()
+{
+    if (!If_Has_Coordinates)
+        return Generate_Initial_Solution();
     if (MCTS_Debug)
-        cout << "Generate_Initial_Solution_Random_Insert() end" << endl;
-    
-    // Verify solution
-    if (Check_Solution_Feasible() == false)
+        cout << "Generate_Initial_Solution_Hilbert() begin" << endl;
+
+    Get_Hilbert_Order(Virtual_City_Num, Coordinate_X, Coordinate_Y, Solution);
+    return Finish_Initial_Solution("Generate_Initial_Solution_Hilbert");
+}
+
+// Random insertion: the cities are inserted in random order into a linked
+// tour (All_Node[]), each at the cheapest position next to its nearest
+// inserted city (found with a spatial grid) or to its inserted candidates.
+// O(N log N) on average instead of scanning the whole tour
+bool Generate_Initial_Solution_Random_Insert()
+{
+    if (MCTS_Debug)
+        cout << "Generate_Initial_Solution_Random_Insert() begin" << endl;
+
+    for (int i = 0; i < Virtual_City_Num; i++)
     {
-        cout << "\nError! The constructed solution is unfeasible" << endl;
-        getchar();
-        return false;
+        Solution[i] = i;
+        If_City_Selected[i] = false;
     }
-    
-    return true;
+    for (int i = Virtual_City_Num - 1; i > 0; i--)
+    {
+        int j = Get_Random_Int(i + 1);
+        int Temp_City = Solution[i];
+        Solution[i] = Solution[j];
+        Solution[j] = Temp_City;
+    }
+
+    Spatial_Grid Grid;
+    if (If_Has_Coordinates)
+        Grid.Build(Virtual_City_Num, Coordinate_X, Coordinate_Y);
+
+    // Start from a single city linked to itself
+    int First_City = Solution[0];
+    All_Node[First_City].Pre_City = All_Node[First_City].Next_City = First_City;
+    If_City_Selected[First_City] = true;
+    if (If_Has_Coordinates)
+        Grid.Insert(First_City);
+
+    for (int i = 1; i < Virtual_City_Num; i++)
+    {
+        int Cur_City = Solution[i];
+
+        // Try the positions around the nearest inserted city and around each
+        // inserted candidate
+        int Best_Pre_City = Solution[i - 1];
+        Distance_Type Best_Increase = Inf_Cost;
+        for (int j = -1; j < Candidate_Num[Cur_City]; j++)
+        {
+            int Neighbor_City;
+            if (j < 0)
+                Neighbor_City = If_Has_Coordinates ? Grid.Get_Nearest(Cur_City) : Solution[i - 1];
+            else
+                Neighbor_City = Candidate[Cur_City][j];
+            if (Neighbor_City == Null || !If_City_Selected[Neighbor_City])
+                continue;
+
+            int Pre_Cities[2] = {All_Node[Neighbor_City].Pre_City, Neighbor_City};
+            for (int Pre_City : Pre_Cities)
+            {
+                int Next_City = All_Node[Pre_City].Next_City;
+                Distance_Type Increase = Get_Distance(Pre_City, Cur_City) + Get_Distance(Cur_City, Next_City) -
+                                         Get_Distance(Pre_City, Next_City);
+                if (Increase < Best_Increase)
+                {
+                    Best_Increase = Increase;
+                    Best_Pre_City = Pre_City;
+                }
+            }
+        }
+
+        int Best_Next_City = All_Node[Best_Pre_City].Next_City;
+        All_Node[Best_Pre_City].Next_City = Cur_City;
+        All_Node[Cur_City].Pre_City = Best_Pre_City;
+        All_Node[Cur_City].Next_City = Best_Next_City;
+        All_Node[Best_Next_City].Pre_City = Cur_City;
+        If_City_Selected[Cur_City] = true;
+        if (If_Has_Coordinates)
+            Grid.Insert(Cur_City);
+    }
+
+    Convert_All_Node_To_Solution();
+    return Finish_Initial_Solution("Generate_Initial_Solution_Random_Insert");
+}
+
+// Constructors of the initial state of the MDP, indexed by Init_Method. The
+// restarts keep sampling from the heatmap, since the other constructors are
+// (nearly) deterministic
+bool (*Initial_Solution_Constructors[])() = {Generate_Initial_Solution, Generate_Initial_Solution_Greedy_Edge,
+                                             Generate_Initial_Solution_Hilbert,
+                                             Generate_Initial_Solution_Heatmap_Greedy,
+                                             Generate_Initial_Solution_Random_Insert};
+
+bool Construct_Initial_Solution()
+{
+    return Initial_Solution_Constructors[Init_Method]();
+}
+
+// Return the identifier of an initial tour constructor given its name, or Null
+int Get_Init_Method_Id(const std::string &Init_Method_Name)
+{
+    const char *Init_Method_Names[] = {"heatmap_sampling", "greedy_edge", "hilbert", "heatmap_greedy",
+                                       "random_insertion"};
+    for (int i = 0; i <= Init_Random_Insertion; i++)
+        if (Init_Method_Name == Init_Method_Names[i])
+            return i;
+
+    return Null;
 }
 
 #endif // TSP_INIT_H
@@ -0,0 +1,159 @@
+#ifndef TSP_ISLAND_H
+#define TSP_ISLAND_H
+
+#include <atomic>
+#include <mutex>
+
+#include "TSP_Basic_Functions.h"
+#include "TSP_Checkpoint.h"
+
+// Island model: several searches of one instance run the restart loop
+// concurrently, each with its own tour, Weight[][] and random generator (see
+// Solve_Islands() in TSP_Ensemble.h). They cooperate through a board: at the
+// end of each restart an island publishes its best tour if it is the
+// shortest so far, adopts the board's tour if it is shorter than its own, and
+// every Island_Merge_Ratio of its time budget averages the weights of its
+// candidate edges with the board's, which spreads what each island learned
+
+#define Island_Merge_Ratio 0.05 // part of the time budget between two weight merges of an island
+
+struct Island_Board
+{
+    // Length of the shortest published tour. It is only lowered, by
+    // compare-and-swap, so an island that does not improve it takes no lock
+    std::atomic<Distance_Type> Best_Distance{Inf_Cost};
+
+    std::mutex Tour_Mutex;
+    vector<int> Best_Tour; // shortest stored tour, in Solution[] order
+    Distance_Type Best_Tour_Distance = Inf_Cost;
+
+    // Weights of the candidate edges, averaged over the merges: slot i * K + k
+    // holds the edge (i, Merged_City[i * K + k]), K = Max_Candidate_Num
+    std::mutex Weight_Mutex;
+    vector<int> Merged_City;
+    vector<float> Merged_Weight;
+
+    const std::atomic<long long> *Lower_Bound = NULL; // bound shared by the islands, NULL if none
+};
+
+thread_local Island_Board *Shared_Island_Board = NULL; // NULL unless the search is an island
+thread_local int Island_Index = 0;
+thread_local double Next_Island_Merge_Time;
+
+// Length of the shortest tour published by the islands, Inf_Cost if the
+// search is not an island
+Distance_Type Get_Island_Best_Distance()
+{
+    if (Shared_Island_Board == NULL)
+        return Inf_Cost;
+    return Shared_Island_Board->Best_Distance.load(std::memory_order_relaxed);
+}
+
+// Publish the best tour of the calling island if no island found a shorter one
+void Publish_Island_Best()
+{
+    Island_Board &Board = *Shared_Island_Board;
+    Distance_Type Board_Distance = Board.Best_Distance.load(std::memory_order_relaxed);
+    do
+    {
+        if (Current_Instance_Best_Distance >= Board_Distance)
+            return;
+    } while (!Board.Best_Distance.compare_exchange_weak(Board_Distance, Current_Instance_Best_Distance));
+
+    vector<int> Tour;
+    Tour.reserve(Virtual_City_Num);
+    int Cur_City = Start_City;
+    do
+    {
+        Tour.push_back(Cur_City);
+        Cur_City = Best_All_Node[Cur_City].Next_City;
+    } while (Cur_City != Null && Cur_City != Start_City);
+
+    // An island that lowered the length after this one may have stored its
+    // tour first
+    std::lock_guard<std::mutex> Lock(Board.Tour_Mutex);
+    if (Current_Instance_Best_Distance < Board.Best_Tour_Distance)
+    {
+        Board.Best_Tour = std::move(Tour);
+        Board.Best_Tour_Distance = Current_Instance_Best_Distance;
+    }
+}
+
+// Make the shortest stored tour the best tour of the calling island if it is
+// shorter than its own. All_Node[] is overwritten, as by a restart
+void Adopt_Island_Best()
+{
+    if (Get_Island_Best_Distance() >= Current_Instance_Best_Distance)
+        return;
+
+    Island_Board &Board = *Shared_Island_Board;
+    {
+        std::lock_guard<std::mutex> Lock(Board.Tour_Mutex);
+        if (Board.Best_Tour_Distance >= Current_Instance_Best_Distance)
+            return; // the shorter tour is not stored yet
+        for (int i = 0; i < Virtual_City_Num; i++)
+            Solution[i] = Board.Best_Tour[i];
+        Current_Instance_Best_Distance = Board.Best_Tour_Distance;
+    }
+    Convert_Solution_To_All_Node();
+    Store_Best_Solution();
+    if (Log_Length_Time)
+        Length_Time.push_back(
+            std::make_pair(Current_Instance_Best_Distance, Get_Elapsed_Time(Current_Instance_Begin_Time)));
+}
+
+// Average the weights of the candidate edges of the calling island with the
+// board's, and take the averages as the island's weights
+void Merge_Island_Weight()
+{
+    Island_Board &Board = *Shared_Island_Board;
+    int K = Max_Candidate_Num;
+    std::lock_guard<std::mutex> Lock(Board.Weight_Mutex);
+    if (Board.Merged_City.empty())
+    {
+        Board.Merged_City.assign((size_t)Virtual_City_Num * K, Null);
+        Board.Merged_Weight.assign((size_t)Virtual_City_Num * K, 0);
+    }
+
+    for (int i = 0; i < Virtual_City_Num; i++)
+        for (int k = 0; k < Candidate_Num[i]; k++)
+        {
+            int City = Candidate[i][k];
+            size_t Slot = (size_t)i * K + k;
+            if (Board.Merged_City[Slot] != City)
+            {
+                Board.Merged_City[Slot] = City;
+                Board.Merged_Weight[Slot] = Weight[i][City];
+                continue;
+            }
+
+            float Merged_Weight = (Board.Merged_Weight[Slot] + Weight[i][City]) / 2;
+            Board.Merged_Weight[Slot] = Merged_Weight;
+            Weight[i][City] = Weight[City][i] = Merged_Weight;
+            Log_Edge_Change(i, City);
+            Log_Edge_Change(City, i);
+        }
+}
+
+void Init_Island()
+{
+    Next_Island_Merge_Time = Island_Merge_Ratio * Param_T * Virtual_City_Num;
+}
+
+// Exchange with the other islands at the end of a restart
+void Synchronize_Island()
+{
+    if (Shared_Island_Board == NULL)
+        return;
+
+    Publish_Island_Best();
+    Adopt_Island_Best();
+    double Elapsed_Time = Get_Elapsed_Time(Current_Instance_Begin_Time);
+    if (Elapsed_Time >= Next_Island_Merge_Time)
+    {
+        Merge_Island_Weight();
+        Next_Island_Merge_Time = Elapsed_Time + Island_Merge_Ratio * Param_T * Virtual_City_Num;
+    }
+}
+
+#endif // TSP_ISLAND_H
@@ -0,0 +1,140 @@
+#ifndef TSP_LOWER_BOUND_H
+#define TSP_LOWER_BOUND_H
+
+#include <thread>
+
+#include "TSP_Alpha_Nearness.h"
+#include "TSP_Termination.h"
+
+// Held-Karp lower bound of the current instance, computed on a background
+// thread while the search runs: the penalties are raised by the ascent of
+// TSP_Alpha_Nearness.h, then the bound W(Pi) is taken from a minimum 1-tree of
+// the complete graph. On large instances the ascent only sees a sparse graph,
+// whose 1-trees are no lower bound, hence the final dense 1-tree. The thread
+// only reads Distance[][], which no search writes
+
+// Cost minus twice the penalties of a minimum 1-tree of the complete graph
+// under Pi[], in O(N^2) time. The special city is a leaf of the minimum
+// spanning tree, linked to its second nearest city. Return LLONG_MIN if
+// If_Cancelled is set before the tree is complete
+long long Get_Complete_One_Tree_Bound(const vector<int> &Pi, const std::atomic<bool> *If_Cancelled = NULL)
+{
+    int N = Virtual_City_Num;
+    if (N < 3)
+        return 0;
+
+    vector<long long> Link_Cost(N, LLONG_MAX);
+    vector<int> Dad(N, Null);
+    vector<int> Degree(N, 0);
+    vector<char> If_In_Tree(N, false);
+    long long Cost = 0;
+    Link_Cost[0] = 0;
+    for (int Step = 0; Step < N; Step++)
+    {
+        if (If_Build_Cancelled(If_Cancelled))
+            return LLONG_MIN;
+        int Cur_City = Null;
+        for (int i = 0; i < N; i++)
+            if (!If_In_Tree[i] && (Cur_City == Null || Link_Cost[i] < Link_Cost[Cur_City]))
+                Cur_City = i;
+        If_In_Tree[Cur_City] = true;
+        if (Dad[Cur_City] != Null)
+        {
+            Cost += Link_Cost[Cur_City];
+            Degree[Cur_City]++;
+            Degree[Dad[Cur_City]]++;
+        }
+
+        for (int i = 0; i < N; i++)
+        {
+            if (If_In_Tree[i])
+                continue;
+            long long Cur_Cost = Get_Penalized_Distance(Cur_City, i, Pi);
+            if (Cur_Cost < Link_Cost[i])
+            {
+                Link_Cost[i] = Cur_Cost;
+                Dad[i] = Cur_City;
+            }
+        }
+    }
+
+    long long Special_Cost = LLONG_MIN;
+    for (int i = 0; i < N; i++)
+    {
+        if (If_Build_Cancelled(If_Cancelled))
+            return LLONG_MIN;
+        if (Degree[i] != 1)
+            continue;
+        long long Best_Cost = LLONG_MAX;
+        for (int j = 0; j < N; j++)
+            if (j != i && j != Dad[i] && Dad[j] != i)
+                Best_Cost = min(Best_Cost, Get_Penalized_Distance(i, j, Pi));
+        Special_Cost = max(Special_Cost, Best_Cost);
+    }
+    Cost += Special_Cost;
+
+    for (int i = 0; i < N; i++)
+        Cost -= 2LL * Pi[i];
+    return Cost;
+}
+
+// The bound thread of one solve. Start() captures the instance of the calling
+// thread, Finish() stops the ascent where it stands and returns the bound. On
+// large instances the O(N^2) graph construction and final 1-tree are stopped
+// too, and no bound is then returned
+struct Lower_Bound_Task
+{
+    std::atomic<long long> Bound{Null}; // Null until the bound is known
+    std::atomic<bool> If_Cancelled{false};
+    std::thread Worker;
+
+    Lower_Bound_Task() = default;
+    Lower_Bound_Task(const Lower_Bound_Task &) = delete;
+    Lower_Bound_Task &operator=(const Lower_Bound_Task &) = delete;
+
+    ~Lower_Bound_Task()
+    {
+        Finish();
+    }
+
+    void Start()
+    {
+        int N = Virtual_City_Num;
+        Distance_Type **Instance_Distance = Distance;
+        Worker = std::thread([this, N, Instance_Distance]() {
+            Virtual_City_Num = N;
+            Distance = Instance_Distance;
+
+            Ascent_Graph Graph;
+            if (!Build_Ascent_Graph(Graph, &If_Cancelled))
+                return;
+            vector<int> Pi;
+            One_Tree Tree;
+            long long Cur_Bound = Optimize_Penalties(Graph, Pi, Tree, &If_Cancelled);
+            if (Cur_Bound == LLONG_MIN)
+                return; // some cities cannot be reached
+            if (N > Dense_Graph_Max_City_Num)
+            {
+                // The 1-trees of the sparse graph are no bound, and the dense
+                // pass is not started once the search is over
+                if (If_Cancelled.load())
+                    return;
+                Cur_Bound = Get_Complete_One_Tree_Bound(Pi, &If_Cancelled);
+                if (Cur_Bound == LLONG_MIN)
+                    return;
+            }
+            Bound.store(max(Cur_Bound, 0LL));
+        });
+    }
+
+    // Return the bound, or Null if it could not be computed
+    long long Finish()
+    {
+        If_Cancelled.store(true);
+        if (Worker.joinable())
+            Worker.join();
+        return Bound.load();
+    }
+};
+
+#endif // TSP_LOWER_BOUND_H
@@ -4,17 +4,24 @@
 #include "TSP_Basic_Functions.h"
 #include "TSP_Init.h"
 #include "TSP_2Opt.h"
+#include "TSP_Checkpoint.h"
+#include "TSP_Edge_Weight.h"
+#include "TSP_Focus.h"
+#include "TSP_Trace.h"
 
 // Initialize the parameters used in MCTS
 void MCTS_Init()
 {
-    for (int i = 0; i < Virtual_City_Num; i++)
-        for (int j = 0; j < Virtual_City_Num; j++)
-        {
-            // Weight[i][j]=1;
-            Weight[i][j] = Edge_Heatmap[i][j] * 100;
-            Chosen_Times[i][j] = 0;
-        }
+    if (!If_Weight_Initialized)
+        for (int i = 0; i < Virtual_City_Num; i++)
+            for (int j = 0; j < Virtual_City_Num; j++)
+            {
+                // Weight[i][j]=1;
+                Weight[i][j] = Get_Edge_Heatmap(i, j) * 100;
+                Chosen_Times[i][j] = 0;
+            }
+    If_Weight_Initialized = false;
+    Apply_Prior_Edge_Weight();
 
     /*
     for(int i=0;i<Virtual_City_Num;i++)
@@ -23,6 +30,7 @@ void MCTS_Init()
     */
 
     Total_Simulation_Times = 0;
+    Init_Focused_Sampling();
 }
 
 // Get the average weight of all the edge relative to Cur_City
@@ -152,6 +160,8 @@ Distance_Type Get_Simulated_Action_Delta(int Begin_City)
         // Update the chosen times, used in MCTS
         Chosen_Times[Cur_City][Next_City_To_Connect]++;
         Chosen_Times[Next_City_To_Connect][Cur_City]++;
+        Log_Edge_Change(Cur_City, Next_City_To_Connect);
+        Log_Edge_Change(Next_City_To_Connect, Cur_City);
 
         int Next_City_To_Disconnect = All_Node[Next_City_To_Connect].Pre_City; // Determine b_{i+1}
 
@@ -223,6 +233,8 @@ void Back_Propagation(Distance_Type Before_Simulation_Distance, Distance_Type Ac
             float Increase_Rate = Beta * (pow(2.718, (float)(Action_Delta) / (float)(Before_Simulation_Distance)) - 1);
             Weight[Second_City][Third_City] += Increase_Rate;
             Weight[Third_City][Second_City] += Increase_Rate;
+            Log_Edge_Change(Second_City, Third_City);
+            Log_Edge_Change(Third_City, Second_City);
         }
     }
 }
@@ -231,9 +243,11 @@ void Back_Propagation(Distance_Type Before_Simulation_Distance, Distance_Type Ac
 Distance_Type Simulation(int Max_Simulation_Times)
 {
     Distance_Type Best_Action_Delta = -Inf_Cost;
-    for (int i = 0; i < Max_Simulation_Times; i++)
+    int Simulation_Times = 0;
+    while (Simulation_Times < Max_Simulation_Times)
     {
-        int Begin_City = Get_Random_Int(Virtual_City_Num);
+        int Begin_City = Get_Begin_City();
+        Simulation_Times++;
         Distance_Type Action_Delta = Get_Simulated_Action_Delta(Begin_City);
         Total_Simulation_Times++;
 
@@ -251,6 +265,7 @@ Distance_Type Simulation(int Max_Simulation_Times)
         if (Best_Action_Delta > 0)
             break;
     }
+    Record_Simulation(Simulation_Times, Best_Action_Delta > 0);
 
     // Restore the action with the best delta
     Pair_City_Num = Temp_Pair_Num;
@@ -309,15 +324,22 @@ bool Execute_Best_Action()
 // Process of the MCTS
 void MCTS()
 {
+    Trace_Begin(Trace_Phase_MCTS);
+    double Fruitless_Share = 0; // of MCTS_Patience, see Get_Fruitless_Share()
+    if (Focused_Sampling)
+        Prioritize_Start_Cities();
     // while(true)
-    while (Get_Elapsed_Time(Current_Instance_Begin_Time) < Param_T * Virtual_City_Num)
+    while (Get_Elapsed_Time(Current_Instance_Begin_Time) < Time_Budget && !If_Stop_Requested())
     {
+        Checkpoint_If_Due();
+        Trace_Begin(Trace_Phase_Simulation);
         Distance_Type Before_Simulation_Distance = Get_Solution_Total_Distance();
 
         if (MCTS_Debug)
             cout << "Simulation()" << endl;
         // Simulate a number of (controled by Param_H) actions
-        Distance_Type Best_Delta = Simulation(Param_H * Virtual_City_Num);
+        int Simulation_Budget = Get_Simulation_Budget(Fruitless_Share);
+        Distance_Type Best_Delta = Simulation(Simulation_Budget);
 
         // Use the information of the best action to update the parameters
         // of MCTS by back propagation
@@ -327,10 +349,14 @@ void MCTS()
 
         if (Best_Delta > 0)
         {
+            Fruitless_Share = 0;
+
             // Select the best action to execute
             if (MCTS_Debug)
                 cout << "Execute_Best_Action()" << endl;
             Execute_Best_Action();
+            if (Focused_Sampling)
+                Focus_On_Changed_Cities();
 
             // Store the best found solution to Struct_Node
             // *Best_All_Node
@@ -348,10 +374,15 @@ void MCTS()
                 }
             }
         }
-        else
+        else if ((Fruitless_Share += Get_Fruitless_Share(Simulation_Budget)) >= MCTS_Patience)
+        {
+            Trace_End(Trace_Phase_Simulation);
             break; // The MCTS terminates if no improving action is found
-                   // among the sampling pool
+                   // among the sampling pool of MCTS_Patience simulations in a row
+        }
+        Trace_End(Trace_Phase_Simulation);
     }
+    Trace_End(Trace_Phase_MCTS);
 }
 
 #endif // TSP_MCTS_H
@@ -1,30 +1,146 @@
 #ifndef TSP_MARKOV_DECISION_H
 #define TSP_MARKOV_DECISION_H
 
+#include "TSP_Elite.h"
 #include "TSP_MCTS.h"
+#include "TSP_Termination.h"
+#include "TSP_Trace.h"
 
-// Jump to a new state by randomly generating a solution
-void Jump_To_Random_State()
+// Double-bridge kick: inside a window of Window_Len consecutive cities of
+// Solution[] starting at Begin_Index, swap two adjacent segments
+void Double_Bridge_Kick(int Begin_Index, int Window_Len)
 {
-    Generate_Initial_Solution();
+    // Window = T[0,P1) T[P1,P2) T[P2,P3) T[P3,Window_Len), with 1 <= P1 < P2 < P3 < Window_Len
+    int P1 = 1 + Get_Random_Int(Window_Len - 3);
+    int P2 = P1 + 1 + Get_Random_Int(Window_Len - P1 - 2);
+    int P3 = P2 + 1 + Get_Random_Int(Window_Len - P2 - 1);
+
+    for (int i = 0; i < Window_Len; i++)
+        Temp_City_Sequence[i] = Solution[(Begin_Index + i) % Virtual_City_Num];
+
+    int Cur_Index = P1;
+    for (int i = P2; i < P3; i++)
+        Solution[(Begin_Index + Cur_Index++) % Virtual_City_Num] = Temp_City_Sequence[i];
+    for (int i = P1; i < P2; i++)
+        Solution[(Begin_Index + Cur_Index++) % Virtual_City_Num] = Temp_City_Sequence[i];
+
+    // Only the endpoints of the three replaced edges need to be re-optimized
+    int Changed_Index[6] = {P1 - 1, P1, P2 - 1, P2, P3 - 1, P3};
+    for (int i = 0; i < 6; i++)
+        Activate_City(Temp_City_Sequence[Changed_Index[i]]);
+}
+
+// Segment-random kick: randomly shuffle the interior of a window of
+// Window_Len consecutive cities of Solution[] starting at Begin_Index
+void Segment_Random_Kick(int Begin_Index, int Window_Len)
+{
+    for (int i = Window_Len - 2; i > 1; i--)
+    {
+        int First_Index = (Begin_Index + i) % Virtual_City_Num;
+        int Second_Index = (Begin_Index + 1 + Get_Random_Int(i)) % Virtual_City_Num;
+        int Temp_City = Solution[First_Index];
+        Solution[First_Index] = Solution[Second_Index];
+        Solution[Second_Index] = Temp_City;
+    }
+
+    for (int i = 0; i < Window_Len; i++)
+        Activate_City(Solution[(Begin_Index + i) % Virtual_City_Num]);
+}
+
+// Jump to a new state, either by recombining two elite tours, by randomly
+// generating a solution or by kicking the best found solution. Return true if
+// only a region was changed, the changed cities are then stored in
+// Active_City[]
+bool Jump_To_Random_State()
+{
+    if (Elite_Pool_Size >= 2 && Virtual_City_Num >= 8 && Recombine_Elite_Tours())
+    {
+        Convert_Solution_To_All_Node();
+        return true;
+    }
+
+    int Window_Len = min(Kick_Segment_Len, Virtual_City_Num);
+    if (Restart_Policy == Restart_Random || Window_Len < 8 || Current_Instance_Best_Distance >= Inf_Cost)
+    {
+        Generate_Initial_Solution();
+        return false;
+    }
+
+    Restore_Best_Solution();
+    Convert_All_Node_To_Solution();
+
+    int Begin_Index = Get_Random_Int(Virtual_City_Num);
+    if (!Changed_City.empty())
+    {
+        // Kick the region around one of the changed cities
+        int City = Changed_City[Get_Random_Int(Changed_City.size())];
+        int City_Index = std::find(Solution, Solution + Virtual_City_Num, City) - Solution;
+        Begin_Index = (City_Index - Window_Len / 2 + Virtual_City_Num) % Virtual_City_Num;
+    }
+    if (Restart_Policy == Restart_Double_Bridge)
+        Double_Bridge_Kick(Begin_Index, Window_Len);
+    else
+        Segment_Random_Kick(Begin_Index, Window_Len);
+
+    Convert_Solution_To_All_Node();
+    return true;
 }
 
 Distance_Type Markov_Decision_Process()
 {
-    MCTS_Init();                 // Initialize MCTS parameters
-    Generate_Initial_Solution(); // State initialization of MDP
-    Local_Search_by_2Opt_Move(); // 2-opt based local search within small
-                                 // neighborhood
+    MCTS_Init(); // Initialize MCTS parameters
+    Init_Termination_Controller();
+    Init_Island();
+    Init_Elite_Pool();
+    if (!Resume_From_Checkpoint()) // Continue from the snapshot of an interrupted search, if any
+    {
+        Trace_Begin(Trace_Phase_Initial_Solution);
+        if (Use_Warm_Start)
+            Convert_Solution_To_All_Node(); // Start from the tour given by the caller
+        else
+            Construct_Initial_Solution(); // State initialization of MDP
+        Trace_End(Trace_Phase_Initial_Solution);
+        Trace_Begin(Trace_Phase_Local_Search);
+        if (Use_Warm_Start && !Changed_City.empty())
+        {
+            // Only the region of the changed cities is worth re-optimizing,
+            // and the first rollouts start there
+            for (int City : Changed_City)
+                Activate_City(City);
+            Local_Search_by_2Opt_Move_Around_Active_Cities();
+            Focus_On_Cities(Changed_City);
+        }
+        else
+            Local_Search_by_2Opt_Move(); // 2-opt based local search within small
+                                         // neighborhood
+        Trace_End(Trace_Phase_Local_Search);
+    }
+    Begin_Checkpointing();
     MCTS(); // Targeted sampling via MCTS within enlarged neighborhood
+    Add_Elite_Tour();
+    Synchronize_Island();
+    Record_Restart();
 
     // Repeat the following process until termination
-    while (Get_Elapsed_Time(Current_Instance_Begin_Time) < Param_T * Virtual_City_Num)
+    while (If_Continue_Search())
     {
-        Jump_To_Random_State();
-        Local_Search_by_2Opt_Move();
+        Checkpoint_If_Due();
+        Trace_Begin(Trace_Phase_Restart);
+        bool If_Kicked = Jump_To_Random_State();
+        Trace_End(Trace_Phase_Restart);
+        Trace_Begin(Trace_Phase_Local_Search);
+        if (If_Kicked)
+            Local_Search_by_2Opt_Move_Around_Active_Cities();
+        else
+            Local_Search_by_2Opt_Move();
+        Trace_End(Trace_Phase_Local_Search);
         MCTS();
+        Add_Elite_Tour();
+        Synchronize_Island();
+        Record_Restart();
         // Max_Depth = 10 + (rand() % 80);
     }
+    End_Checkpointing();
 
     // Copy information of the best found solution (stored in Struct_Node
     // *Best_All_Node ) to Struct_Node *All_Node
@@ -0,0 +1,165 @@
+#ifndef TSP_METRIC_H
+#define TSP_METRIC_H
+
+#include "TSP_IO.h"
+
+// Metric policies, resolved at compile time so that the distance computation
+// stays branch-free. Each policy provides:
+//   Input_Type        element type of the input array (coordinates or matrix)
+//   Dim               number of coordinates per city (0 for an explicit matrix)
+//   Scale             factor applied to the input coordinates, reported lengths are divided by it
+//   Prepare()         one-off transformation of the loaded coordinates
+//   Int_Distance()    integer distance stored in Distance[][] and used by the search
+//   Double_Distance() distance used to report the length of a tour
+
+// Euclidean distance between normalized 2D coordinates, magnified and rounded
+// to the nearest integer
+struct Metric_EUC_2D
+{
+    typedef double Input_Type;
+    static const int Dim = 2;
+    static constexpr double Scale = Magnify_Rate;
+
+    static void Prepare() {}
+
+    static double Double_Distance(int First_City, int Second_City)
+    {
+        double Delta_X = Coordinate_X[First_City] - Coordinate_X[Second_City];
+        double Delta_Y = Coordinate_Y[First_City] - Coordinate_Y[Second_City];
+        return sqrt(Delta_X * Delta_X + Delta_Y * Delta_Y);
+    }
+
+    static Distance_Type Int_Distance(int First_City, int Second_City)
+    {
+        return (Distance_Type)(0.5 + Double_Distance(First_City, Second_City));
+    }
+};
+
+// Euclidean distance between normalized 3D coordinates, magnified and rounded
+// to the nearest integer
+struct Metric_EUC_3D
+{
+    typedef double Input_Type;
+    static const int Dim = 3;
+    static constexpr double Scale = Magnify_Rate;
+
+    static void Prepare() {}
+
+    static double Double_Distance(int First_City, int Second_City)
+    {
+        double Delta_X = Coordinate_X[First_City] - Coordinate_X[Second_City];
+        double Delta_Y = Coordinate_Y[First_City] - Coordinate_Y[Second_City];
+        double Delta_Z = Coordinate_Z[First_City] - Coordinate_Z[Second_City];
+        return sqrt(Delta_X * Delta_X + Delta_Y * Delta_Y + Delta_Z * Delta_Z);
+    }
+
+    static Distance_Type Int_Distance(int First_City, int Second_City)
+    {
+        return (Distance_Type)(0.5 + Double_Distance(First_City, Second_City));
+    }
+};
+
+// TSPLIB CEIL_2D: Euclidean distance on the raw coordinates, rounded up
+struct Metric_CEIL_2D
+{
+    typedef double Input_Type;
+    static const int Dim = 2;
+    static constexpr double Scale = 1;
+
+    static void Prepare() {}
+
+    static Distance_Type Int_Distance(int First_City, int Second_City)
+    {
+        double Delta_X = Coordinate_X[First_City] - Coordinate_X[Second_City];
+        double Delta_Y = Coordinate_Y[First_City] - Coordinate_Y[Second_City];
+        return (Distance_Type)ceil(sqrt(Delta_X * Delta_X + Delta_Y * Delta_Y));
+    }
+
+    static double Double_Distance(int First_City, int Second_City)
+    {
+        return Int_Distance(First_City, Second_City);
+    }
+};
+
+// TSPLIB GEO: great circle distance (in km) between (latitude, longitude)
+// pairs given in DDD.MM format
+struct Metric_GEO
+{
+    typedef double Input_Type;
+    static const int Dim = 2;
+    static constexpr double Scale = 1;
+
+    // Convert the DDD.MM coordinates to radians once, instead of in every call
+    static void Prepare()
+    {
+        const double PI = 3.141592;
+        for (int i = 0; i < Virtual_City_Num; i++)
+        {
+            double Degree_X = (int)Coordinate_X[i];
+            double Degree_Y = (int)Coordinate_Y[i];
+            Coordinate_X[i] = PI * (Degree_X + 5.0 * (Coordinate_X[i] - Degree_X) / 3.0) / 180.0;
+            Coordinate_Y[i] = PI * (Degree_Y + 5.0 * (Coordinate_Y[i] - Degree_Y) / 3.0) / 180.0;
+        }
+    }
+
+    static Distance_Type Int_Distance(int First_City, int Second_City)
+    {
+        const double RRR = 6378.388;
+        double Q1 = cos(Coordinate_Y[First_City] - Coordinate_Y[Second_City]);
+        double Q2 = cos(Coordinate_X[First_City] - Coordinate_X[Second_City]);
+        double Q3 = cos(Coordinate_X[First_City] + Coordinate_X[Second_City]);
+        return (Distance_Type)(RRR * acos(0.5 * ((1.0 + Q1) * Q2 - (1.0 - Q1) * Q3)) + 1.0);
+    }
+
+    static double Double_Distance(int First_City, int Second_City)
+    {
+        return Int_Distance(First_City, Second_City);
+    }
+};
+
+// TSPLIB ATT: pseudo-Euclidean distance on the raw coordinates
+struct Metric_ATT
+{
+    typedef double Input_Type;
+    static const int Dim = 2;
+    static constexpr double Scale = 1;
+
+    static void Prepare() {}
+
+    static Distance_Type Int_Distance(int First_City, int Second_City)
+    {
+        double Delta_X = Coordinate_X[First_City] - Coordinate_X[Second_City];
+        double Delta_Y = Coordinate_Y[First_City] - Coordinate_Y[Second_City];
+        double R = sqrt((Delta_X * Delta_X + Delta_Y * Delta_Y) / 10.0);
+        Distance_Type T = (Distance_Type)(R + 0.5);
+        return T < R ? T + 1 : T;
+    }
+
+    static double Double_Distance(int First_City, int Second_City)
+    {
+        return Int_Distance(First_City, Second_City);
+    }
+};
+
+// Explicit integer distance matrix, copied into Distance[][] by the caller
+// (e.g. road network distances). Asymmetric entries are not supported
+struct Metric_Explicit
+{
+    typedef int Input_Type;
+    static const int Dim = 0;
+    static constexpr double Scale = 1;
+
+    static void Prepare() {}
+
+    static Distance_Type Int_Distance(int First_City, int Second_City)
+    {
+        return Distance[First_City][Second_City];
+    }
+
+    static double Double_Distance(int First_City, int Second_City)
+    {
+        return Distance[First_City][Second_City];
+    }
+};
+
+#endif // TSP_METRIC_H
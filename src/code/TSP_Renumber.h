@@ -0,0 +1,122 @@
+#ifndef TSP_RENUMBER_H
+#define TSP_RENUMBER_H
+
+#include "TSP_Edge_Weight.h"
+#include "TSP_Hilbert.h"
+#include "TSP_Spatial_Grid.h"
+
+// Internal renumbering of the cities (Renumber_Method). The solver indexes
+// All_Node, the rows of Distance[][], Weight[][] and Candidate[][] by city, so
+// with cities in random input order every candidate probe lands on a cold
+// cache line. Numbering the cities along a Hilbert curve or a nearest-neighbor
+// tour gives neighboring cities neighboring rows. Order[] maps the internal
+// numbers to the input ones, Inverse[] the input numbers to the internal ones
+
+// Return the identifier of a renumbering method given its name, or Null
+int Get_Renumber_Method_Id(const std::string &Renumber_Method_Name)
+{
+    const char *Renumber_Method_Names[] = {"none", "hilbert", "greedy"};
+    for (int i = 0; i <= Renumber_Greedy; i++)
+        if (Renumber_Method_Name == Renumber_Method_Names[i])
+            return i;
+
+    return Null;
+}
+
+// Store in Order[] the cities of a nearest-neighbor tour from city 0, over the
+// coordinates (X[],Y[]) if given, otherwise over the row-major N x N matrix
+template <typename Input_Type>
+void Get_Nearest_Neighbor_Order(int N, const double *X, const double *Y, const Input_Type *Matrix, int *Order)
+{
+    Spatial_Grid Grid;
+    vector<char> If_Visited;
+    if (X != NULL)
+    {
+        Grid.Build(N, X, Y);
+        for (int i = 1; i < N; i++)
+            Grid.Insert(i);
+    }
+    else
+        If_Visited.assign(N, false);
+
+    int Cur_City = 0;
+    for (int i = 0; i < N; i++)
+    {
+        Order[i] = Cur_City;
+        if (X != NULL)
+        {
+            Cur_City = Grid.Get_Nearest(Cur_City);
+            if (Cur_City != Null)
+                Grid.Remove(Cur_City);
+            continue;
+        }
+
+        If_Visited[Cur_City] = true;
+        const Input_Type *Row = Matrix + (size_t)Cur_City * N;
+        int Next_City = Null;
+        for (int j = 0; j < N; j++)
+            if (!If_Visited[j] && (Next_City == Null || Row[j] < Row[Next_City]))
+                Next_City = j;
+        Cur_City = Next_City;
+    }
+}
+
+// Compute the renumbering of the N cities of Input under Metric. Cities
+// without coordinates (Metric_Explicit) are always ordered by a
+// nearest-neighbor tour
+template <typename Metric>
+void Get_City_Renumbering(int N, const typename Metric::Input_Type *Input, int Method, vector<int> &Order,
+                          vector<int> &Inverse)
+{
+    Order.resize(N);
+    if constexpr (Metric::Dim == 0)
+        Get_Nearest_Neighbor_Order<typename Metric::Input_Type>(N, NULL, NULL, Input, Order.data());
+    else
+    {
+        vector<double> X(N), Y(N);
+        for (int i = 0; i < N; i++)
+        {
+            X[i] = Input[i * Metric::Dim];
+            Y[i] = Input[i * Metric::Dim + 1];
+        }
+        if (Method == Renumber_Hilbert)
+            Get_Hilbert_Order(N, X.data(), Y.data(), Order.data());
+        else
+            Get_Nearest_Neighbor_Order<double>(N, X.data(), Y.data(), NULL, Order.data());
+    }
+
+    Inverse.resize(N);
+    for (int i = 0; i < N; i++)
+        Inverse[Order[i]] = i;
+}
+
+// Map a tour given in input numbers to internal numbers. Entries out of
+// range are left as they are
+void Renumber_Tour(int N, const int *Tour, const vector<int> &Inverse, vector<int> &Output)
+{
+    Output.resize(N);
+    for (int i = 0; i < N; i++)
+        Output[i] = Tour[i] >= 0 && Tour[i] < N ? Inverse[Tour[i]] : Tour[i];
+}
+
+// Map sparse edge weights between the two numberings: row i of Output is row
+// Row_Map[i] of Input, and each city c listed in the rows becomes City_Map[c]
+void Renumber_Edge_Weight(const Sparse_Edge_Weight &Input, const vector<int> &Row_Map, const vector<int> &City_Map,
+                          Sparse_Edge_Weight &Output)
+{
+    int N = (int)Row_Map.size();
+    int K = Input.K;
+    Output.K = K;
+    Output.City.assign((size_t)N * K, Null);
+    Output.Weight.assign((size_t)N * K, 0);
+    for (int i = 0; i < N; i++)
+        for (int k = 0; k < K; k++)
+        {
+            size_t From = (size_t)Row_Map[i] * K + k;
+            int City = Input.City[From];
+            Output.City[(size_t)i * K + k] = City >= 0 && City < N ? City_Map[City] : City;
+            Output.Weight[(size_t)i * K + k] = Input.Weight[From];
+        }
+}
+
+#endif // TSP_RENUMBER_H
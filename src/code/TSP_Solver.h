@@ -0,0 +1,615 @@
+#ifndef TSP_SOLVER_H
+#define TSP_SOLVER_H
+
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "TSP_Alpha_Nearness.h"
+#include "TSP_Heatmap_Ingestion.h"
+#include "TSP_Lower_Bound.h"
+#include "TSP_Renumber.h"
+#include "TSP_Markov_Decision.h"
+
+// Hyper parameters of one solve. They live in thread_local globals, so a
+// copy is carried to whichever thread runs the search
+struct Search_Param
+{
+    double Alpha;
+    double Beta;
+    double Param_H;
+    double Param_T;
+    int Max_Candidate_Num;
+    int Candidate_Use_Heatmap;
+    int Max_Depth;
+    int Restart_Policy;
+    int Kick_Segment_Len;
+    int Init_Method;
+    bool Focused_Sampling;
+    int MCTS_Patience;
+    double Stagnation_Threshold;
+    bool Log_Length_Time;
+    bool MCTS_Debug;
+    std::string Checkpoint_Path;
+    double Checkpoint_Interval;
+    std::string Resume_Path;
+    int Export_Weight_Num = 0;
+    bool Compute_Lower_Bound = false;
+    double Target_Gap = 0;
+    int Renumber_Method = Renumber_None;
+    int Heatmap_Format = Heatmap_Float64;
+    double Heatmap_Scale = 1.0 / 255;
+    int Island_Num = 1;
+    int Elite_Pool_Size = 0;
+};
+
+Search_Param Get_Search_Param()
+{
+    return Search_Param{Alpha,
+                        Beta,
+                        Param_H,
+                        Param_T,
+                        Max_Candidate_Num,
+                        Candidate_Use_Heatmap,
+                        Max_Depth,
+                        Restart_Policy,
+                        Kick_Segment_Len,
+                        Init_Method,
+                        Focused_Sampling,
+                        MCTS_Patience,
+                        Stagnation_Threshold,
+                        Log_Length_Time,
+                        MCTS_Debug,
+                        Checkpoint_Path,
+                        Checkpoint_Interval,
+                        Resume_Path,
+                        Export_Weight_Num,
+                        Compute_Lower_Bound,
+                        Target_Gap,
+                        Renumber_Method,
+                        Heatmap_Format,
+                        Heatmap_Scale,
+                        Island_Num,
+                        Elite_Pool_Size};
+}
+
+void Set_Search_Param(const Search_Param &Param)
+{
+    Alpha = Param.Alpha;
+    Beta = Param.Beta;
+    Param_H = Param.Param_H;
+    Param_T = Param.Param_T;
+    Max_Candidate_Num = Param.Max_Candidate_Num;
+    Candidate_Use_Heatmap = Param.Candidate_Use_Heatmap;
+    Max_Depth = Param.Max_Depth;
+    Restart_Policy = Param.Restart_Policy;
+    Kick_Segment_Len = Param.Kick_Segment_Len;
+    Init_Method = Param.Init_Method;
+    Focused_Sampling = Param.Focused_Sampling;
+    MCTS_Patience = Param.MCTS_Patience;
+    Stagnation_Threshold = Param.Stagnation_Threshold;
+    Log_Length_Time = Param.Log_Length_Time;
+    MCTS_Debug = Param.MCTS_Debug;
+    Checkpoint_Path = Param.Checkpoint_Path;
+    Checkpoint_Interval = Param.Checkpoint_Interval;
+    Resume_Path = Param.Resume_Path;
+    Export_Weight_Num = Param.Export_Weight_Num;
+    Compute_Lower_Bound = Param.Compute_Lower_Bound;
+    Target_Gap = Param.Target_Gap;
+    Renumber_Method = Param.Renumber_Method;
+    Heatmap_Format = Param.Heatmap_Format;
+    Heatmap_Scale = Param.Heatmap_Scale;
+    Island_Num = Param.Island_Num;
+    Elite_Pool_Size = Param.Elite_Pool_Size;
+}
+
+// Result of one solve
+struct TSP_Output
+{
+    double Concorde_Distance;
+    double MCTS_Distance;
+    double Gap;
+    double Time;
+    double Overall_Time;
+    vector<int> Solution;       // tour starting from Start_City
+    vector<double> Length_Time; // flattened (length, time) records
+    Sparse_Edge_Weight Learned_Weight; // empty unless Export_Weight_Num > 0
+    double Lower_Bound = -1;   // Held-Karp bound, -1 unless Compute_Lower_Bound or Target_Gap > 0
+    double Certified_Gap = -1; // (tour length - Lower_Bound) / Lower_Bound, -1 without a bound
+};
+
+// Copy the input of an instance into the coordinates, or into Distance[][]
+// for Metric_Explicit. If Order is given, city i is city Order[i] of the input
+template <typename Metric>
+void Load_Instance_Input(const typename Metric::Input_Type *Input, const int *Order = NULL)
+{
+    auto Get_Input_City = [&](int City) { return Order == NULL ? City : Order[City]; };
+    if constexpr (Metric::Dim == 0)
+    {
+        for (int i = 0; i < Virtual_City_Num; i++)
+        {
+            const typename Metric::Input_Type *Row = Input + (size_t)Get_Input_City(i) * Virtual_City_Num;
+            for (int j = 0; j < Virtual_City_Num; j++)
+                Distance[i][j] = Row[Get_Input_City(j)];
+        }
+    }
+    else
+    {
+        for (int i = 0; i < Virtual_City_Num; i++)
+        {
+            const typename Metric::Input_Type *City_Input = Input + (size_t)Get_Input_City(i) * Metric::Dim;
+            Coordinate_X[i] = City_Input[0] * Metric::Scale;
+            Coordinate_Y[i] = City_Input[1] * Metric::Scale;
+            Coordinate_Z[i] = Metric::Dim > 2 ? City_Input[Metric::Dim - 1] * Metric::Scale : 0;
+        }
+    }
+}
+
+// Structures of an instance that do not depend on the heatmap: the
+// coordinates, Distance[][] and, if the candidates do not depend on the
+// heatmap, Candidate[][]. They are built once and read by several concurrent searches
+struct Shared_Instance
+{
+    int City_Num = 0;
+    vector<int> Order, Inverse; // internal renumbering of the cities (see TSP_Renumber.h), empty if none
+    double *Coordinate_X = NULL;
+    double *Coordinate_Y = NULL;
+    double *Coordinate_Z = NULL;
+    Distance_Type **Distance = NULL;
+    int *Candidate_Num = NULL; // NULL if the candidates depend on the heatmap
+    int **Candidate = NULL;    // best candidates first, so that a prefix serves a smaller Max_Candidate_Num
+
+    // Float heatmap and MCTS statistics kept between the searches of one
+    // thread (see TSP_Dynamic.h), NULL unless kept. They are written by the
+    // search, so an instance keeping them is never read by concurrent ones
+    float **Edge_Heatmap = NULL;
+    float **Weight = NULL;
+    int **Chosen_Times = NULL;
+
+    Shared_Instance() = default;
+    Shared_Instance(const Shared_Instance &) = delete;
+    Shared_Instance &operator=(const Shared_Instance &) = delete;
+
+    ~Shared_Instance()
+    {
+        delete[] Coordinate_X;
+        delete[] Coordinate_Y;
+        delete[] Coordinate_Z;
+        if (Distance != NULL)
+            for (int i = 0; i < City_Num; i++)
+                delete[] Distance[i];
+        delete[] Distance;
+        delete[] Candidate_Num;
+        if (Candidate != NULL)
+            for (int i = 0; i < City_Num; i++)
+                delete[] Candidate[i];
+        delete[] Candidate;
+        if (Weight != NULL)
+            for (int i = 0; i < City_Num; i++)
+            {
+                delete[] Edge_Heatmap[i];
+                delete[] Weight[i];
+                delete[] Chosen_Times[i];
+            }
+        delete[] Edge_Heatmap;
+        delete[] Weight;
+        delete[] Chosen_Times;
+    }
+
+    // Build the structures of an instance of N cities, using the globals of
+    // the calling thread as scratch space
+    template <typename Metric>
+    void Build(int N, const Search_Param &Param, const typename Metric::Input_Type *Input)
+    {
+        Set_Search_Param(Param);
+        City_Num = Virtual_City_Num = N;
+
+        Coordinate_X = ::Coordinate_X = new double[N];
+        Coordinate_Y = ::Coordinate_Y = new double[N];
+        Coordinate_Z = ::Coordinate_Z = new double[N];
+        Distance = ::Distance = new Distance_Type *[N];
+        for (int i = 0; i < N; i++)
+            Distance[i] = new Distance_Type[N];
+
+        if (Renumber_Method != Renumber_None)
+            Get_City_Renumbering<Metric>(N, Input, Renumber_Method, Order, Inverse);
+        Load_Instance_Input<Metric>(Input, Order.empty() ? NULL : Order.data());
+        Metric::Prepare();
+        Calculate_All_Pair_Distance<Metric>();
+
+        if (!If_Candidate_From_Heatmap())
+        {
+            Candidate_Num = ::Candidate_Num = new int[N];
+            Candidate = ::Candidate = new int *[N];
+            for (int i = 0; i < N; i++)
+                Candidate[i] = new int[Max_Candidate_Num];
+            If_City_Selected = new bool[N];
+            Identify_Candidate_Set();
+            delete[] If_City_Selected;
+        }
+    }
+
+    // Point the globals of the calling thread to the shared structures. The
+    // candidate counts are copied, clipped to the Max_Candidate_Num of the
+    // calling thread
+    void Attach() const
+    {
+        ::Coordinate_X = Coordinate_X;
+        ::Coordinate_Y = Coordinate_Y;
+        ::Coordinate_Z = Coordinate_Z;
+        ::Distance = Distance;
+        if (If_Shared_Candidate)
+        {
+            ::Candidate = Candidate;
+            for (int i = 0; i < City_Num; i++)
+                ::Candidate_Num[i] = min(Candidate_Num[i], Max_Candidate_Num);
+        }
+        if (If_Shared_Weight)
+        {
+            ::Edge_Heatmap = Edge_Heatmap;
+            ::Weight = Weight;
+            ::Chosen_Times = Chosen_Times;
+        }
+    }
+};
+
+// Hash of an instance of N cities as loaded in internal numbering (the
+// coordinates, or the distance matrix for Metric_Explicit), from the
+// structures of Shared if given, else from Input renumbered by Order (NULL if
+// none). Checkpoints store it so that a snapshot is only resumed on the
+// instance it was taken from
+template <typename Metric>
+unsigned long long Get_Instance_Hash(int N, const typename Metric::Input_Type *Input, const int *Order,
+                                     const Shared_Instance *Shared)
+{
+    unsigned long long Hash = 14695981039346656037ULL; // FNV-1a over 64-bit words
+    auto Add_To_Hash = [&Hash](auto Value) {
+        unsigned long long Bits = 0;
+        memcpy(&Bits, &Value, sizeof(Value));
+        Hash = (Hash ^ Bits) * 1099511628211ULL;
+    };
+    auto Get_Input_City = [&](int City) { return Order == NULL ? City : Order[City]; };
+
+    for (int i = 0; i < N; i++)
+    {
+        if constexpr (Metric::Dim == 0)
+        {
+            const typename Metric::Input_Type *Row = Shared != NULL ? NULL : Input + (size_t)Get_Input_City(i) * N;
+            for (int j = 0; j < N; j++)
+                Add_To_Hash(Shared != NULL ? Shared->Distance[i][j] : (Distance_Type)Row[Get_Input_City(j)]);
+        }
+        else
+        {
+            const typename Metric::Input_Type *City_Input =
+                Shared != NULL ? NULL : Input + (size_t)Get_Input_City(i) * Metric::Dim;
+            Add_To_Hash(Shared != NULL ? Shared->Coordinate_X[i] : City_Input[0] * Metric::Scale);
+            Add_To_Hash(Shared != NULL ? Shared->Coordinate_Y[i] : City_Input[1] * Metric::Scale);
+            if (Metric::Dim > 2)
+                Add_To_Hash(Shared != NULL ? Shared->Coordinate_Z[i] : City_Input[Metric::Dim - 1] * Metric::Scale);
+        }
+    }
+    return Hash;
+}
+
+// Solve one instance of N cities under the metric policy Metric (see
+// TSP_Metric.h), in the calling thread. All arrays are row-major: Input holds
+// the coordinates (N x Metric::Dim), or the distance matrix (N x N) for
+// Metric_Explicit, and Heatmap is N x N entries of Heatmap_Format. Heatmap may
+// be NULL if the candidates do not depend on it, the candidate edges then
+// serve as heatmap. If Shared is given, its structures are used instead of
+// being derived from Input. If Prior_Weight is given, the search starts from
+// these learned weights instead of the heatmap ones. With Use_Warm_Start, the
+// search starts from Opt_Tour and, if Shared keeps the MCTS statistics and
+// there is no Heatmap, from the kept Weight[][] and Chosen_Times[][] (the
+// caller resets those of the changed cities). The cities may be renumbered
+// internally (Renumber_Method, or the renumbering of Shared), the output is in
+// input numbers. With Compute_Lower_Bound or Target_Gap > 0, a lower bound is
+// computed on a second thread during the search, which stops once the tour is
+// within Target_Gap of the bound
+template <typename Metric>
+TSP_Output Solve_Instance(int N, const Search_Param &Param, const typename Metric::Input_Type *Input,
+                          const int *Opt_Tour, const void *Heatmap, const Shared_Instance *Shared = NULL,
+                          const Sparse_Edge_Weight *Prior_Weight = NULL)
+{
+    auto Overall_Start = std::chrono::steady_clock::now();
+    Set_Random_Seed(Random_Seed + 0x9E3779B97F4A7C15ULL * Island_Index); // islands draw different streams
+
+    // Initialize parameters
+    Temp_City_Num = N;
+    Set_Search_Param(Param);
+    if (Heatmap == NULL)
+        Heatmap_Format = Heatmap_Float64; // the surrogate heatmap is stored as float
+    Length_Time.clear();
+    Current_Instance_Best_Distance = Inf_Cost;
+    Trace_Begin_Instance(Metric::Scale);
+
+    if (MCTS_Debug)
+    {
+        std::cout << "求解器创建，参数如下：" << std::endl;
+        std::cout << "Temp_City_Num: " << Temp_City_Num << std::endl;
+        std::cout << "Alpha: " << Alpha << std::endl;
+        std::cout << "Beta: " << Beta << std::endl;
+        std::cout << "Param_H: " << Param_H << std::endl;
+        std::cout << "Param_T: " << Param_T << std::endl;
+        std::cout << "Max_Candidate_Num: " << Max_Candidate_Num << std::endl;
+        std::cout << "Candidate_Use_Heatmap: " << Candidate_Use_Heatmap << std::endl;
+        std::cout << "Max_Depth: " << Max_Depth << std::endl;
+        std::cout << "Restart_Policy: " << Restart_Policy << std::endl;
+        std::cout << "Kick_Segment_Len: " << Kick_Segment_Len << std::endl;
+        std::cout << "Init_Method: " << Init_Method << std::endl;
+        std::cout << "Focused_Sampling: " << Focused_Sampling << std::endl;
+        std::cout << "MCTS_Patience: " << MCTS_Patience << std::endl;
+        std::cout << "Stagnation_Threshold: " << Stagnation_Threshold << std::endl;
+    }
+
+    City_Num = Temp_City_Num;
+    Start_City = 0;
+    Salesman_Num = 1;
+    Virtual_City_Num = City_Num + Salesman_Num - 1;
+    If_Has_Coordinates = Metric::Dim > 0;
+    If_Shared_Instance = Shared != NULL;
+    If_Shared_Candidate = Shared != NULL && Shared->Candidate != NULL && !If_Candidate_From_Heatmap();
+    If_Shared_Weight = Shared != NULL && Shared->Weight != NULL && Heatmap_Format == Heatmap_Float64;
+    bool If_Weight_Kept = If_Shared_Weight && Use_Warm_Start && Heatmap == NULL;
+
+    // Renumber the cities for locality, the rest of the solve only sees the
+    // internal numbers
+    vector<int> Own_Order, Own_Inverse, Renumbered_Opt_Tour;
+    Sparse_Edge_Weight Renumbered_Prior_Weight;
+    if (Shared == NULL && Renumber_Method != Renumber_None)
+        Get_City_Renumbering<Metric>(Virtual_City_Num, Input, Renumber_Method, Own_Order, Own_Inverse);
+    const vector<int> &Order = Shared != NULL ? Shared->Order : Own_Order;
+    const vector<int> &Inverse = Shared != NULL ? Shared->Inverse : Own_Inverse;
+    bool If_Renumbered = !Order.empty();
+    if (If_Renumbered)
+    {
+        Renumber_Tour(Virtual_City_Num, Opt_Tour, Inverse, Renumbered_Opt_Tour);
+        Opt_Tour = Renumbered_Opt_Tour.data();
+        if (Prior_Weight != NULL)
+        {
+            Renumber_Edge_Weight(*Prior_Weight, Order, Inverse, Renumbered_Prior_Weight);
+            Prior_Weight = &Renumbered_Prior_Weight;
+        }
+    }
+
+    // An unusable snapshot fails the solve before anything is allocated
+    if (!Checkpoint_Path.empty() || !Resume_Path.empty())
+        Checkpoint_Instance_Hash =
+            Get_Instance_Hash<Metric>(Virtual_City_Num, Input, If_Renumbered ? Order.data() : NULL, Shared);
+    Load_Resume_Snapshot(Virtual_City_Num);
+
+    auto memory_start = std::chrono::steady_clock::now();
+    Allocate_Memory(Virtual_City_Num);
+    if (Shared != NULL)
+        Shared->Attach();
+    auto memory_end = std::chrono::steady_clock::now();
+
+    // Fill in the matrix
+    auto data_copy_start = std::chrono::steady_clock::now();
+    Trace_Begin(Trace_Phase_Load_Input);
+    if (Shared == NULL)
+        Load_Instance_Input<Metric>(Input, If_Renumbered ? Order.data() : NULL);
+
+    for (int i = 0; i < Virtual_City_Num; i++)
+        Opt_Solution[i] = Opt_Tour[i];
+    if (Use_Warm_Start)
+        for (int i = 0; i < Virtual_City_Num; i++)
+            Solution[i] = Opt_Tour[i];
+    auto data_copy_end = std::chrono::steady_clock::now();
+
+    auto dist_calc_start = std::chrono::steady_clock::now();
+    if (Shared == NULL)
+    {
+        Metric::Prepare();
+        Calculate_All_Pair_Distance<Metric>();
+    }
+    auto dist_calc_end = std::chrono::steady_clock::now();
+
+    // The bound thread only needs Distance[][], it overlaps the rest of the
+    // solve. Islands share the bound of their board (see TSP_Island.h)
+    Lower_Bound_Task Lower_Bound;
+    bool If_Lower_Bound = (Compute_Lower_Bound || Target_Gap > 0) && Shared_Island_Board == NULL;
+    Published_Lower_Bound = Shared_Island_Board != NULL ? Shared_Island_Board->Lower_Bound : NULL;
+    if (If_Lower_Bound)
+    {
+        Lower_Bound.Start();
+        Published_Lower_Bound = &Lower_Bound.Bound;
+    }
+
+    // The heatmap candidates are selected while the heatmap is read
+    auto ingestion_start = std::chrono::steady_clock::now();
+    if (Heatmap != NULL)
+        Ingest_Heatmap(Heatmap, Candidate_Use_Heatmap == Candidate_Heatmap && !If_Shared_Candidate,
+                       If_Renumbered ? Order.data() : NULL);
+    auto ingestion_end = std::chrono::steady_clock::now();
+
+    Trace_End(Trace_Phase_Load_Input);
+    Current_Instance_Begin_Time = std::chrono::steady_clock::now();
+
+    auto candidate_start = std::chrono::steady_clock::now();
+    Trace_Begin(Trace_Phase_Candidate_Set);
+    if (!If_Shared_Candidate && Candidate_Use_Heatmap != Candidate_Heatmap)
+        Identify_Candidate_Set();
+    if (Heatmap == NULL && !If_Weight_Kept)
+        Set_Candidate_Edge_Heatmap();
+    if (If_Weight_Kept)
+        If_Weight_Initialized = true; // MCTS_Init() starts from the kept statistics
+    Trace_End(Trace_Phase_Candidate_Set);
+    auto candidate_end = std::chrono::steady_clock::now();
+
+    auto mdp_start = std::chrono::steady_clock::now();
+    Prior_Edge_Weight = Prior_Weight;
+    Markov_Decision_Process();
+    Prior_Edge_Weight = NULL;
+    Published_Lower_Bound = NULL;
+    auto mdp_end = std::chrono::steady_clock::now();
+
+    TSP_Output Output;
+    double Stored_Solution_Double_Distance = Get_Stored_Solution_Double_Distance<Metric>();
+    double Current_Solution_Double_Distance = Get_Current_Solution_Double_Distance<Metric>();
+    Output.Concorde_Distance = Stored_Solution_Double_Distance / Metric::Scale;
+    Output.MCTS_Distance = Current_Solution_Double_Distance / Metric::Scale;
+    Output.Gap =
+        (Current_Solution_Double_Distance - Stored_Solution_Double_Distance) / Stored_Solution_Double_Distance;
+    Output.Time = Get_Elapsed_Time(Current_Instance_Begin_Time);
+
+    // The tour starts from input city 0
+    Output.Solution.reserve(Virtual_City_Num);
+    int Cur_City = If_Renumbered ? Inverse[0] : Start_City;
+    int First_City = Cur_City;
+    do
+    {
+        Output.Solution.push_back(If_Renumbered ? Order[Cur_City] : Cur_City);
+        Cur_City = All_Node[Cur_City].Next_City;
+    } while (Cur_City != Null && Cur_City != First_City);
+
+    Output.Length_Time.reserve(2 * Length_Time.size());
+    for (auto &pair : Length_Time)
+    {
+        pair.first /= Metric::Scale;
+        Output.Length_Time.push_back(pair.first);
+        Output.Length_Time.push_back(pair.second);
+    }
+
+    if (Export_Weight_Num > 0)
+    {
+        Export_Edge_Weight(Export_Weight_Num, Output.Learned_Weight);
+        if (If_Renumbered)
+        {
+            Sparse_Edge_Weight Learned_Weight;
+            Renumber_Edge_Weight(Output.Learned_Weight, Inverse, Order, Learned_Weight);
+            Output.Learned_Weight = std::move(Learned_Weight);
+        }
+    }
+
+    if (If_Lower_Bound)
+    {
+        long long Bound = Lower_Bound.Finish();
+        if (Bound > 0)
+        {
+            Output.Lower_Bound = Bound / Metric::Scale;
+            Output.Certified_Gap = (double)(Get_Solution_Total_Distance() - Bound) / Bound;
+        }
+    }
+
+    Release_Memory(Virtual_City_Num);
+    If_Shared_Instance = If_Shared_Candidate = If_Shared_Weight = false;
+    Output.Overall_Time = Get_Elapsed_Time(Overall_Start);
+    Trace_End(Trace_Phase_Solve);
+
+    if (MCTS_Debug)
+    {
+        std::cout << "求解完成，结果如下：" << std::endl;
+        std::cout << "Stored_Solution_Double_Distance: " << Stored_Solution_Double_Distance << std::endl;
+        std::cout << "Current_Solution_Double_Distance: " << Current_Solution_Double_Distance << std::endl;
+        std::cout << "Concorde_Distance: " << Output.Concorde_Distance << std::endl;
+        std::cout << "MCTS_Distance: " << Output.MCTS_Distance << std::endl;
+        std::cout << "Gap: " << Output.Gap * 100 << "%" << std::endl;
+        std::cout << "Time: " << Output.Time << " seconds" << std::endl;
+        std::cout << "Overall_Time: " << Output.Overall_Time << " seconds" << std::endl;
+
+        std::cout << "Solution: ";
+        for (size_t i = 0; i < Output.Solution.size(); ++i)
+        {
+            std::cout << Output.Solution[i] << " ";
+        }
+        for (auto &pair : Length_Time)
+        {
+            std::cout << "Length: " << pair.first << " Time: " << pair.second << std::endl;
+        }
+        std::cout << std::endl;
+
+        // Print timing for each part
+        std::cout << "--- Timing Breakdown ---" << std::endl;
+        std::cout << "Allocate_Memory: " << std::chrono::duration<double>(memory_end - memory_start).count() << " seconds" << std::endl;
+        std::cout << "Data Copy: " << std::chrono::duration<double>(data_copy_end - data_copy_start).count() << " seconds" << std::endl;
+        std::cout << "Calculate_All_Pair_Distance: " << std::chrono::duration<double>(dist_calc_end - dist_calc_start).count() << " seconds" << std::endl;
+        std::cout << "Ingest_Heatmap: " << std::chrono::duration<double>(ingestion_end - ingestion_start).count() << " seconds" << std::endl;
+        std::cout << "Identify_Candidate_Set: " << std::chrono::duration<double>(candidate_end - candidate_start).count() << " seconds" << std::endl;
+        std::cout << "Markov_Decision_Process: " << std::chrono::duration<double>(mdp_end - mdp_start).count() << " seconds" << std::endl;
+    }
+
+    return Output;
+}
+
+// Run-time identifiers of the metric policies, used where the metric is only
+// known when a job is submitted
+#define Metric_Id_EUC_2D 0
+#define Metric_Id_EUC_3D 1
+#define Metric_Id_CEIL_2D 2
+#define Metric_Id_GEO 3
+#define Metric_Id_ATT 4
+#define Metric_Id_Explicit 5
+
+// TSPLIB name of a metric given its identifier
+const char *Get_Metric_Name(int Metric_Id)
+{
+    static const char *Metric_Names[] = {"EUC_2D", "EUC_3D", "CEIL_2D", "GEO", "ATT", "EXPLICIT"};
+    return Metric_Names[Metric_Id];
+}
+
+// Return the identifier of a metric given its TSPLIB name, or Null
+int Get_Metric_Id(const std::string &Metric_Name)
+{
+    for (int i = 0; i <= Metric_Id_Explicit; i++)
+        if (Metric_Name == Get_Metric_Name(i))
+            return i;
+
+    return Null;
+}
+
+// Run-time identifier of a metric policy
+template <typename Metric> constexpr int Get_Metric_Id()
+{
+    if constexpr (std::is_same<Metric, Metric_EUC_3D>::value)
+        return Metric_Id_EUC_3D;
+    else if constexpr (std::is_same<Metric, Metric_CEIL_2D>::value)
+        return Metric_Id_CEIL_2D;
+    else if constexpr (std::is_same<Metric, Metric_GEO>::value)
+        return Metric_Id_GEO;
+    else if constexpr (std::is_same<Metric, Metric_ATT>::value)
+        return Metric_Id_ATT;
+    else if constexpr (std::is_same<Metric, Metric_Explicit>::value)
+        return Metric_Id_Explicit;
+    else
+        return Metric_Id_EUC_2D;
+}
+
+// Number of input values per city under a metric
+int Get_Metric_Input_Dim(int Metric_Id, int N)
+{
+    switch (Metric_Id)
+    {
+    case Metric_Id_EUC_3D:
+        return Metric_EUC_3D::Dim;
+    case Metric_Id_Explicit:
+        return N;
+    default:
+        return Coord_Dim;
+    }
+}
+
+// Dispatch a solve to the metric policy chosen at run time. Coordinates is
+// used by the coordinate metrics and Distance_Matrix by Metric_Explicit
+TSP_Output Solve_Instance_By_Metric(int Metric_Id, int N, const Search_Param &Param, const double *Coordinates,
+                                    const int *Distance_Matrix, const int *Opt_Tour, const void *Heatmap,
+                                    const Sparse_Edge_Weight *Prior_Weight = NULL)
+{
+    switch (Metric_Id)
+    {
+    case Metric_Id_EUC_3D:
+        return Solve_Instance<Metric_EUC_3D>(N, Param, Coordinates, Opt_Tour, Heatmap, NULL, Prior_Weight);
+    case Metric_Id_CEIL_2D:
+        return Solve_Instance<Metric_CEIL_2D>(N, Param, Coordinates, Opt_Tour, Heatmap, NULL, Prior_Weight);
+    case Metric_Id_GEO:
+        return Solve_Instance<Metric_GEO>(N, Param, Coordinates, Opt_Tour, Heatmap, NULL, Prior_Weight);
+    case Metric_Id_ATT:
+        return Solve_Instance<Metric_ATT>(N, Param, Coordinates, Opt_Tour, Heatmap, NULL, Prior_Weight);
+    case Metric_Id_Explicit:
+        return Solve_Instance<Metric_Explicit>(N, Param, Distance_Matrix, Opt_Tour, Heatmap, NULL, Prior_Weight);
+    default:
+        return Solve_Instance<Metric_EUC_2D>(N, Param, Coordinates, Opt_Tour, Heatmap, NULL, Prior_Weight);
+    }
+}
+
+#endif // TSP_SOLVER_H
@@ -0,0 +1,200 @@
+#ifndef TSP_SOLVER_POOL_H
+#define TSP_SOLVER_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "TSP_Solver.h"
+
+// Shared state between a submitted job and the handle returned to the caller
+struct Solve_Future_State
+{
+    std::mutex Mutex;
+    std::condition_variable Done_Condition;
+    bool If_Done = false;
+    TSP_Output Output;
+    std::string Error; // non-empty if the solve failed
+    vector<std::function<void()>> Done_Callbacks;
+
+    // Block until the job is finished or Timeout seconds elapsed (Timeout < 0
+    // waits forever). Return whether the job is finished
+    bool Wait(double Timeout)
+    {
+        std::unique_lock<std::mutex> Lock(Mutex);
+        if (Timeout < 0)
+            Done_Condition.wait(Lock, [this] { return If_Done; });
+        else
+            Done_Condition.wait_for(Lock, std::chrono::duration<double>(Timeout), [this] { return If_Done; });
+        return If_Done;
+    }
+
+    // Run Callback once the job is finished, immediately if it already is
+    void Add_Done_Callback(std::function<void()> Callback)
+    {
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            if (!If_Done)
+            {
+                Done_Callbacks.push_back(std::move(Callback));
+                return;
+            }
+        }
+        Callback();
+    }
+
+    void Set_Done(TSP_Output &&Result, const std::string &Error_Message)
+    {
+        vector<std::function<void()>> Callbacks;
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            Output = std::move(Result);
+            Error = Error_Message;
+            If_Done = true;
+            Callbacks.swap(Done_Callbacks);
+        }
+        Done_Condition.notify_all();
+        for (auto &Callback : Callbacks)
+            Callback();
+    }
+};
+
+// One instance waiting in the queue of a solver pool, with its own copy of the
+// input so that the caller may release its buffers right after submission
+struct Solve_Job
+{
+    int Metric_Id;
+    int N;
+    Search_Param Param;
+    vector<double> Coordinates;
+    vector<int> Distance_Matrix;
+    vector<int> Opt_Tour;
+    vector<double> Heatmap;
+    std::shared_ptr<Solve_Future_State> State;
+};
+
+// Fixed set of worker threads solving submitted instances in FIFO order. The
+// queue is bounded: Submit() blocks the producer while Max_Queue_Size jobs are
+// waiting, which keeps a fast producer from buffering unbounded heatmaps. If
+// If_Share_Budget, the time left over by instances stopped on stagnation (see
+// TSP_Termination.h) is lent to the instances still improving
+class TSP_Solver_Pool
+{
+  public:
+    TSP_Solver_Pool(int Thread_Num, int Max_Queue_Size, bool If_Share_Budget = false)
+        : If_Share_Budget(If_Share_Budget)
+    {
+        if (Thread_Num <= 0)
+            Thread_Num = max(1u, std::thread::hardware_concurrency());
+        this->Max_Queue_Size = Max_Queue_Size > 0 ? Max_Queue_Size : 2 * Thread_Num;
+        for (int i = 0; i < Thread_Num; i++)
+            Workers.emplace_back(&TSP_Solver_Pool::Worker_Loop, this);
+    }
+
+    ~TSP_Solver_Pool()
+    {
+        Shutdown(true);
+    }
+
+    std::shared_ptr<Solve_Future_State> Submit(Solve_Job &&Job)
+    {
+        auto State = std::make_shared<Solve_Future_State>();
+        Job.State = State;
+
+        std::unique_lock<std::mutex> Lock(Queue_Mutex);
+        Not_Full.wait(Lock, [this] { return If_Stopping || (int)Queue.size() < Max_Queue_Size; });
+        if (If_Stopping)
+        {
+            Lock.unlock();
+            State->Set_Done(TSP_Output(), "The solver pool is shut down");
+            return State;
+        }
+        Queue.push_back(std::move(Job));
+        Lock.unlock();
+        Not_Empty.notify_one();
+
+        return State;
+    }
+
+    // Stop accepting jobs and wait for the workers to finish. The queued jobs
+    // are either solved first or, if If_Cancel_Queued, failed right away
+    void Shutdown(bool If_Cancel_Queued)
+    {
+        std::deque<Solve_Job> Dropped_Jobs;
+        {
+            std::lock_guard<std::mutex> Lock(Queue_Mutex);
+            If_Stopping = true;
+            if (If_Cancel_Queued)
+                Dropped_Jobs.swap(Queue);
+        }
+        Not_Empty.notify_all();
+        Not_Full.notify_all();
+
+        for (auto &Job : Dropped_Jobs)
+            Job.State->Set_Done(TSP_Output(), "The solver pool is shut down");
+        for (auto &Worker : Workers)
+            if (Worker.joinable())
+                Worker.join();
+    }
+
+    int Get_Queue_Size()
+    {
+        std::lock_guard<std::mutex> Lock(Queue_Mutex);
+        return (int)Queue.size();
+    }
+
+    int Get_Thread_Num() const
+    {
+        return (int)Workers.size();
+    }
+
+  private:
+    void Worker_Loop()
+    {
+        if (If_Share_Budget)
+            Shared_Budget_Bank = &Bank;
+
+        while (true)
+        {
+            Solve_Job Job;
+            {
+                std::unique_lock<std::mutex> Lock(Queue_Mutex);
+                Not_Empty.wait(Lock, [this] { return If_Stopping || !Queue.empty(); });
+                if (Queue.empty())
+                    return;
+                Job = std::move(Queue.front());
+                Queue.pop_front();
+            }
+            Not_Full.notify_one();
+
+            TSP_Output Output;
+            std::string Error;
+            try
+            {
+                Output = Solve_Instance_By_Metric(Job.Metric_Id, Job.N, Job.Param, Job.Coordinates.data(),
+                                                  Job.Distance_Matrix.data(), Job.Opt_Tour.data(),
+                                                  Job.Heatmap.data());
+            }
+            catch (const std::exception &e)
+            {
+                Error = e.what();
+            }
+            Job.State->Set_Done(std::move(Output), Error);
+        }
+    }
+
+    int Max_Queue_Size;
+    bool If_Share_Budget;
+    Budget_Bank Bank;
+    bool If_Stopping = false;
+    std::mutex Queue_Mutex;
+    std::condition_variable Not_Empty;
+    std::condition_variable Not_Full;
+    std::deque<Solve_Job> Queue;
+    vector<std::thread> Workers;
+};
+
+#endif // TSP_SOLVER_POOL_H
@@ -0,0 +1,193 @@
+#ifndef TSP_SPATIAL_GRID_H
+#define TSP_SPATIAL_GRID_H
+
+#include "TSP_IO.h"
+
+// Uniform grid over the bounding box of a set of points, storing a dynamic
+// subset of them. With a few points per cell, a nearest neighbor query visits
+// O(1) cells on average for roughly uniform instances. Once removals leave
+// most cells empty, the grid is refitted to the stored points, so that a query
+// never sweeps more than O(stored points) empty cells
+struct Spatial_Grid
+{
+    const double *X;
+    const double *Y;
+    double Min_X;
+    double Min_Y;
+    double Cell_Size;
+    double Point_Per_Cell;
+    int Grid_Width;
+    int Grid_Height;
+    int Stored_Num;
+    int Fitted_Num; // number of points the cells were laid out for
+    vector<vector<int>> Cells;
+    vector<int> Cell_Of;        // cell of each stored point
+    vector<int> Index_In_Cell;  // position of each stored point in its cell, Null if not stored
+
+    // Prepare an empty grid over the N points (X[],Y[])
+    void Build(int N, const double *X, const double *Y, double Point_Per_Cell = 2)
+    {
+        this->X = X;
+        this->Y = Y;
+        this->Point_Per_Cell = Point_Per_Cell;
+        Cell_Of.resize(N);
+        Index_In_Cell.assign(N, Null);
+        Stored_Num = 0;
+
+        double Max_X = X[0], Max_Y = Y[0];
+        Min_X = X[0];
+        Min_Y = Y[0];
+        for (int i = 1; i < N; i++)
+        {
+            Min_X = min(Min_X, X[i]);
+            Max_X = max(Max_X, X[i]);
+            Min_Y = min(Min_Y, Y[i]);
+            Max_Y = max(Max_Y, Y[i]);
+        }
+        Set_Cells(N, Max_X, Max_Y);
+    }
+
+    // Lay out empty cells over [Min_X,Max_X] x [Min_Y,Max_Y] for Point_Num points
+    void Set_Cells(int Point_Num, double Max_X, double Max_Y)
+    {
+        Point_Num = max(Point_Num, 1);
+        Fitted_Num = Point_Num;
+        double Width = max(Max_X - Min_X, 1e-12);
+        double Height = max(Max_Y - Min_Y, 1e-12);
+        Cell_Size = max(sqrt(Width * Height * Point_Per_Cell / Point_Num), 1e-12);
+        Grid_Width = min((int)(Width / Cell_Size) + 1, Point_Num);
+        Grid_Height = min((int)(Height / Cell_Size) + 1, Point_Num);
+        Cell_Size = max(Width / Grid_Width, Height / Grid_Height) * (1 + 1e-9);
+        // The cells kept from a previous layout keep their capacity
+        Cells.resize((size_t)Grid_Width * Grid_Height);
+        for (auto &Cell : Cells)
+            Cell.clear();
+    }
+
+    // Points outside the bounding box (after a refit) go to the nearest cell
+    int Get_Cell_X(double Coord_X) const
+    {
+        return max(min((int)((Coord_X - Min_X) / Cell_Size), Grid_Width - 1), 0);
+    }
+
+    int Get_Cell_Y(double Coord_Y) const
+    {
+        return max(min((int)((Coord_Y - Min_Y) / Cell_Size), Grid_Height - 1), 0);
+    }
+
+    int Get_Cell(int Point) const
+    {
+        return Get_Cell_Y(Y[Point]) * Grid_Width + Get_Cell_X(X[Point]);
+    }
+
+    bool If_Stored(int Point) const
+    {
+        return Index_In_Cell[Point] != Null;
+    }
+
+    void Insert(int Point)
+    {
+        if (If_Stored(Point))
+            return;
+        Cell_Of[Point] = Get_Cell(Point);
+        vector<int> &Cell = Cells[Cell_Of[Point]];
+        Index_In_Cell[Point] = (int)Cell.size();
+        Cell.push_back(Point);
+        Stored_Num++;
+    }
+
+    void Remove(int Point)
+    {
+        if (!If_Stored(Point))
+            return;
+        vector<int> &Cell = Cells[Cell_Of[Point]];
+        int Last_Point = Cell.back();
+        Cell[Index_In_Cell[Point]] = Last_Point;
+        Index_In_Cell[Last_Point] = Index_In_Cell[Point];
+        Cell.pop_back();
+        Index_In_Cell[Point] = Null;
+        Stored_Num--;
+
+        // Amortized O(1): a quarter of the points of the last fit are left
+        if (Stored_Num > 0 && Stored_Num * 4 < Fitted_Num)
+            Fit_To_Stored_Points();
+    }
+
+    // Shrink the grid to the bounding box of the stored points, with about
+    // Point_Per_Cell of them per cell. O(cells + stored points)
+    void Fit_To_Stored_Points()
+    {
+        vector<int> Stored_Point;
+        Stored_Point.reserve(Stored_Num);
+        for (auto &Cell : Cells)
+            Stored_Point.insert(Stored_Point.end(), Cell.begin(), Cell.end());
+        if (Stored_Point.empty())
+            return;
+
+        double Max_X = X[Stored_Point[0]], Max_Y = Y[Stored_Point[0]];
+        Min_X = Max_X;
+        Min_Y = Max_Y;
+        for (int Point : Stored_Point)
+        {
+            Min_X = min(Min_X, X[Point]);
+            Max_X = max(Max_X, X[Point]);
+            Min_Y = min(Min_Y, Y[Point]);
+            Max_Y = max(Max_Y, Y[Point]);
+            Index_In_Cell[Point] = Null;
+        }
+        Set_Cells((int)Stored_Point.size(), Max_X, Max_Y);
+        Stored_Num = 0;
+        for (int Point : Stored_Point)
+            Insert(Point);
+    }
+
+    // Return the stored point nearest to Point (other than Point itself), Null
+    // if the grid is empty. The cells are visited by rings of increasing
+    // radius, until no unvisited cell can hold a nearer point
+    int Get_Nearest(int Point) const
+    {
+        if (Stored_Num == 0)
+            return Null;
+        int Center_X = Get_Cell_X(X[Point]);
+        int Center_Y = Get_Cell_Y(Y[Point]);
+        int Max_Radius = max(Grid_Width, Grid_Height);
+
+        int Nearest_Point = Null;
+        double Nearest_Square_Dist = 0;
+        for (int Radius = 0; Radius <= Max_Radius; Radius++)
+        {
+            if (Nearest_Point != Null && (Radius - 1) * Cell_Size * (Radius - 1) * Cell_Size > Nearest_Square_Dist)
+                break;
+
+            for (int Cell_Y = Center_Y - Radius; Cell_Y <= Center_Y + Radius; Cell_Y++)
+            {
+                if (Cell_Y < 0 || Cell_Y >= Grid_Height)
+                    continue;
+                // Only the border of the ring is new
+                int Step = (Cell_Y == Center_Y - Radius || Cell_Y == Center_Y + Radius) ? 1 : max(2 * Radius, 1);
+                for (int Cell_X = Center_X - Radius; Cell_X <= Center_X + Radius; Cell_X += Step)
+                {
+                    if (Cell_X < 0 || Cell_X >= Grid_Width)
+                        continue;
+                    for (int Other_Point : Cells[(size_t)Cell_Y * Grid_Width + Cell_X])
+                    {
+                        if (Other_Point == Point)
+                            continue;
+                        double DX = X[Other_Point] - X[Point];
+                        double DY = Y[Other_Point] - Y[Point];
+                        double Square_Dist = DX * DX + DY * DY;
+                        if (Nearest_Point == Null || Square_Dist < Nearest_Square_Dist)
+                        {
+                            Nearest_Point = Other_Point;
+                            Nearest_Square_Dist = Square_Dist;
+                        }
+                    }
+                }
+            }
+        }
+
+        return Nearest_Point;
+    }
+};
+
+#endif // TSP_SPATIAL_GRID_H
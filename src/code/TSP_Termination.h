@@ -0,0 +1,163 @@
+#ifndef TSP_TERMINATION_H
+#define TSP_TERMINATION_H
+
+#include <atomic>
+#include <mutex>
+
+#include "TSP_Basic_Functions.h"
+#include "TSP_Island.h"
+
+// Seconds of search left over by instances that stopped early, available to
+// the instances of the same batch that are still improving
+struct Budget_Bank
+{
+    std::mutex Mutex;
+    double Seconds = 0;
+
+    void Deposit(double Amount)
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Seconds += Amount;
+    }
+
+    // Take at most Max_Amount seconds, return the amount taken
+    double Withdraw(double Max_Amount)
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        double Amount = min(Seconds, Max_Amount);
+        Seconds -= Amount;
+        return Amount;
+    }
+};
+
+// Bank shared by the instances solved alongside the current one (NULL if the
+// instance is solved on its own)
+thread_local Budget_Bank *Shared_Budget_Bank = NULL;
+
+// Lower bound published by the bound thread of the current instance (see
+// TSP_Lower_Bound.h), NULL if none runs. It holds Null until it is known
+thread_local const std::atomic<long long> *Published_Lower_Bound = NULL;
+
+// Cancellation of the current solve: the search stops once *Cancel_Epoch no
+// longer equals Solve_Epoch, its value when the solve started (NULL: the solve
+// cannot be cancelled)
+thread_local const std::atomic<unsigned> *Cancel_Epoch = NULL;
+thread_local unsigned Solve_Epoch = 0;
+
+#define Min_Restart_Num_Before_Stop 3 // restarts observed before the search may be stopped
+#define Min_Search_Ratio_Before_Stop 0.1 // part of its own budget searched before the search may be stopped
+#define Max_Borrow_Ratio 0.5 // part of its own budget an instance may borrow at a time
+
+// Used to estimate the improvement rate of the restarts
+thread_local vector<std::pair<double, Distance_Type>> Restart_Best_History; // (time, best distance) at each improving restart
+thread_local int Restart_Num;
+
+void Init_Termination_Controller()
+{
+    Time_Budget = Param_T * Virtual_City_Num;
+    Restart_Best_History.clear();
+    Restart_Num = 0;
+}
+
+// Record the best distance reached by the restart just finished. The first
+// call, after the initial descent, records the starting point
+void Record_Restart()
+{
+    if (Restart_Best_History.empty() || Restart_Best_History.back().second != Current_Instance_Best_Distance)
+        Restart_Best_History.push_back(
+            std::make_pair(Get_Elapsed_Time(Current_Instance_Begin_Time), Current_Instance_Best_Distance));
+    Restart_Num++;
+}
+
+// Gain of the best distance per second over the most recent half of the
+// search, which smooths out the rare improving restarts
+double Get_Improvement_Rate(double Elapsed_Time)
+{
+    double Window_Begin_Time = max(Elapsed_Time / 2, Restart_Best_History[0].first);
+    int Index = 0;
+    while (Index + 1 < (int)Restart_Best_History.size() && Restart_Best_History[Index + 1].first <= Window_Begin_Time)
+        Index++;
+
+    double Window_Time = max(Elapsed_Time - Window_Begin_Time, 1e-6);
+    return (double)(Restart_Best_History[Index].second - Current_Instance_Best_Distance) / Window_Time;
+}
+
+// Return true if the gain expected from Remaining_Time more seconds at the
+// current improvement rate is below Stagnation_Threshold of the best distance
+bool If_Search_Stagnated(double Elapsed_Time, double Remaining_Time)
+{
+    if (Restart_Num <= Min_Restart_Num_Before_Stop ||
+        Elapsed_Time < Min_Search_Ratio_Before_Stop * Param_T * Virtual_City_Num)
+        return false;
+
+    return Get_Improvement_Rate(Elapsed_Time) * Remaining_Time < Stagnation_Threshold * Current_Instance_Best_Distance;
+}
+
+// Return true if the best tour, of this search or of any island, is
+// certified within Target_Gap of the optimum by the published lower bound
+bool If_Target_Gap_Reached()
+{
+    Distance_Type Best_Distance = min(Current_Instance_Best_Distance, Get_Island_Best_Distance());
+    if (Target_Gap <= 0 || Published_Lower_Bound == NULL || Best_Distance >= Inf_Cost)
+        return false;
+
+    long long Lower_Bound = Published_Lower_Bound->load(std::memory_order_relaxed);
+    return Lower_Bound > 0 && Best_Distance - Lower_Bound <= Target_Gap * Lower_Bound;
+}
+
+bool If_Search_Cancelled()
+{
+    return Cancel_Epoch != NULL && Cancel_Epoch->load(std::memory_order_relaxed) != Solve_Epoch;
+}
+
+// Return true if the search should stop before its deadline, whatever its
+// progress
+bool If_Stop_Requested()
+{
+    return If_Search_Cancelled() || If_Target_Gap_Reached();
+}
+
+// Decide whether the MDP performs another restart. A search that stagnated,
+// was cancelled or reached Target_Gap stops before its deadline and gives the
+// unused time to the shared bank, a search still improving at its deadline
+// borrows time from the bank
+bool If_Continue_Search()
+{
+    double Elapsed_Time = Get_Elapsed_Time(Current_Instance_Begin_Time);
+    if (If_Stop_Requested())
+    {
+        if (Shared_Budget_Bank != NULL && Elapsed_Time < Time_Budget)
+            Shared_Budget_Bank->Deposit(Time_Budget - Elapsed_Time);
+        Time_Budget = min(Time_Budget, Elapsed_Time);
+        return false;
+    }
+    if (Stagnation_Threshold <= 0)
+        return Elapsed_Time < Time_Budget;
+
+    if (Elapsed_Time < Time_Budget)
+    {
+        if (!If_Search_Stagnated(Elapsed_Time, Time_Budget - Elapsed_Time))
+            return true;
+
+        if (Shared_Budget_Bank != NULL)
+            Shared_Budget_Bank->Deposit(Time_Budget - Elapsed_Time);
+        Time_Budget = Elapsed_Time;
+        return false;
+    }
+
+    if (Shared_Budget_Bank == NULL)
+        return false;
+
+    double Max_Borrow_Time = Max_Borrow_Ratio * Param_T * Virtual_City_Num;
+    if (If_Search_Stagnated(Elapsed_Time, Max_Borrow_Time))
+        return false;
+
+    double Borrowed_Time = Shared_Budget_Bank->Withdraw(Max_Borrow_Time);
+    if (Borrowed_Time <= 0)
+        return false;
+
+    Time_Budget = Elapsed_Time + Borrowed_Time;
+    return true;
+}
+
+#endif // TSP_TERMINATION_H
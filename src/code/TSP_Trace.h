@@ -0,0 +1,224 @@
+#ifndef TSP_TRACE_H
+#define TSP_TRACE_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "TSP_Termination.h"
+
+// Optional timeline of the solver phases, exported as Chrome trace JSON (open
+// it in chrome://tracing or ui.perfetto.dev). Each thread records into its own
+// ring buffer, so recording takes no lock, and the oldest events are
+// overwritten once the buffer is full. When tracing is off, a phase boundary
+// costs one relaxed atomic load
+
+#define Trace_Phase_Solve 0            // whole Solve_Instance
+#define Trace_Phase_Load_Input 1       // input copy and distance matrix
+#define Trace_Phase_Candidate_Set 2
+#define Trace_Phase_Initial_Solution 3
+#define Trace_Phase_Local_Search 4     // 2-opt descent
+#define Trace_Phase_Restart 5          // jump to a new state
+#define Trace_Phase_MCTS 6
+#define Trace_Phase_Simulation 7       // one MCTS iteration (simulation, back propagation, execution)
+#define Trace_Phase_Num 8
+
+const char *Trace_Phase_Name[Trace_Phase_Num] = {"Solve",        "Load_Input", "Candidate_Set", "Initial_Solution",
+                                                 "Local_Search", "Restart",    "MCTS",          "Simulation"};
+
+// One complete phase, with the state of the search when it ended
+struct Trace_Event
+{
+    long long Begin_Time; // nanoseconds since Trace_Epoch
+    long long End_Time;
+    int Phase;
+    int Instance;
+    int Restart;
+    double Best_Length; // negative if no tour was found yet
+};
+
+// Ring buffer written by one thread only: an event is stored first, then
+// published by incrementing Event_Num, so a concurrent export knows which
+// slots are complete
+struct Trace_Buffer
+{
+    vector<Trace_Event> Events;
+    std::atomic<unsigned long long> Event_Num{0}; // events recorded since the last reset
+    unsigned Generation = 0;
+    int Thread_Index = 0;
+    bool If_Owner_Alive = true;
+};
+
+std::atomic<bool> If_Trace_Enabled(false);
+std::atomic<unsigned> Trace_Generation(0); // bumped by each Start_Trace, which discards the older events
+std::atomic<int> Trace_Instance_Counter(0);
+std::chrono::steady_clock::time_point Trace_Epoch = std::chrono::steady_clock::now();
+
+// Buffers of all the threads that recorded events, guarded by Trace_Mutex
+std::mutex Trace_Mutex;
+vector<std::unique_ptr<Trace_Buffer>> Trace_Buffers;
+size_t Trace_Capacity = 1 << 16;
+int Trace_Thread_Counter = 0;
+
+// Keep the buffer of a thread for the export after the thread exits
+struct Trace_Buffer_Owner
+{
+    Trace_Buffer *Buffer = NULL;
+
+    ~Trace_Buffer_Owner()
+    {
+        if (Buffer == NULL)
+            return;
+        std::lock_guard<std::mutex> Lock(Trace_Mutex);
+        Buffer->If_Owner_Alive = false;
+    }
+};
+
+thread_local Trace_Buffer_Owner Thread_Trace;
+thread_local long long Trace_Phase_Begin[Trace_Phase_Num] = {-1, -1, -1, -1, -1, -1, -1, -1};
+thread_local int Trace_Instance_Id = Null;
+thread_local double Trace_Length_Scale = 1;
+
+long long Get_Trace_Time()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Trace_Epoch)
+        .count();
+}
+
+// Buffer of the calling thread for the current generation, created or reset
+// on the first event of the generation
+Trace_Buffer *Get_Thread_Trace_Buffer()
+{
+    unsigned Generation = Trace_Generation.load(std::memory_order_acquire);
+    Trace_Buffer *Buffer = Thread_Trace.Buffer;
+    if (Buffer != NULL && Buffer->Generation == Generation)
+        return Buffer;
+
+    std::lock_guard<std::mutex> Lock(Trace_Mutex);
+    if (Buffer == NULL)
+    {
+        Trace_Buffers.emplace_back(new Trace_Buffer());
+        Buffer = Thread_Trace.Buffer = Trace_Buffers.back().get();
+        Buffer->Thread_Index = Trace_Thread_Counter++;
+    }
+    Buffer->Events.assign(Trace_Capacity, Trace_Event());
+    Buffer->Event_Num.store(0, std::memory_order_relaxed);
+    Buffer->Generation = Generation;
+    return Buffer;
+}
+
+void Record_Trace_Event(int Phase, long long Begin_Time)
+{
+    Trace_Buffer *Buffer = Get_Thread_Trace_Buffer();
+    unsigned long long Event_Num = Buffer->Event_Num.load(std::memory_order_relaxed);
+    Trace_Event &Event = Buffer->Events[Event_Num % Buffer->Events.size()];
+    Event.Begin_Time = Begin_Time;
+    Event.End_Time = Get_Trace_Time();
+    Event.Phase = Phase;
+    Event.Instance = Trace_Instance_Id;
+    Event.Restart = Restart_Num;
+    Event.Best_Length =
+        Current_Instance_Best_Distance >= Inf_Cost ? -1 : Current_Instance_Best_Distance / Trace_Length_Scale;
+    Buffer->Event_Num.store(Event_Num + 1, std::memory_order_release);
+}
+
+inline void Trace_Begin(int Phase)
+{
+    if (If_Trace_Enabled.load(std::memory_order_relaxed))
+        Trace_Phase_Begin[Phase] = Get_Trace_Time();
+}
+
+inline void Trace_End(int Phase)
+{
+    if (!If_Trace_Enabled.load(std::memory_order_relaxed) || Trace_Phase_Begin[Phase] < 0)
+        return;
+    Record_Trace_Event(Phase, Trace_Phase_Begin[Phase]);
+    Trace_Phase_Begin[Phase] = -1;
+}
+
+// Tag the following events of the calling thread with a new instance id
+void Trace_Begin_Instance(double Length_Scale)
+{
+    Trace_Instance_Id = Trace_Instance_Counter++;
+    Trace_Length_Scale = Length_Scale;
+    Trace_Begin(Trace_Phase_Solve);
+}
+
+// Discard the recorded events and record the following ones, at most
+// Capacity per thread. The buffers of the threads that exited are freed
+void Start_Trace(size_t Capacity)
+{
+    std::lock_guard<std::mutex> Lock(Trace_Mutex);
+    Trace_Capacity = max(Capacity, (size_t)1);
+    size_t Kept_Num = 0;
+    for (size_t i = 0; i < Trace_Buffers.size(); i++)
+        if (Trace_Buffers[i]->If_Owner_Alive)
+            std::swap(Trace_Buffers[Kept_Num++], Trace_Buffers[i]);
+    Trace_Buffers.resize(Kept_Num);
+    Trace_Generation++;
+    If_Trace_Enabled = true;
+}
+
+void Stop_Trace()
+{
+    If_Trace_Enabled = false;
+}
+
+// Write the events of the current generation to Path as Chrome trace JSON.
+// Threads may keep recording meanwhile, the slots they could be overwriting
+// are skipped. Return the number of events written, Null if the file could
+// not be written
+int Export_Trace(const std::string &Path)
+{
+    FILE *File = fopen(Path.c_str(), "w");
+    if (File == NULL)
+        return Null;
+
+    std::lock_guard<std::mutex> Lock(Trace_Mutex);
+    unsigned Generation = Trace_Generation.load(std::memory_order_acquire);
+    fprintf(File, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    int Written_Num = 0;
+    bool If_First_Event = true;
+    vector<Trace_Event> Events;
+    for (auto &Buffer : Trace_Buffers)
+    {
+        if (Buffer->Generation != Generation)
+            continue;
+
+        size_t Capacity = Buffer->Events.size();
+        unsigned long long End = Buffer->Event_Num.load(std::memory_order_acquire);
+        unsigned long long Begin = End > Capacity ? End - Capacity : 0;
+        Events.clear();
+        for (unsigned long long i = Begin; i < End; i++)
+            Events.push_back(Buffer->Events[i % Capacity]);
+        // The owner may have wrapped around while the events were copied
+        unsigned long long Last_End = Buffer->Event_Num.load(std::memory_order_acquire);
+        unsigned long long Safe_Begin = Last_End >= Capacity ? Last_End - Capacity + 1 : 0;
+
+        fprintf(File,
+                "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"solver %d\"}}",
+                If_First_Event ? "" : ",\n", Buffer->Thread_Index, Buffer->Thread_Index);
+        If_First_Event = false;
+        for (unsigned long long i = max(Begin, Safe_Begin); i < End; i++)
+        {
+            Trace_Event &Event = Events[i - Begin];
+            fprintf(File,
+                    ",\n{\"name\":\"%s\",\"cat\":\"solver\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,"
+                    "\"args\":{\"instance\":%d,\"restart\":%d",
+                    Trace_Phase_Name[Event.Phase], Buffer->Thread_Index, Event.Begin_Time / 1e3,
+                    (Event.End_Time - Event.Begin_Time) / 1e3, Event.Instance, Event.Restart);
+            if (Event.Best_Length >= 0)
+                fprintf(File, ",\"best_length\":%.6f", Event.Best_Length);
+            fprintf(File, "}}");
+            Written_Num++;
+        }
+    }
+    fprintf(File, "]}\n");
+
+    bool If_Written = ferror(File) == 0;
+    If_Written = (fclose(File) == 0) && If_Written;
+    return If_Written ? Written_Num : Null;
+}
+
+#endif // TSP_TRACE_H
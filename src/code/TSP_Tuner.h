@@ -0,0 +1,162 @@
+#ifndef TSP_TUNER_H
+#define TSP_TUNER_H
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+
+#include "TSP_Solver.h"
+
+// One row of the quality-versus-time table of a tuning run: the mean result
+// of a configuration over the sample instances at one rung of the budget
+struct Tuning_Record
+{
+    int Config;
+    int Round;
+    double Param_T;
+    double Mean_Distance;
+    double Mean_Gap;
+    double Mean_Time;
+    double Score; // mean ratio to the best distance found at this rung, per instance
+};
+
+// Successive halving over the configurations Configs, evaluated on
+// Instance_Num sample instances of N cities (row-major inputs, as in
+// Solve_Instance, stored one after the other). Round r runs every surviving
+// configuration with Param_T = Min_Param_T * Eta^r and keeps the best
+// ceil(n / Eta) of them by Score, until one remains. The coordinate-derived
+// structures of each instance are built once and shared by all runs. Return
+// the index of the best configuration, the table is stored in Records
+template <typename Metric>
+int Tune_By_Successive_Halving(int N, const vector<Search_Param> &Configs, const typename Metric::Input_Type *Inputs,
+                               const int *Opt_Tours, const double *Heatmaps, int Instance_Num, double Min_Param_T,
+                               int Eta, int Thread_Num, vector<Tuning_Record> &Records)
+{
+    int Config_Num = (int)Configs.size();
+    if (Config_Num == 0 || Instance_Num == 0)
+        return Null;
+    Eta = max(Eta, 2);
+    if (Thread_Num <= 0)
+        Thread_Num = max(1u, std::thread::hardware_concurrency());
+
+    // The candidate sets are built for the largest Max_Candidate_Num, a
+    // configuration with fewer candidates uses their nearest prefix
+    Search_Param Build_Param = Configs[0];
+    for (auto &Config : Configs)
+        Build_Param.Max_Candidate_Num = max(Build_Param.Max_Candidate_Num, Config.Max_Candidate_Num);
+    size_t Input_Size = Metric::Dim == 0 ? (size_t)N * N : (size_t)N * Metric::Dim;
+    vector<std::unique_ptr<Shared_Instance>> Instances;
+    for (int i = 0; i < Instance_Num; i++)
+    {
+        Instances.emplace_back(new Shared_Instance());
+        Instances.back()->Build<Metric>(N, Build_Param, Inputs + i * Input_Size);
+    }
+
+    vector<int> Alive_Config(Config_Num);
+    for (int i = 0; i < Config_Num; i++)
+        Alive_Config[i] = i;
+
+    double Param_T = Min_Param_T;
+    for (int Round = 0; Alive_Config.size() > 1; Round++, Param_T *= Eta)
+    {
+        int Alive_Num = (int)Alive_Config.size();
+        int Job_Num = Alive_Num * Instance_Num;
+        vector<TSP_Output> Outputs(Job_Num);
+        vector<std::exception_ptr> Errors(Job_Num);
+        std::atomic<int> Next_Job(0);
+        auto Worker = [&]() {
+            while (true)
+            {
+                int Job = Next_Job++;
+                if (Job >= Job_Num)
+                    break;
+
+                int Instance = Job % Instance_Num;
+                Search_Param Param = Configs[Alive_Config[Job / Instance_Num]];
+                Param.Param_T = Param_T;
+                try
+                {
+                    Outputs[Job] = Solve_Instance<Metric>(N, Param, NULL, Opt_Tours + (size_t)Instance * N,
+                                                          Heatmaps + (size_t)Instance * N * N,
+                                                          Instances[Instance].get());
+                }
+                catch (...)
+                {
+                    Errors[Job] = std::current_exception();
+                }
+            }
+        };
+
+        vector<std::thread> Workers;
+        for (int i = 0; i < min(Thread_Num, Job_Num); i++)
+            Workers.emplace_back(Worker);
+        for (auto &Cur_Worker : Workers)
+            Cur_Worker.join();
+        for (auto &Error : Errors)
+            if (Error)
+                std::rethrow_exception(Error);
+
+        // Normalize by the best distance of each instance, so that large
+        // instances do not dominate the score
+        vector<double> Best_Distance(Instance_Num, Inf_Cost);
+        for (int Job = 0; Job < Job_Num; Job++)
+            Best_Distance[Job % Instance_Num] = min(Best_Distance[Job % Instance_Num], Outputs[Job].MCTS_Distance);
+
+        vector<std::pair<double, int>> Ranking;
+        for (int i = 0; i < Alive_Num; i++)
+        {
+            Tuning_Record Record = {Alive_Config[i], Round, Param_T, 0, 0, 0, 0};
+            for (int Instance = 0; Instance < Instance_Num; Instance++)
+            {
+                TSP_Output &Output = Outputs[i * Instance_Num + Instance];
+                Record.Mean_Distance += Output.MCTS_Distance / Instance_Num;
+                Record.Mean_Gap += Output.Gap / Instance_Num;
+                Record.Mean_Time += Output.Time / Instance_Num;
+                Record.Score += Output.MCTS_Distance / max(Best_Distance[Instance], 1e-12) / Instance_Num;
+            }
+            Records.push_back(Record);
+            Ranking.push_back(std::make_pair(Record.Score, Alive_Config[i]));
+        }
+
+        sort(Ranking.begin(), Ranking.end());
+        Alive_Config.clear();
+        for (int i = 0; i < (Alive_Num + Eta - 1) / Eta; i++)
+            Alive_Config.push_back(Ranking[i].second);
+    }
+
+    return Alive_Config[0];
+}
+
+// Dispatch a tuning run to the metric policy chosen at run time, as
+// Solve_Instance_By_Metric does for a single solve
+int Tune_By_Successive_Halving_By_Metric(int Metric_Id, int N, const vector<Search_Param> &Configs,
+                                         const double *Coordinates, const int *Distance_Matrices,
+                                         const int *Opt_Tours, const double *Heatmaps, int Instance_Num,
+                                         double Min_Param_T, int Eta, int Thread_Num, vector<Tuning_Record> &Records)
+{
+    switch (Metric_Id)
+    {
+    case Metric_Id_EUC_3D:
+        return Tune_By_Successive_Halving<Metric_EUC_3D>(N, Configs, Coordinates, Opt_Tours, Heatmaps, Instance_Num,
+                                                         Min_Param_T, Eta, Thread_Num, Records);
+    case Metric_Id_CEIL_2D:
+        return Tune_By_Successive_Halving<Metric_CEIL_2D>(N, Configs, Coordinates, Opt_Tours, Heatmaps, Instance_Num,
+                                                          Min_Param_T, Eta, Thread_Num, Records);
+    case Metric_Id_GEO:
+        return Tune_By_Successive_Halving<Metric_GEO>(N, Configs, Coordinates, Opt_Tours, Heatmaps, Instance_Num,
+                                                      Min_Param_T, Eta, Thread_Num, Records);
+    case Metric_Id_ATT:
+        return Tune_By_Successive_Halving<Metric_ATT>(N, Configs, Coordinates, Opt_Tours, Heatmaps, Instance_Num,
+                                                      Min_Param_T, Eta, Thread_Num, Records);
+    case Metric_Id_Explicit:
+        return Tune_By_Successive_Halving<Metric_Explicit>(N, Configs, Distance_Matrices, Opt_Tours, Heatmaps,
+                                                           Instance_Num, Min_Param_T, Eta, Thread_Num, Records);
+    default:
+        return Tune_By_Successive_Halving<Metric_EUC_2D>(N, Configs, Coordinates, Opt_Tours, Heatmaps, Instance_Num,
+                                                         Min_Param_T, Eta, Thread_Num, Records);
+    }
+}
+
+#endif // TSP_TUNER_H
@@ -2,7 +2,12 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
-#include "TSP_Markov_Decision.h"
+#include "TSP_C_API.h"
+#include "TSP_Decomposition.h"
+#include "TSP_Dynamic.h"
+#include "TSP_Ensemble.h"
+#include "TSP_Solver_Pool.h"
+#include "TSP_Tuner.h"
 
 namespace py = pybind11;
 
@@ -13,189 +18,777 @@ struct TSP_Result
     double Gap;
     double Time;
     double Overall_Time;
-    py::list Solution;
-    py::list Length_Time;
+    py::array_t<int> Solution;     // tour as a contiguous int32 array of shape (N,)
+    py::array_t<double> Length_Time; // (length, time) records as an array of shape (M, 2)
+    py::array_t<int> Learned_Weight_City; // heaviest edges of each city, shape (N, K), -1 padded (K = 0 unless exported)
+    py::array_t<float> Learned_Weight;    // their weights, shape (N, K)
+    double Lower_Bound = -1;   // Held-Karp lower bound, -1 unless computed
+    double Certified_Gap = -1; // gap of the tour to Lower_Bound, -1 unless computed
 };
 
-TSP_Result solve(int city_num, double alpha, double beta, double param_h, double param_t, int max_candidate_num,
-                 int candidate_use_heatmap, int max_depth, py::array_t<double> coordinates,
-                 py::array_t<int> opt_solution, py::array_t<double> heatmap, bool log_len_time, bool debug)
+// Hand the buffer of a std::vector over to numpy without copying, the capsule
+// frees the vector when the array is garbage collected
+template <typename T> py::array_t<T> Move_To_Numpy(std::vector<T> &&Data, std::vector<py::ssize_t> Shape)
 {
-    auto Overall_Start = std::chrono::steady_clock::now();
-    srand(Random_Seed);
-
-    // Initialize parameters
-    Temp_City_Num = city_num;
-    Alpha = alpha;
-    Beta = beta;
-    Param_H = param_h;
-    Param_T = param_t;
-    Max_Candidate_Num = max_candidate_num;
-    Candidate_Use_Heatmap = candidate_use_heatmap;
-    Max_Depth = max_depth;
-    Log_Length_Time = log_len_time;
-    MCTS_Debug = debug;
+    auto *Owner = new std::vector<T>(std::move(Data));
+    py::capsule Free_When_Done(Owner, [](void *p) { delete reinterpret_cast<std::vector<T> *>(p); });
+    return py::array_t<T>(Shape, Owner->data(), Free_When_Done);
+}
 
-    if (debug)
-    {
-        std::cout << "求解器创建，参数如下：" << std::endl;
-        std::cout << "Temp_City_Num: " << Temp_City_Num << std::endl;
-        std::cout << "Alpha: " << Alpha << std::endl;
-        std::cout << "Beta: " << Beta << std::endl;
-        std::cout << "Param_H: " << Param_H << std::endl;
-        std::cout << "Param_T: " << Param_T << std::endl;
-        std::cout << "Max_Candidate_Num: " << Max_Candidate_Num << std::endl;
-        std::cout << "Candidate_Use_Heatmap: " << Candidate_Use_Heatmap << std::endl;
-        std::cout << "Max_Depth: " << Max_Depth << std::endl;
-    }
-
-    City_Num = Temp_City_Num;
-    Start_City = 0;
-    Salesman_Num = 1;
-    Virtual_City_Num = City_Num + Salesman_Num - 1;
-
-    auto memory_start = std::chrono::steady_clock::now();
-    Allocate_Memory(Virtual_City_Num);
-    auto memory_end = std::chrono::steady_clock::now();
-    
-    // Assert that distances has the correct shape
-    auto coordinates_shape = coordinates.shape();
-    auto solution_shape = opt_solution.shape();
-    auto heatmap_shape = heatmap.shape();
-
-    // Size check and dimension check for numpy arrays
-    if (coordinates.ndim() != 2 || coordinates_shape[0] != Virtual_City_Num || coordinates_shape[1] != Coord_Dim)
+// Wrap the output of the core solver into numpy arrays (requires the GIL)
+TSP_Result Make_TSP_Result(TSP_Output &&Output)
+{
+    py::ssize_t Solution_Len = Output.Solution.size();
+    py::ssize_t Length_Time_Len = Output.Length_Time.size() / 2;
+    py::ssize_t Learned_Weight_Num = Output.Learned_Weight.K;
+    return TSP_Result{Output.Concorde_Distance,
+                      Output.MCTS_Distance,
+                      Output.Gap,
+                      Output.Time,
+                      Output.Overall_Time,
+                      Move_To_Numpy(std::move(Output.Solution), {Solution_Len}),
+                      Move_To_Numpy(std::move(Output.Length_Time), {Length_Time_Len, 2}),
+                      Move_To_Numpy(std::move(Output.Learned_Weight.City), {Solution_Len, Learned_Weight_Num}),
+                      Move_To_Numpy(std::move(Output.Learned_Weight.Weight), {Solution_Len, Learned_Weight_Num}),
+                      Output.Lower_Bound,
+                      Output.Certified_Gap};
+}
+
+// Read a result of the C interface into numpy arrays (requires the GIL)
+TSP_Result Make_TSP_Result(const mcts_tsp_result *Result)
+{
+    int N = mcts_tsp_result_city_num(Result);
+    int Record_Num = mcts_tsp_result_length_time(Result, NULL, 0);
+    int K = mcts_tsp_result_learned_weight(Result, NULL, NULL, 0);
+    TSP_Result Output{mcts_tsp_result_concorde_distance(Result),
+                      mcts_tsp_result_mcts_distance(Result),
+                      mcts_tsp_result_gap(Result),
+                      mcts_tsp_result_time(Result),
+                      mcts_tsp_result_overall_time(Result),
+                      py::array_t<int>({(py::ssize_t)N}),
+                      py::array_t<double>({(py::ssize_t)Record_Num, (py::ssize_t)2}),
+                      py::array_t<int>({(py::ssize_t)N, (py::ssize_t)K}),
+                      py::array_t<float>({(py::ssize_t)N, (py::ssize_t)K}),
+                      mcts_tsp_result_lower_bound(Result),
+                      mcts_tsp_result_certified_gap(Result)};
+    mcts_tsp_result_tour(Result, Output.Solution.mutable_data(), N);
+    mcts_tsp_result_length_time(Result, Output.Length_Time.mutable_data(), Record_Num);
+    mcts_tsp_result_learned_weight(Result, Output.Learned_Weight_City.mutable_data(),
+                                   Output.Learned_Weight.mutable_data(), N * K);
+    return Output;
+}
+
+// Raise the error of a failed call to the C interface
+void Check_C_API_Status(int Status)
+{
+    if (Status != MCTS_TSP_OK)
+        throw std::runtime_error(mcts_tsp_last_error());
+}
+
+template <typename T> using Input_Array = py::array_t<T, py::array::c_style | py::array::forcecast>;
+
+// Size check and dimension check for numpy arrays. Input holds Input_Dim
+// values per city: coordinates, or a row of the explicit distance matrix
+void Check_Input_Shape(int N, int Input_Dim, bool If_Explicit, const py::array &input,
+                       const py::array &opt_solution, const py::array &heatmap)
+{
+    if (input.ndim() != 2 || input.shape(0) != N || input.shape(1) != Input_Dim)
     {
+        if (If_Explicit)
+            throw std::runtime_error("Invalid distance matrix shape or dimensions");
         throw std::runtime_error("Invalid coordinates array shape or dimensions");
     }
 
-    if (opt_solution.ndim() != 1 || solution_shape[0] != Virtual_City_Num)
+    if (opt_solution.ndim() != 1 || opt_solution.shape(0) != N)
     {
         throw std::runtime_error("Invalid solution array shape or dimensions");
     }
 
-    if (heatmap.ndim() != 2 || heatmap_shape[0] != Virtual_City_Num || heatmap_shape[1] != Virtual_City_Num)
+    if (heatmap.ndim() != 2 || heatmap.shape(0) != N || heatmap.shape(1) != N)
     {
         throw std::runtime_error("Invalid heatmap array shape or dimensions");
     }
+}
+
+// Keep a dense heatmap in its own format if it is float16 or uint8 (see
+// Heatmap_Format in TSP_IO.h), convert it to float64 otherwise. Return the
+// C-contiguous array handed to the solver and set Format to the name of its
+// format
+py::array Get_Heatmap_Input(const py::array &heatmap, std::string &Format)
+{
+    py::dtype Type = heatmap.dtype();
+    py::array Heatmap;
+    if (Type.kind() == 'u' && Type.itemsize() == 1)
+        Format = "uint8";
+    else if (Type.kind() == 'f' && Type.itemsize() == 2)
+        Format = "float16";
+    else
+        Format = "float64";
+    if (Format == "float64")
+        Heatmap = Input_Array<double>::ensure(heatmap);
+    else
+        Heatmap = py::array::ensure(heatmap, py::array::c_style);
+    if (!Heatmap)
+        throw std::runtime_error("Invalid heatmap array");
+    return Heatmap;
+}
+
+Search_Param Make_Search_Param(double alpha, double beta, double param_h, double param_t, int max_candidate_num,
+                               int candidate_use_heatmap, int max_depth, bool log_len_time, bool debug,
+                               int restart_policy, int kick_segment_len, int mcts_patience,
+                               double stagnation_threshold, const std::string &init_method,
+                               bool focused_sampling, const std::string &checkpoint_path,
+                               double checkpoint_interval, const std::string &resume_path)
+{
+    int Init_Method_Id = Get_Init_Method_Id(init_method);
+    if (Init_Method_Id == Null)
+        throw std::runtime_error("Unknown init_method " + init_method);
+
+    return Search_Param{alpha,
+                        beta,
+                        param_h,
+                        param_t,
+                        max_candidate_num,
+                        candidate_use_heatmap,
+                        max_depth,
+                        restart_policy,
+                        kick_segment_len,
+                        Init_Method_Id,
+                        focused_sampling,
+                        mcts_patience,
+                        stagnation_threshold,
+                        log_len_time,
+                        debug,
+                        checkpoint_path,
+                        checkpoint_interval,
+                        resume_path};
+}
+
+// Solve one instance under the metric policy Metric (see TSP_Metric.h). The
+// input array holds the coordinates of shape (N, Metric::Dim), or the integer
+// distance matrix of shape (N, N) for Metric_Explicit
+template <typename Metric>
+TSP_Result Solve_With_Metric(int city_num, double alpha, double beta, double param_h, double param_t,
+                             int max_candidate_num, int candidate_use_heatmap, int max_depth,
+                             Input_Array<typename Metric::Input_Type> input, Input_Array<int> opt_solution,
+                             py::array heatmap, bool log_len_time, bool debug, int restart_policy,
+                             int kick_segment_len, int mcts_patience, double stagnation_threshold,
+                             const std::string &init_method, bool focused_sampling,
+                             const std::string &checkpoint_path, double checkpoint_interval,
+                             const std::string &resume_path, int export_weight_num,
+                             std::optional<Input_Array<int>> prior_weight_city,
+                             std::optional<Input_Array<float>> prior_weight, bool compute_lower_bound,
+                             double target_gap, const std::string &renumber, double heatmap_scale,
+                             int island_num, int elite_pool_size)
+{
+    Check_Input_Shape(city_num, Metric::Dim == 0 ? city_num : Metric::Dim, Metric::Dim == 0, input, opt_solution,
+                      heatmap);
+    std::unique_ptr<mcts_tsp_solver, decltype(&mcts_tsp_solver_destroy)> Solver(mcts_tsp_solver_create(),
+                                                                                &mcts_tsp_solver_destroy);
+    if (Solver == NULL)
+        throw std::bad_alloc();
+    std::string Heatmap_Format;
+    py::array Heatmap = Get_Heatmap_Input(heatmap, Heatmap_Format);
+
+    // Every option goes through the setters of the C interface unchanged, as
+    // for any other client, so both paths reject the same invalid values
+    const std::pair<const char *, double> Params[] = {
+        {"alpha", alpha},
+        {"beta", beta},
+        {"param_h", param_h},
+        {"param_t", param_t},
+        {"max_candidate_num", max_candidate_num},
+        {"candidate_use_heatmap", candidate_use_heatmap},
+        {"max_depth", max_depth},
+        {"log_len_time", log_len_time},
+        {"debug", debug},
+        {"restart_policy", restart_policy},
+        {"kick_segment_len", kick_segment_len},
+        {"mcts_patience", mcts_patience},
+        {"stagnation_threshold", stagnation_threshold},
+        {"focused_sampling", focused_sampling},
+        {"checkpoint_interval", checkpoint_interval},
+        {"heatmap_scale", heatmap_scale},
+        {"island_num", island_num},
+        {"elite_pool_size", elite_pool_size},
+        {"export_weight_num", export_weight_num},
+        {"compute_lower_bound", compute_lower_bound},
+        {"target_gap", target_gap}};
+    for (auto &Param : Params)
+        Check_C_API_Status(mcts_tsp_solver_set_param(Solver.get(), Param.first, Param.second));
+    const std::pair<const char *, std::string> String_Params[] = {
+        {"metric", Get_Metric_Name(Get_Metric_Id<Metric>())},
+        {"init_method", init_method},
+        {"checkpoint_path", checkpoint_path},
+        {"resume_path", resume_path},
+        {"renumber", renumber},
+        {"heatmap_format", Heatmap_Format}};
+    for (auto &Param : String_Params)
+        Check_C_API_Status(mcts_tsp_solver_set_string_param(Solver.get(), Param.first, Param.second.c_str()));
+
+    if (prior_weight_city.has_value() != prior_weight.has_value())
+        throw std::runtime_error("prior_weight_city and prior_weight should be given together");
+    if (prior_weight_city.has_value())
+    {
+        auto &City = *prior_weight_city;
+        auto &Weight = *prior_weight;
+        if (City.ndim() != 2 || City.shape(0) != city_num || Weight.ndim() != 2 || Weight.shape(0) != city_num ||
+            Weight.shape(1) != City.shape(1))
+            throw std::runtime_error("Invalid prior weight array shape or dimensions");
+        Check_C_API_Status(mcts_tsp_solver_set_prior_weight(Solver.get(), city_num, (int)City.shape(1), City.data(),
+                                                            Weight.data()));
+    }
+
+    const double *Coordinates = NULL;
+    const int *Distance_Matrix = NULL;
+    if constexpr (Metric::Dim == 0)
+        Distance_Matrix = input.data();
+    else
+        Coordinates = input.data();
+
+    mcts_tsp_result *Result = NULL;
+    int Status;
+    {
+        py::gil_scoped_release release;
+        Status = mcts_tsp_solve(Solver.get(), city_num, Coordinates, Distance_Matrix, opt_solution.data(),
+                                Heatmap.data(), &Result);
+    }
+    Check_C_API_Status(Status);
+    std::unique_ptr<mcts_tsp_result, decltype(&mcts_tsp_result_destroy)> Owned_Result(Result,
+                                                                                    &mcts_tsp_result_destroy);
+    return Make_TSP_Result(Result);
+}
 
-    // Fill in the matrix
-    auto data_copy_start = std::chrono::steady_clock::now();
+// Solve a large EUC_2D instance by spatial decomposition (see
+// TSP_Decomposition.h), without allocating any O(N^2) structure for the whole
+// instance. Param_T controls the time budget of each window
+TSP_Result solve_decomposed(int city_num, double alpha, double beta, double param_h, double param_t,
+                            int max_candidate_num, int max_depth, Input_Array<double> coordinates,
+                            Input_Array<int> opt_solution, int window_size, int window_shift, int round_num,
+                            int num_threads, double time_limit, int kick_segment_len, bool debug)
+{
+    auto Overall_Start = std::chrono::steady_clock::now();
+    if (coordinates.ndim() != 2 || coordinates.shape(0) != city_num || coordinates.shape(1) != Coord_Dim)
+        throw std::runtime_error("Invalid coordinates array shape or dimensions");
+    if (opt_solution.ndim() != 1 || opt_solution.shape(0) != city_num)
+        throw std::runtime_error("Invalid solution array shape or dimensions");
+    if (window_size < 2 * max_depth + 2)
+        throw std::runtime_error("window_size should be at least 2 * max_depth + 2");
+    Search_Param Param =
+        Make_Search_Param(alpha, beta, param_h, param_t, max_candidate_num, 0, max_depth, false, false,
+                          Restart_Double_Bridge, kick_segment_len, 1, 0, "heatmap_sampling", false, "", 0, "");
+
+    vector<double> X(city_num), Y(city_num);
+    vector<int> Tour(city_num);
     auto coordinates_r = coordinates.unchecked<2>();
-    for (int i = 0; i < Virtual_City_Num; i++)
+    for (int i = 0; i < city_num; i++)
     {
-        Coordinate_X[i] = coordinates_r(i, 0) * Magnify_Rate;
-        Coordinate_Y[i] = coordinates_r(i, 1) * Magnify_Rate;
+        X[i] = coordinates_r(i, 0);
+        Y[i] = coordinates_r(i, 1);
     }
 
-    auto solution_r = opt_solution.unchecked<1>();
-    for (int i = 0; i < Virtual_City_Num; i++)
+    TSP_Output Output;
+    vector<std::pair<double, double>> Round_Length_Time;
     {
-        Opt_Solution[i] = solution_r(i);
+        py::gil_scoped_release release;
+
+        auto Begin_Time = std::chrono::steady_clock::now();
+        Output.MCTS_Distance = Solve_By_Decomposition(city_num, X.data(), Y.data(), Tour.data(), Param, window_size,
+                                                      window_shift, round_num, num_threads, time_limit,
+                                                      Round_Length_Time);
+        Output.Time = Get_Elapsed_Time(Begin_Time);
+        Output.Concorde_Distance = Get_Tour_Double_Distance(city_num, opt_solution.data(), X.data(), Y.data());
+        Output.Gap = (Output.MCTS_Distance - Output.Concorde_Distance) / Output.Concorde_Distance;
     }
 
-    auto heatmap_r = heatmap.unchecked<2>();
-    for (int i = 0; i < Virtual_City_Num; i++)
+    if (debug)
     {
-        for (int j = 0; j < Virtual_City_Num; j++)
-        {
-            Edge_Heatmap[i][j] = heatmap_r(i, j);
-        }
+        for (auto &pair : Round_Length_Time)
+            std::cout << "Length: " << pair.first << " Time: " << pair.second << std::endl;
     }
-    auto data_copy_end = std::chrono::steady_clock::now();
 
-    py::gil_scoped_release release;
+    for (auto &pair : Round_Length_Time)
+    {
+        Output.Length_Time.push_back(pair.first);
+        Output.Length_Time.push_back(pair.second);
+    }
+    Output.Solution = std::move(Tour);
+    Output.Overall_Time = Get_Elapsed_Time(Overall_Start);
 
-    auto dist_calc_start = std::chrono::steady_clock::now();
-    Calculate_All_Pair_Distance();
-    auto dist_calc_end = std::chrono::steady_clock::now();
-    
-    for (int i = 0; i < City_Num; i++)
+    return Make_TSP_Result(std::move(Output));
+}
+
+// Result of an ensemble: the best member and the statistics of every member
+struct TSP_Ensemble_Result
+{
+    int Best_Index;
+    TSP_Result Best;
+    py::array_t<double> MCTS_Distances; // shape (S,)
+    py::array_t<double> Gaps;
+    py::array_t<double> Times;
+    double Overall_Time; // including the shared precomputation
+};
+
+// Solve one instance once per heatmap of heatmaps (S, N, N), sharing the
+// coordinate-derived structures between the members (see TSP_Ensemble.h)
+TSP_Ensemble_Result solve_ensemble(int city_num, double alpha, double beta, double param_h, double param_t,
+                                   int max_candidate_num, int candidate_use_heatmap, int max_depth,
+                                   py::array coordinates, Input_Array<int> opt_solution, Input_Array<double> heatmaps,
+                                   bool log_len_time, bool debug, int restart_policy, int kick_segment_len,
+                                   int mcts_patience, double stagnation_threshold, const std::string &init_method,
+                                   bool focused_sampling, int num_threads, const std::string &metric)
+{
+    auto Overall_Start = std::chrono::steady_clock::now();
+    int Metric_Id = Get_Metric_Id(metric);
+    if (Metric_Id == Null)
+        throw std::runtime_error("Unknown metric " + metric);
+    if (heatmaps.ndim() != 3 || heatmaps.shape(0) < 1 || heatmaps.shape(1) != city_num ||
+        heatmaps.shape(2) != city_num)
+        throw std::runtime_error("Invalid heatmaps array shape or dimensions");
+    Check_Input_Shape(city_num, Get_Metric_Input_Dim(Metric_Id, city_num), Metric_Id == Metric_Id_Explicit,
+                      coordinates, opt_solution, heatmaps[py::int_(0)].cast<py::array>());
+    int Heatmap_Num = (int)heatmaps.shape(0);
+
+    Search_Param Param = Make_Search_Param(alpha, beta, param_h, param_t, max_candidate_num, candidate_use_heatmap,
+                                           max_depth, log_len_time, debug, restart_policy, kick_segment_len,
+                                           mcts_patience, stagnation_threshold, init_method, focused_sampling, "",
+                                           0, "");
+    Input_Array<double> Coordinates;
+    Input_Array<int> Distance_Matrix;
+    if (Metric_Id == Metric_Id_Explicit)
+        Distance_Matrix = Input_Array<int>::ensure(coordinates);
+    else
+        Coordinates = Input_Array<double>::ensure(coordinates);
+
+    vector<TSP_Output> Outputs;
     {
-        for (int j = i + 1; j < City_Num; j++)
-        {
-            Edge_Heatmap[i][j] = (Edge_Heatmap[i][j] + Edge_Heatmap[j][i]) / 2;
-            Edge_Heatmap[j][i] = Edge_Heatmap[i][j];
-        }
+        py::gil_scoped_release release;
+        Outputs = Solve_Ensemble_By_Metric(Metric_Id, city_num, Param,
+                                           Metric_Id == Metric_Id_Explicit ? NULL : Coordinates.data(),
+                                           Metric_Id == Metric_Id_Explicit ? Distance_Matrix.data() : NULL,
+                                           opt_solution.data(), heatmaps.data(), Heatmap_Num, num_threads);
+    }
+
+    TSP_Ensemble_Result Result;
+    vector<double> MCTS_Distances, Gaps, Times;
+    Result.Best_Index = 0;
+    for (int i = 0; i < Heatmap_Num; i++)
+    {
+        MCTS_Distances.push_back(Outputs[i].MCTS_Distance);
+        Gaps.push_back(Outputs[i].Gap);
+        Times.push_back(Outputs[i].Time);
+        if (Outputs[i].MCTS_Distance < Outputs[Result.Best_Index].MCTS_Distance)
+            Result.Best_Index = i;
     }
+    Result.Best = Make_TSP_Result(std::move(Outputs[Result.Best_Index]));
+    Result.MCTS_Distances = Move_To_Numpy(std::move(MCTS_Distances), {Heatmap_Num});
+    Result.Gaps = Move_To_Numpy(std::move(Gaps), {Heatmap_Num});
+    Result.Times = Move_To_Numpy(std::move(Times), {Heatmap_Num});
+    Result.Overall_Time = Get_Elapsed_Time(Overall_Start);
+
+    return Result;
+}
 
-    Current_Instance_Begin_Time = std::chrono::steady_clock::now();
-    Current_Instance_Best_Distance = Inf_Cost;
+// Result of a tuning run: the index of the best configuration and the
+// quality-versus-time table, one row per configuration and round
+struct TSP_Tuning_Result
+{
+    int Best_Config;
+    py::array_t<int> Config;
+    py::array_t<int> Round;
+    py::array_t<double> Param_T;
+    py::array_t<double> Mean_Distance;
+    py::array_t<double> Mean_Gap;
+    py::array_t<double> Mean_Time;
+    py::array_t<double> Score;
+};
+
+// Tune Alpha, Beta, Param_H, Max_Depth and Max_Candidate_Num by successive
+// halving (see TSP_Tuner.h). Configuration i is (alphas[i], betas[i], ...),
+// the sample instances are stacked along the first axis of coordinates,
+// opt_solutions and heatmaps
+TSP_Tuning_Result tune(int city_num, Input_Array<double> alphas, Input_Array<double> betas,
+                       Input_Array<double> param_hs, Input_Array<int> max_depths, Input_Array<int> max_candidate_nums,
+                       py::array coordinates, Input_Array<int> opt_solutions, Input_Array<double> heatmaps,
+                       int candidate_use_heatmap, double min_param_t, int eta, int restart_policy,
+                       int kick_segment_len, const std::string &init_method, bool focused_sampling,
+                       int num_threads, const std::string &metric)
+{
+    int Metric_Id = Get_Metric_Id(metric);
+    if (Metric_Id == Null)
+        throw std::runtime_error("Unknown metric " + metric);
+    py::ssize_t Config_Num = alphas.size();
+    if (betas.size() != Config_Num || param_hs.size() != Config_Num || max_depths.size() != Config_Num ||
+        max_candidate_nums.size() != Config_Num)
+        throw std::runtime_error("The parameter arrays should have the same length");
+    int Input_Dim = Get_Metric_Input_Dim(Metric_Id, city_num);
+    if (coordinates.ndim() != 3 || coordinates.shape(1) != city_num || coordinates.shape(2) != Input_Dim)
+        throw std::runtime_error("Invalid coordinates array shape or dimensions");
+    int Instance_Num = (int)coordinates.shape(0);
+    if (opt_solutions.ndim() != 2 || opt_solutions.shape(0) != Instance_Num || opt_solutions.shape(1) != city_num)
+        throw std::runtime_error("Invalid solution array shape or dimensions");
+    if (heatmaps.ndim() != 3 || heatmaps.shape(0) != Instance_Num || heatmaps.shape(1) != city_num ||
+        heatmaps.shape(2) != city_num)
+        throw std::runtime_error("Invalid heatmaps array shape or dimensions");
 
-    auto candidate_start = std::chrono::steady_clock::now();
-    Identify_Candidate_Set();
-    auto candidate_end = std::chrono::steady_clock::now();
+    vector<Search_Param> Configs;
+    for (py::ssize_t i = 0; i < Config_Num; i++)
+    {
+        if (2 * max_depths.at(i) > city_num)
+            throw std::runtime_error("max_depth should be less than city_num/2");
+        Configs.push_back(Make_Search_Param(alphas.at(i), betas.at(i), param_hs.at(i), min_param_t,
+                                            max_candidate_nums.at(i), candidate_use_heatmap, max_depths.at(i),
+                                            false, false, restart_policy, kick_segment_len, 1, 0, init_method,
+                                            focused_sampling, "", 0, ""));
+    }
 
-    auto mdp_start = std::chrono::steady_clock::now();
-    Markov_Decision_Process();
-    auto mdp_end = std::chrono::steady_clock::now();
+    Input_Array<double> Coordinates;
+    Input_Array<int> Distance_Matrices;
+    if (Metric_Id == Metric_Id_Explicit)
+        Distance_Matrices = Input_Array<int>::ensure(coordinates);
+    else
+        Coordinates = Input_Array<double>::ensure(coordinates);
 
-    double Stored_Solution_Double_Distance = Get_Stored_Solution_Double_Distance();
-    double Current_Solution_Double_Distance = Get_Current_Solution_Double_Distance();
-    double Concorde_Distance = Stored_Solution_Double_Distance / Magnify_Rate;
-    double MCTS_Distance = Current_Solution_Double_Distance / Magnify_Rate;
-    double Gap = (Current_Solution_Double_Distance - Stored_Solution_Double_Distance) / Stored_Solution_Double_Distance;
-    double Time = Get_Elapsed_Time(Current_Instance_Begin_Time);
-    double Overall_Time = Get_Elapsed_Time(Overall_Start);
+    int Best_Config;
+    vector<Tuning_Record> Records;
+    {
+        py::gil_scoped_release release;
+        Best_Config = Tune_By_Successive_Halving_By_Metric(
+            Metric_Id, city_num, Configs, Metric_Id == Metric_Id_Explicit ? NULL : Coordinates.data(),
+            Metric_Id == Metric_Id_Explicit ? Distance_Matrices.data() : NULL, opt_solutions.data(), heatmaps.data(),
+            Instance_Num, min_param_t, eta, num_threads, Records);
+    }
 
-    vector<int> Solution;
-    int Cur_City = Start_City;
-    do
+    vector<int> Config, Round;
+    vector<double> Param_T, Mean_Distance, Mean_Gap, Mean_Time, Score;
+    for (auto &Record : Records)
     {
-        Solution.push_back(Cur_City);
-        Cur_City = All_Node[Cur_City].Next_City;
-    } while (Cur_City != Null && Cur_City != Start_City);
+        Config.push_back(Record.Config);
+        Round.push_back(Record.Round);
+        Param_T.push_back(Record.Param_T);
+        Mean_Distance.push_back(Record.Mean_Distance);
+        Mean_Gap.push_back(Record.Mean_Gap);
+        Mean_Time.push_back(Record.Mean_Time);
+        Score.push_back(Record.Score);
+    }
+    py::ssize_t Record_Num = Records.size();
+    return TSP_Tuning_Result{Best_Config,
+                             Move_To_Numpy(std::move(Config), {Record_Num}),
+                             Move_To_Numpy(std::move(Round), {Record_Num}),
+                             Move_To_Numpy(std::move(Param_T), {Record_Num}),
+                             Move_To_Numpy(std::move(Mean_Distance), {Record_Num}),
+                             Move_To_Numpy(std::move(Mean_Gap), {Record_Num}),
+                             Move_To_Numpy(std::move(Mean_Time), {Record_Num}),
+                             Move_To_Numpy(std::move(Score), {Record_Num})};
+}
 
-    for (auto &pair : Length_Time)
+// Python handle of a job submitted to a SolverPool
+struct Solver_Future
+{
+    std::shared_ptr<Solve_Future_State> State;
+
+    bool done()
     {
-        pair.first /= Magnify_Rate;
+        std::lock_guard<std::mutex> Lock(State->Mutex);
+        return State->If_Done;
     }
 
-    if (debug)
+    // Wait (with the GIL released) for the job and return its TSP_Result
+    TSP_Result result(py::object timeout)
     {
-        std::cout << "求解完成，结果如下：" << std::endl;
-        std::cout << "Stored_Solution_Double_Distance: " << Stored_Solution_Double_Distance << std::endl;
-        std::cout << "Current_Solution_Double_Distance: " << Current_Solution_Double_Distance << std::endl;
-        std::cout << "Concorde_Distance: " << Concorde_Distance << std::endl;
-        std::cout << "MCTS_Distance: " << MCTS_Distance << std::endl;
-        std::cout << "Gap: " << Gap * 100 << "%" << std::endl;
-        std::cout << "Time: " << Time << " seconds" << std::endl;
-        std::cout << "Overall_Time: " << Overall_Time << " seconds" << std::endl;
-        
-        std::cout << "Solution: ";
-        for (int i = 0; i < Solution.size(); ++i)
+        bool If_Done;
         {
-            std::cout << Solution[i] << " ";
+            py::gil_scoped_release release;
+            If_Done = State->Wait(timeout.is_none() ? -1.0 : timeout.cast<double>());
         }
-        for (auto &pair : Length_Time)
+        if (!If_Done)
         {
-            std::cout << "Length: " << pair.first << " Time: " << pair.second << std::endl;
+            PyErr_SetString(PyExc_TimeoutError, "The solve did not finish within the timeout");
+            throw py::error_already_set();
         }
-        std::cout << std::endl;
-        
-        // Print timing for each part
-        std::cout << "--- Timing Breakdown ---" << std::endl;
-        std::cout << "Allocate_Memory: " << std::chrono::duration<double>(memory_end - memory_start).count() << " seconds" << std::endl;
-        std::cout << "Data Copy: " << std::chrono::duration<double>(data_copy_end - data_copy_start).count() << " seconds" << std::endl;
-        std::cout << "Calculate_All_Pair_Distance: " << std::chrono::duration<double>(dist_calc_end - dist_calc_start).count() << " seconds" << std::endl;
-        std::cout << "Identify_Candidate_Set: " << std::chrono::duration<double>(candidate_end - candidate_start).count() << " seconds" << std::endl;
-        std::cout << "Markov_Decision_Process: " << std::chrono::duration<double>(mdp_end - mdp_start).count() << " seconds" << std::endl;
+        if (!State->Error.empty())
+            throw std::runtime_error(State->Error);
+
+        // The output may be fetched several times, so hand a copy to numpy
+        TSP_Output Output = State->Output;
+        return Make_TSP_Result(std::move(Output));
+    }
+
+    // Call fn(future) once the job is finished, from the worker thread that
+    // finished it (or immediately if it already is)
+    void add_done_callback(py::function fn)
+    {
+        // The Python objects may be released by a worker thread, so take the
+        // GIL whenever they are destroyed or called
+        auto Callback = std::shared_ptr<py::function>(new py::function(std::move(fn)), [](py::function *f) {
+            py::gil_scoped_acquire acquire;
+            delete f;
+        });
+        auto Self = std::shared_ptr<Solver_Future>(new Solver_Future{State}, [](Solver_Future *f) { delete f; });
+        py::gil_scoped_release release;
+        State->Add_Done_Callback([Callback, Self]() {
+            py::gil_scoped_acquire acquire;
+            try
+            {
+                (*Callback)(*Self);
+            }
+            catch (py::error_already_set &e)
+            {
+                e.discard_as_unraisable(__func__);
+            }
+        });
+    }
+};
+
+// Copy one instance into a job and queue it (blocking while the queue is
+// full, with the GIL released)
+Solver_Future Submit_To_Pool(TSP_Solver_Pool &Pool, int city_num, double alpha, double beta, double param_h,
+                             double param_t, int max_candidate_num, int candidate_use_heatmap, int max_depth,
+                             py::array input, Input_Array<int> opt_solution, Input_Array<double> heatmap,
+                             bool log_len_time, bool debug, int restart_policy, int kick_segment_len,
+                             int mcts_patience, double stagnation_threshold, const std::string &init_method,
+                             bool focused_sampling, const std::string &checkpoint_path, double checkpoint_interval,
+                             const std::string &resume_path, const std::string &metric)
+{
+    int Metric_Id = Get_Metric_Id(metric);
+    if (Metric_Id == Null)
+        throw std::runtime_error("Unknown metric " + metric);
+    Check_Input_Shape(city_num, Get_Metric_Input_Dim(Metric_Id, city_num), Metric_Id == Metric_Id_Explicit, input,
+                      opt_solution, heatmap);
+
+    Solve_Job Job;
+    Job.Metric_Id = Metric_Id;
+    Job.N = city_num;
+    Job.Param = Make_Search_Param(alpha, beta, param_h, param_t, max_candidate_num, candidate_use_heatmap, max_depth,
+                                  log_len_time, debug, restart_policy, kick_segment_len, mcts_patience,
+                                  stagnation_threshold, init_method, focused_sampling, checkpoint_path,
+                                  checkpoint_interval, resume_path);
+    if (Metric_Id == Metric_Id_Explicit)
+    {
+        auto Matrix = Input_Array<int>::ensure(input);
+        Job.Distance_Matrix.assign(Matrix.data(), Matrix.data() + Matrix.size());
     }
+    else
+    {
+        auto Coordinates = Input_Array<double>::ensure(input);
+        Job.Coordinates.assign(Coordinates.data(), Coordinates.data() + Coordinates.size());
+    }
+    Job.Opt_Tour.assign(opt_solution.data(), opt_solution.data() + opt_solution.size());
+    Job.Heatmap.assign(heatmap.data(), heatmap.data() + heatmap.size());
 
-    Release_Memory(Virtual_City_Num);
+    py::gil_scoped_release release;
+    return Solver_Future{Pool.Submit(std::move(Job))};
+}
 
-    py::gil_scoped_acquire acquire;
+// Python handle of an EUC_2D instance kept alive between solves (see
+// TSP_Dynamic.h). It is not meant to be used by two threads at once
+typedef Dynamic_Instance<Metric_EUC_2D> Live_Solver;
 
-    return TSP_Result{Concorde_Distance,  MCTS_Distance,        Gap, Time, Overall_Time,
-                      py::cast(Solution), py::cast(Length_Time)};
+Live_Solver *Make_Live_Solver(double alpha, double beta, double param_h, double param_t, int max_candidate_num,
+                              int max_depth, bool log_len_time, bool debug, int restart_policy, int kick_segment_len,
+                              int mcts_patience, double stagnation_threshold, const std::string &init_method)
+{
+    return new Live_Solver(Make_Search_Param(alpha, beta, param_h, param_t, max_candidate_num, 0, max_depth,
+                                             log_len_time, debug, restart_policy, kick_segment_len, mcts_patience,
+                                             stagnation_threshold, init_method, false, "", 300.0, ""));
 }
 
-PYBIND11_MODULE(_mcts_cpp, m)
+// Solve the instance from scratch. Without opt_solution, the gap is measured
+// against the identity tour
+TSP_Result Live_Solve(Live_Solver &Solver, Input_Array<double> coordinates,
+                      std::optional<Input_Array<int>> opt_solution, std::optional<Input_Array<double>> heatmap)
 {
-    m.def("solve", &solve, "A function to solve TSP using MCTS", py::arg("city_num"), py::arg("alpha"), py::arg("beta"),
+    int N = coordinates.ndim() == 2 ? (int)coordinates.shape(0) : 0;
+    if (coordinates.ndim() != 2 || coordinates.shape(1) != Coord_Dim || 2 * Solver.Param.Max_Depth > N)
+        throw std::runtime_error("Invalid coordinates array shape or dimensions");
+    if (opt_solution.has_value() && (opt_solution->ndim() != 1 || opt_solution->shape(0) != N))
+        throw std::runtime_error("Invalid solution array shape or dimensions");
+    if (heatmap.has_value() && (heatmap->ndim() != 2 || heatmap->shape(0) != N || heatmap->shape(1) != N))
+        throw std::runtime_error("Invalid heatmap array shape or dimensions");
+
+    vector<int> Identity_Tour;
+    if (!opt_solution.has_value())
+        for (int i = 0; i < N; i++)
+            Identity_Tour.push_back(i);
+    const int *Opt_Tour = opt_solution.has_value() ? opt_solution->data() : Identity_Tour.data();
+
+    TSP_Output Output;
+    {
+        py::gil_scoped_release release;
+        Output = Solver.Solve(N, coordinates.data(), Opt_Tour, heatmap.has_value() ? heatmap->data() : NULL);
+    }
+    return Make_TSP_Result(std::move(Output));
+}
+
+// Add, remove and move cities, then re-optimize the tour around them. The
+// indices refer to the numbering before the update, and are checked by
+// Live_Solver::Update()
+TSP_Result Live_Update(Live_Solver &Solver, Input_Array<double> add, Input_Array<int> remove,
+                       Input_Array<int> move_index, Input_Array<double> move_coordinates, double time_limit)
+{
+    if (add.ndim() != 2 || add.shape(1) != Coord_Dim)
+        throw std::runtime_error("Invalid added coordinates array shape or dimensions");
+    if (move_coordinates.ndim() != 2 || move_coordinates.shape(1) != Coord_Dim || move_index.ndim() != 1 ||
+        move_index.shape(0) != move_coordinates.shape(0) || remove.ndim() != 1)
+        throw std::runtime_error("Invalid moved cities array shape or dimensions");
+
+    vector<int> Remove_City(remove.data(), remove.data() + remove.size());
+    vector<int> Move_City(move_index.data(), move_index.data() + move_index.size());
+    vector<double> Add_Input(add.data(), add.data() + add.size());
+    vector<double> Move_Input(move_coordinates.data(), move_coordinates.data() + move_coordinates.size());
+    TSP_Output Output;
+    {
+        py::gil_scoped_release release;
+        Output = Solver.Update(Add_Input, Remove_City, Move_City, Move_Input, time_limit);
+    }
+    return Make_TSP_Result(std::move(Output));
+}
+
+// Write the recorded phases as Chrome trace JSON, return the number of events
+int export_trace(const std::string &path)
+{
+    int Event_Num;
+    {
+        py::gil_scoped_release release;
+        Event_Num = Export_Trace(path);
+    }
+    if (Event_Num == Null)
+        throw std::runtime_error("Cannot write the trace to " + path);
+    return Event_Num;
+}
+
+// Destroy a pool with the GIL released: its workers may need the GIL to run
+// the done callbacks of the jobs they are finishing
+struct Solver_Pool_Deleter
+{
+    void operator()(TSP_Solver_Pool *Pool) const
+    {
+        py::gil_scoped_release release;
+        delete Pool;
+    }
+};
+
+// Register one solve entry point per metric policy, sharing the same signature
+template <typename Metric> void Def_Solve(py::module &m, const char *Name, const char *Doc, const char *Input_Name)
+{
+    m.def(Name, &Solve_With_Metric<Metric>, Doc, py::arg("city_num"), py::arg("alpha"), py::arg("beta"),
           py::arg("param_h"), py::arg("param_t"), py::arg("max_candidate_num"), py::arg("candidate_use_heatmap"),
-          py::arg("max_depth"), py::arg("coordinates"), py::arg("opt_solution"), py::arg("heatmap"),
-          py::arg("log_len_time") = false, py::arg("debug") = false);
+          py::arg("max_depth"), py::arg(Input_Name), py::arg("opt_solution"), py::arg("heatmap"),
+          py::arg("log_len_time") = false, py::arg("debug") = false, py::arg("restart_policy") = Restart_Random,
+          py::arg("kick_segment_len") = 50, py::arg("mcts_patience") = 1, py::arg("stagnation_threshold") = 0.0,
+          py::arg("init_method") = "heatmap_sampling", py::arg("focused_sampling") = false,
+          py::arg("checkpoint_path") = "", py::arg("checkpoint_interval") = 300.0, py::arg("resume_path") = "",
+          py::arg("export_weight_num") = 0, py::arg("prior_weight_city") = py::none(),
+          py::arg("prior_weight") = py::none(), py::arg("compute_lower_bound") = false,
+          py::arg("target_gap") = 0.0, py::arg("renumber") = "none",
+          py::arg("heatmap_scale") = 1.0 / 255, py::arg("island_num") = 1,
+          py::arg("elite_pool_size") = 0);
+}
+
+PYBIND11_MODULE(_mcts_cpp, m)
+{
+    Def_Solve<Metric_EUC_2D>(m, "solve", "A function to solve TSP using MCTS", "coordinates");
+    Def_Solve<Metric_EUC_3D>(m, "solve_euc_3d", "Solve TSP using MCTS with normalized 3D Euclidean coordinates",
+                             "coordinates");
+    Def_Solve<Metric_CEIL_2D>(m, "solve_ceil_2d", "Solve TSP using MCTS with the TSPLIB CEIL_2D metric",
+                              "coordinates");
+    Def_Solve<Metric_GEO>(m, "solve_geo", "Solve TSP using MCTS with the TSPLIB GEO metric", "coordinates");
+    Def_Solve<Metric_ATT>(m, "solve_att", "Solve TSP using MCTS with the TSPLIB ATT metric", "coordinates");
+    Def_Solve<Metric_Explicit>(m, "solve_explicit", "Solve TSP using MCTS with an explicit integer distance matrix",
+                               "distance");
+
+    m.def("solve_decomposed", &solve_decomposed, "Solve a large EUC_2D TSP instance by spatial decomposition",
+          py::arg("city_num"), py::arg("alpha"), py::arg("beta"), py::arg("param_h"), py::arg("param_t"),
+          py::arg("max_candidate_num"), py::arg("max_depth"), py::arg("coordinates"), py::arg("opt_solution"),
+          py::arg("window_size") = 1000, py::arg("window_shift") = 0, py::arg("round_num") = 4,
+          py::arg("num_threads") = 0, py::arg("time_limit") = 0.0, py::arg("kick_segment_len") = 50,
+          py::arg("debug") = false);
+
+    m.def("solve_ensemble", &solve_ensemble,
+          "Solve one TSP instance once per heatmap, sharing the coordinate-derived precomputation",
+          py::arg("city_num"), py::arg("alpha"), py::arg("beta"), py::arg("param_h"), py::arg("param_t"),
+          py::arg("max_candidate_num"), py::arg("candidate_use_heatmap"), py::arg("max_depth"),
+          py::arg("coordinates"), py::arg("opt_solution"), py::arg("heatmaps"), py::arg("log_len_time") = false,
+          py::arg("debug") = false, py::arg("restart_policy") = Restart_Random, py::arg("kick_segment_len") = 50,
+          py::arg("mcts_patience") = 1, py::arg("stagnation_threshold") = 0.0,
+          py::arg("init_method") = "heatmap_sampling", py::arg("focused_sampling") = false,
+          py::arg("num_threads") = 0, py::arg("metric") = "EUC_2D");
+
+    py::class_<TSP_Ensemble_Result>(m, "TSP_Ensemble_Result")
+        .def_readonly("Best_Index", &TSP_Ensemble_Result::Best_Index)
+        .def_readonly("Best", &TSP_Ensemble_Result::Best)
+        .def_readonly("MCTS_Distances", &TSP_Ensemble_Result::MCTS_Distances)
+        .def_readonly("Gaps", &TSP_Ensemble_Result::Gaps)
+        .def_readonly("Times", &TSP_Ensemble_Result::Times)
+        .def_readonly("Overall_Time", &TSP_Ensemble_Result::Overall_Time);
+
+    m.def("tune", &tune, "Tune the search parameters by successive halving over a grid of configurations",
+          py::arg("city_num"), py::arg("alphas"), py::arg("betas"), py::arg("param_hs"), py::arg("max_depths"),
+          py::arg("max_candidate_nums"), py::arg("coordinates"), py::arg("opt_solutions"), py::arg("heatmaps"),
+          py::arg("candidate_use_heatmap") = 1, py::arg("min_param_t") = 0.01, py::arg("eta") = 2,
+          py::arg("restart_policy") = Restart_Random, py::arg("kick_segment_len") = 50,
+          py::arg("init_method") = "heatmap_sampling", py::arg("focused_sampling") = false,
+          py::arg("num_threads") = 0, py::arg("metric") = "EUC_2D");
+
+    py::class_<TSP_Tuning_Result>(m, "TSP_Tuning_Result")
+        .def_readonly("Best_Config", &TSP_Tuning_Result::Best_Config)
+        .def_readonly("Config", &TSP_Tuning_Result::Config)
+        .def_readonly("Round", &TSP_Tuning_Result::Round)
+        .def_readonly("Param_T", &TSP_Tuning_Result::Param_T)
+        .def_readonly("Mean_Distance", &TSP_Tuning_Result::Mean_Distance)
+        .def_readonly("Mean_Gap", &TSP_Tuning_Result::Mean_Gap)
+        .def_readonly("Mean_Time", &TSP_Tuning_Result::Mean_Time)
+        .def_readonly("Score", &TSP_Tuning_Result::Score);
+
+    m.def("start_trace", &Start_Trace, "Discard the recorded phases and record the following ones",
+          py::arg("capacity") = 1 << 16);
+    m.def("stop_trace", &Stop_Trace, "Stop recording the solver phases");
+    m.def("export_trace", &export_trace, "Write the recorded phases as Chrome trace JSON", py::arg("path"));
+
+    py::class_<Solver_Future>(m, "SolverFuture")
+        .def("done", &Solver_Future::done)
+        .def("result", &Solver_Future::result, py::arg("timeout") = py::none())
+        .def("add_done_callback", &Solver_Future::add_done_callback, py::arg("fn"));
+
+    py::class_<TSP_Solver_Pool, std::unique_ptr<TSP_Solver_Pool, Solver_Pool_Deleter>>(m, "SolverPool")
+        .def(py::init<int, int, bool>(), py::arg("num_threads") = 0, py::arg("max_queue_size") = 0,
+             py::arg("share_budget") = false)
+        .def("submit", &Submit_To_Pool, "Queue one instance, blocking while the queue is full", py::arg("city_num"),
+             py::arg("alpha"), py::arg("beta"), py::arg("param_h"), py::arg("param_t"), py::arg("max_candidate_num"),
+             py::arg("candidate_use_heatmap"), py::arg("max_depth"), py::arg("coordinates"), py::arg("opt_solution"),
+             py::arg("heatmap"), py::arg("log_len_time") = false, py::arg("debug") = false,
+             py::arg("restart_policy") = Restart_Random, py::arg("kick_segment_len") = 50,
+             py::arg("mcts_patience") = 1, py::arg("stagnation_threshold") = 0.0,
+             py::arg("init_method") = "heatmap_sampling", py::arg("focused_sampling") = false,
+             py::arg("checkpoint_path") = "", py::arg("checkpoint_interval") = 300.0, py::arg("resume_path") = "",
+             py::arg("metric") = "EUC_2D")
+        .def("shutdown", &TSP_Solver_Pool::Shutdown, py::call_guard<py::gil_scoped_release>(),
+             "Stop accepting instances and wait for the workers", py::arg("cancel_queued") = false)
+        .def_property_readonly("queue_size", &TSP_Solver_Pool::Get_Queue_Size)
+        .def_property_readonly("num_threads", &TSP_Solver_Pool::Get_Thread_Num);
+
+    py::class_<Live_Solver>(m, "LiveSolver")
+        .def(py::init(&Make_Live_Solver), py::arg("alpha") = 1.0, py::arg("beta") = 10.0, py::arg("param_h") = 10.0,
+             py::arg("param_t") = 0.1, py::arg("max_candidate_num") = 5, py::arg("max_depth") = 10,
+             py::arg("log_len_time") = false, py::arg("debug") = false, py::arg("restart_policy") = Restart_Random,
+             py::arg("kick_segment_len") = 50, py::arg("mcts_patience") = 1, py::arg("stagnation_threshold") = 0.0,
+             py::arg("init_method") = "heatmap_sampling")
+        .def("solve", &Live_Solve, "Solve the instance from scratch", py::arg("coordinates"),
+             py::arg("opt_solution") = py::none(), py::arg("heatmap") = py::none())
+        .def("update", &Live_Update, "Add, remove and move cities, then re-optimize the tour around them",
+             py::arg("add"), py::arg("remove"), py::arg("move_index"), py::arg("move_coordinates"),
+             py::arg("time_limit") = 0.0)
+        .def_property_readonly("city_num", &Live_Solver::Get_City_Num)
+        .def_property_readonly("coordinates",
+                               [](const Live_Solver &Solver) {
+                                   vector<double> Input(Solver.Input);
+                                   return Move_To_Numpy(std::move(Input), {Solver.Get_City_Num(), Coord_Dim});
+                               })
+        .def_property_readonly("tour", [](const Live_Solver &Solver) {
+            vector<int> Tour(Solver.Tour);
+            py::ssize_t Tour_Len = Tour.size();
+            return Move_To_Numpy(std::move(Tour), {Tour_Len});
+        });
 
     py::class_<TSP_Result>(m, "TSP_Result")
         .def(py::init<>())
@@ -206,10 +799,14 @@ PYBIND11_MODULE(_mcts_cpp, m)
         .def_readonly("Overall_Time", &TSP_Result::Overall_Time)
         .def_readonly("Solution", &TSP_Result::Solution)
         .def_readonly("Length_Time", &TSP_Result::Length_Time)
+        .def_readonly("Learned_Weight_City", &TSP_Result::Learned_Weight_City)
+        .def_readonly("Learned_Weight", &TSP_Result::Learned_Weight)
+        .def_readonly("Lower_Bound", &TSP_Result::Lower_Bound)
+        .def_readonly("Certified_Gap", &TSP_Result::Certified_Gap)
         .def("__repr__",
              [](const TSP_Result &r) {
-                 std::string solution_str = py::str(py::tuple(r.Solution)).cast<std::string>();
-                 std::string length_time_str = py::str(py::tuple(r.Length_Time)).cast<std::string>();
+                 std::string solution_str = py::str(r.Solution).cast<std::string>();
+                 std::string length_time_str = py::str(r.Length_Time).cast<std::string>();
                  return "TSP_Result(Concorde_Distance=" + std::to_string(r.Concorde_Distance) +
                         ", MCTS_Distance=" + std::to_string(r.MCTS_Distance) + ", Gap=" + std::to_string(r.Gap) +
                         ", Time=" + std::to_string(r.Time) + ", Overall_Time=" + std::to_string(r.Overall_Time) +
@@ -217,11 +814,13 @@ PYBIND11_MODULE(_mcts_cpp, m)
              })
         .def(py::pickle(
             [](const TSP_Result &r) { // __getstate__
+                // numpy arrays pickle as a single raw buffer instead of one object per element
                 return py::make_tuple(r.Concorde_Distance, r.MCTS_Distance, r.Gap, r.Time, r.Overall_Time, r.Solution,
-                                      r.Length_Time);
+                                      r.Length_Time, r.Learned_Weight_City, r.Learned_Weight, r.Lower_Bound,
+                                      r.Certified_Gap);
             },
             [](py::tuple t) { // __setstate__
-                if (t.size() != 7)
+                if (t.size() != 11)
                     throw std::runtime_error("Invalid state!");
                 TSP_Result r;
                 r.Concorde_Distance = t[0].cast<double>();
@@ -229,8 +828,12 @@ PYBIND11_MODULE(_mcts_cpp, m)
                 r.Gap = t[2].cast<double>();
                 r.Time = t[3].cast<double>();
                 r.Overall_Time = t[4].cast<double>();
-                r.Solution = t[5].cast<py::list>();
-                r.Length_Time = t[6].cast<py::list>();
+                r.Solution = t[5].cast<py::array_t<int>>();
+                r.Length_Time = t[6].cast<py::array_t<double>>();
+                r.Learned_Weight_City = t[7].cast<py::array_t<int>>();
+                r.Learned_Weight = t[8].cast<py::array_t<float>>();
+                r.Lower_Bound = t[9].cast<double>();
+                r.Certified_Gap = t[10].cast<double>();
                 return r;
             }));
 }
@@ -0,0 +1,56 @@
+// Translation unit of libmcts_tsp, the C interface of the solver (see mcts_tsp.h)
+//
+// The solver is compiled in an anonymous namespace, so that only the
+// mcts_tsp_* functions have external linkage: its globals (Distance, Weight,
+// Solution, ...) then cannot clash with the symbols of a program linking the
+// static library. The standard headers it uses are included first, outside
+// of the namespace
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <math.h>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "mcts_tsp.h"
+
+// Parts of the solver that only the Python module calls are left unused here
+#ifdef __GNUC__
+#pragma GCC diagnostic ignored "-Wunused-function"
+#endif
+
+namespace
+{
+#include "TSP_Ensemble.h"
+}
+
+// The handles of the interface are defined out of the namespace, over solver
+// types that are only defined in this translation unit
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wsubobject-linkage"
+#endif
+#include "TSP_C_API.h"
@@ -0,0 +1,128 @@
+#ifndef MCTS_TSP_H
+#define MCTS_TSP_H
+
+// C interface of the MCTS TSP solver, built as libmcts_tsp (shared and static).
+// All buffers belong to the caller: inputs are only read during the call and
+// results are copied out into caller buffers. Functions returning a status
+// return MCTS_TSP_OK or an error code, mcts_tsp_last_error() then describes
+// the error of the calling thread. The layout of the handles is private, so
+// parameters are set by name and results read through accessors, which keeps
+// the ABI stable when parameters or result fields are added
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32) && defined(MCTS_TSP_SHARED)
+#ifdef MCTS_TSP_BUILD
+#define MCTS_TSP_API __declspec(dllexport)
+#else
+#define MCTS_TSP_API __declspec(dllimport)
+#endif
+#elif defined(__GNUC__)
+#define MCTS_TSP_API __attribute__((visibility("default")))
+#else
+#define MCTS_TSP_API
+#endif
+
+#define MCTS_TSP_ABI_VERSION 1
+
+// Status codes
+#define MCTS_TSP_OK 0
+#define MCTS_TSP_ERROR_INVALID_ARGUMENT 1 // unknown parameter, bad value or bad instance
+#define MCTS_TSP_ERROR_OUT_OF_MEMORY 2
+#define MCTS_TSP_ERROR_SOLVE_FAILED 3 // the solve raised an error, e.g. a resume snapshot unreadable or of another instance
+
+typedef struct mcts_tsp_solver mcts_tsp_solver;
+typedef struct mcts_tsp_result mcts_tsp_result;
+
+// MCTS_TSP_ABI_VERSION of the library, to be checked against the header
+MCTS_TSP_API int mcts_tsp_abi_version(void);
+
+// Message of the last error raised in the calling thread ("" if none)
+MCTS_TSP_API const char *mcts_tsp_last_error(void);
+
+// A solver holds the parameters of its solves. It may run several solves at
+// once from different threads, as long as its parameters are not changed
+// meanwhile. Returns NULL if out of memory
+MCTS_TSP_API mcts_tsp_solver *mcts_tsp_solver_create(void);
+MCTS_TSP_API void mcts_tsp_solver_destroy(mcts_tsp_solver *solver);
+
+// Numeric parameters, named as the keyword arguments of the Python solve():
+// alpha, beta, param_h, param_t, max_candidate_num, candidate_use_heatmap,
+// max_depth, restart_policy, kick_segment_len, focused_sampling,
+// mcts_patience, stagnation_threshold, log_len_time, debug,
+// checkpoint_interval, export_weight_num, compute_lower_bound, target_gap,
+// heatmap_scale, island_num, the number of concurrent searches of each
+// instance sharing their best tour (1: a single search), elite_pool_size, the
+// number of restart tours kept for crossover (0: none), and thread_num, the
+// number of threads of a batch solve (0: one per core)
+MCTS_TSP_API int mcts_tsp_solver_set_param(mcts_tsp_solver *solver, const char *name, double value);
+
+// String parameters: metric (EUC_2D, EUC_3D, CEIL_2D, GEO, ATT or EXPLICIT),
+// init_method, renumber (none, hilbert or greedy), heatmap_format (float64,
+// float16 or uint8, see mcts_tsp_solve()), checkpoint_path and resume_path
+MCTS_TSP_API int mcts_tsp_solver_set_string_param(mcts_tsp_solver *solver, const char *name, const char *value);
+
+// Learned edge weights to start the next solves from, as exported by
+// mcts_tsp_result_learned_weight(): city and weight hold city_num x k values.
+// They are copied, a NULL city clears them. Batch solves ignore them
+MCTS_TSP_API int mcts_tsp_solver_set_prior_weight(mcts_tsp_solver *solver, int city_num, int k, const int *city,
+                                                  const float *weight);
+
+// Stop the solves running on the solver, which return the best tour found so
+// far. Solves started after the call are not affected. Safe to call from any
+// thread
+MCTS_TSP_API void mcts_tsp_solver_cancel(mcts_tsp_solver *solver);
+
+// Solve one instance of city_num cities in the calling thread. coordinates
+// holds city_num x 2 values (x 3 for EUC_3D) and distance_matrix, used instead
+// by the EXPLICIT metric, city_num x city_num integers. opt_solution is the
+// reference tour of the gap (NULL: the identity tour). heatmap is city_num x
+// city_num entries of heatmap_format: doubles, IEEE half precision floats, or
+// bytes whose value is byte x heatmap_scale (default 1/255). It is stored in
+// that format during the solve, and may be NULL if the candidates do not
+// depend on it. On success
+// *result is set to a result to be freed by mcts_tsp_result_destroy()
+MCTS_TSP_API int mcts_tsp_solve(mcts_tsp_solver *solver, int city_num, const double *coordinates,
+                                const int *distance_matrix, const int *opt_solution, const void *heatmap,
+                                mcts_tsp_result **result);
+
+// Solve instance_num instances of city_num cities on thread_num threads. The
+// arrays are those of mcts_tsp_solve() stacked along a first axis of size
+// instance_num. On success results[i] is set for every instance, on failure
+// none is
+MCTS_TSP_API int mcts_tsp_solve_batch(mcts_tsp_solver *solver, int instance_num, int city_num,
+                                      const double *coordinates, const int *distance_matrices,
+                                      const int *opt_solutions, const void *heatmaps, mcts_tsp_result **results);
+
+MCTS_TSP_API void mcts_tsp_result_destroy(mcts_tsp_result *result);
+
+MCTS_TSP_API int mcts_tsp_result_city_num(const mcts_tsp_result *result);
+MCTS_TSP_API double mcts_tsp_result_concorde_distance(const mcts_tsp_result *result); // length of opt_solution
+MCTS_TSP_API double mcts_tsp_result_mcts_distance(const mcts_tsp_result *result);
+MCTS_TSP_API double mcts_tsp_result_gap(const mcts_tsp_result *result);
+MCTS_TSP_API double mcts_tsp_result_time(const mcts_tsp_result *result);         // seconds of search
+MCTS_TSP_API double mcts_tsp_result_overall_time(const mcts_tsp_result *result); // seconds of the whole solve
+MCTS_TSP_API double mcts_tsp_result_lower_bound(const mcts_tsp_result *result);  // -1 unless computed
+MCTS_TSP_API double mcts_tsp_result_certified_gap(const mcts_tsp_result *result);
+MCTS_TSP_API int mcts_tsp_result_cancelled(const mcts_tsp_result *result);
+
+// Copy the tour (city_num cities starting from city 0) into tour if capacity
+// is at least city_num. Returns city_num
+MCTS_TSP_API int mcts_tsp_result_tour(const mcts_tsp_result *result, int *tour, int capacity);
+
+// Copy the (length, time) records of log_len_time into records if capacity is
+// at least their number. Returns the number of records (2 values each)
+MCTS_TSP_API int mcts_tsp_result_length_time(const mcts_tsp_result *result, double *records, int capacity);
+
+// Copy the export_weight_num heaviest learned edges of each city into city
+// (-1 padded) and weight if capacity is at least city_num x k. Returns k
+MCTS_TSP_API int mcts_tsp_result_learned_weight(const mcts_tsp_result *result, int *city, float *weight,
+                                                int capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MCTS_TSP_H
@@ -0,0 +1,311 @@
+"""Anytime-performance benchmark of the solver.
+
+Solves seeded uniform and clustered instances, and optionally TSPLIB files,
+under each configuration and thread count. For each run it records:
+
+- the primal integral of the (length, time) records;
+- the time to reach each target gap;
+- the throughput of the batch, in instances/s.
+
+Results are written as JSON, and two result files can be compared:
+
+    python test/benchmark.py --output before.json
+    python test/benchmark.py --output after.json --reference before.json
+    python test/benchmark.py --compare before.json after.json
+
+Instances of up to --dense-max-cities cities are solved by
+parallel_mcts_solve with a heatmap derived from the k nearest cities, larger
+ones by solve_large_instance. The decomposition does not take the settings
+of the configurations, so only "default" is run on larger instances, the
+other configurations are skipped there. The gaps are measured against the best length
+known for each instance: the one given by --reference (or a TSPLIB optimum in
+--optima), otherwise the best found by the runs of this benchmark. The
+references used are written along with the results. Pass them back with
+--reference so that the next build is measured against the same lengths.
+The record times are search times, which exclude loading the instance.
+"""
+import argparse
+import json
+import os
+import platform
+import subprocess
+import time
+
+import numpy as np
+
+import mcts_tsp
+
+# Solver settings compared by the benchmark, selected with --configs
+CONFIGS = {
+    "default": dict(),
+    "focused": dict(focused_sampling=True),
+    "alpha_heatmap": dict(candidate_use_heatmap=3),
+    "double_bridge": dict(restart_policy=1),
+}
+
+
+def uniform_instance(city_num, seed):
+    return np.random.default_rng(seed).random((city_num, 2))
+
+
+def clustered_instance(city_num, seed):
+    """Gaussian clusters around uniform centers (DIMACS challenge style)."""
+    rng = np.random.default_rng(seed)
+    cluster_num = max(1, city_num // 100)
+    centers = rng.random((cluster_num, 2))
+    labels = rng.integers(cluster_num, size=city_num)
+    coordinates = centers[labels] + rng.normal(scale=0.5 / np.sqrt(cluster_num) / 4, size=(city_num, 2))
+    return np.clip(coordinates, 0.0, 1.0)
+
+
+def read_tsplib(path):
+    """Read the coordinates of a TSPLIB file, return (name, coordinates, metric, scale).
+
+    EUC_2D coordinates are normalized into the unit square, lengths are then
+    multiplied by `scale` to get back to the units of the file.
+    """
+    header, coordinates = {}, []
+    with open(path) as f:
+        lines = iter(f)
+        for line in lines:
+            if line.strip().startswith("NODE_COORD_SECTION"):
+                break
+            if ":" in line:
+                key, value = line.split(":", 1)
+                header[key.strip()] = value.strip()
+        for line in lines:
+            fields = line.split()
+            if not fields or fields[0] == "EOF":
+                break
+            coordinates.append([float(fields[1]), float(fields[2])])
+    metric = header.get("EDGE_WEIGHT_TYPE", "EUC_2D")
+    if metric not in ("EUC_2D", "CEIL_2D", "ATT", "GEO"):
+        raise ValueError(f"{path}: unsupported EDGE_WEIGHT_TYPE {metric}")
+    coordinates = np.asarray(coordinates, dtype=np.float64)
+    scale = 1.0
+    if metric == "EUC_2D":
+        coordinates = coordinates - coordinates.min(axis=0)
+        scale = max(float(coordinates.max()), 1e-12)
+        coordinates = coordinates / scale
+    name = header.get("NAME", os.path.splitext(os.path.basename(path))[0])
+    return name, coordinates, metric, scale
+
+
+def knn_heatmap(coordinates, k=10, block_size=1024):
+    """Heatmap surrogate: edge (i, j) weighs exp(-d(i, j) / d(i, k-th nearest))
+    if j is among the k nearest cities of i, normalized per row and made
+    symmetric, 0 elsewhere."""
+    city_num = len(coordinates)
+    k = min(k, city_num - 1)
+    heatmap = np.zeros((city_num, city_num), dtype=np.float64)
+    for begin in range(0, city_num, block_size):
+        end = min(begin + block_size, city_num)
+        distance = np.linalg.norm(coordinates[begin:end, None, :] - coordinates[None, :, :], axis=2)
+        distance[np.arange(end - begin), np.arange(begin, end)] = np.inf
+        nearest = np.argpartition(distance, k - 1, axis=1)[:, :k]
+        nearest_distance = np.take_along_axis(distance, nearest, axis=1)
+        weight = np.exp(-nearest_distance / np.maximum(nearest_distance.max(axis=1, keepdims=True), 1e-12))
+        weight /= weight.sum(axis=1, keepdims=True)
+        np.put_along_axis(heatmap[begin:end], nearest, weight, axis=1)
+    return np.maximum(heatmap, heatmap.T)
+
+
+def primal_integral(records, final_length, horizon, reference):
+    """Integral over [0, horizon] of the primal gap (L(t) - L*) / max(L(t), L*),
+    which is 1 until the first record. `records` holds (length, time) rows."""
+    points = [(float(t), float(length)) for length, t in records if t <= horizon]
+    points.append((horizon, float(final_length)))
+    integral, last_time, last_gap = 0.0, 0.0, 1.0
+    for t, length in points:
+        integral += last_gap * (t - last_time)
+        last_time, last_gap = t, max(length - reference, 0.0) / max(length, reference)
+    return integral
+
+
+def time_to_gap(records, final_length, final_time, reference, target_gap):
+    """First time the length is within target_gap of the reference, or None."""
+    for length, t in list(records) + [(final_length, final_time)]:
+        if length <= (1 + target_gap) * reference:
+            return float(t)
+    return None
+
+
+def git_commit():
+    try:
+        return subprocess.run(["git", "rev-parse", "HEAD"], capture_output=True, text=True, check=True,
+                              cwd=os.path.dirname(os.path.abspath(__file__))).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def build_instances(args):
+    """Return a list of (family, instance_id, coordinates, metric, scale)."""
+    instances = []
+    for family, generate in (("uniform", uniform_instance), ("clustered", clustered_instance)):
+        if family not in args.families:
+            continue
+        for city_num in args.sizes:
+            for index in range(args.instances):
+                seed = args.seed + 1000 * index + city_num
+                instances.append((family, f"{family}-{city_num}-{index}", generate(city_num, seed), "EUC_2D", 1.0))
+    for path in args.tsplib:
+        name, coordinates, metric, scale = read_tsplib(path)
+        instances.append(("tsplib", name, coordinates, metric, scale))
+    return instances
+
+
+# Solve a group of instances of the same family and size under one
+# configuration and thread count, return (per-instance (records, length,
+# time, overall_time), wall time). Lengths are in the units of the instances
+def solve_group(group, config, threads, args):
+    city_num = len(group[0][2])
+    params = dict(CONFIGS[config])
+    if city_num <= args.dense_max_cities:
+        metric = group[0][3]
+        coordinates_list = np.stack([instance[2] for instance in group])
+        heatmaps = np.stack([knn_heatmap(instance[2], args.heatmap_k) for instance in group])
+        opt_solutions = np.tile(np.arange(city_num, dtype=np.int32), (len(group), 1))
+        begin = time.perf_counter()
+        _, lengths, _, times, overall_times, _, lengths_times = mcts_tsp.parallel_mcts_solve(
+            city_num, threads, coordinates_list, opt_solutions, heatmaps, param_t=args.param_t, log_len_time=True,
+            metric=metric, max_depth=min(10, city_num // 2), **params)
+        wall = time.perf_counter() - begin
+        outcomes = [(np.asarray(records).reshape(-1, 2) * [scale, 1], length * scale, t, overall)
+                    for (_, _, _, _, scale), records, length, t, overall
+                    in zip(group, lengths_times, lengths, times, overall_times)]
+        return outcomes, wall
+
+    assert not params, "solve_large_instance does not take the settings of the configurations"
+    outcomes, wall = [], 0.0
+    for _, _, coordinates, _, scale in group:
+        begin = time.perf_counter()
+        result = mcts_tsp.solve_large_instance(coordinates, np.arange(city_num, dtype=np.int32), city_num,
+                                               param_t=args.param_t, num_threads=threads)
+        wall += time.perf_counter() - begin
+        records = np.asarray(result.Length_Time).reshape(-1, 2) * [scale, 1]
+        outcomes.append((records, result.MCTS_Distance * scale, result.Time, result.Overall_Time))
+    return outcomes, wall
+
+
+def run(args):
+    references = {}
+    for path in args.reference:
+        with open(path) as f:
+            references.update(json.load(f).get("references", {}))
+    if args.optima:
+        with open(args.optima) as f:
+            references.update(json.load(f))
+
+    instances = build_instances(args)
+    groups = {}
+    for instance in instances:
+        groups.setdefault((instance[0], len(instance[2]), instance[3]), []).append(instance)
+
+    raw_runs = []
+    for (family, city_num, _), group in sorted(groups.items()):
+        for config in args.configs:
+            if city_num > args.dense_max_cities and CONFIGS[config]:
+                print(f"{family:>9} N={city_num:<7} {config:<14} skipped: solved by decomposition, "
+                      f"which ignores the configuration")
+                continue
+            for threads in args.threads:
+                outcomes, wall = solve_group(group, config, threads, args)
+                print(f"{family:>9} N={city_num:<7} {config:<14} threads={threads:<3} "
+                      f"{len(group) / wall:8.3f} instances/s")
+                for (_, instance_id, _, _, _), outcome in zip(group, outcomes):
+                    raw_runs.append((family, city_num, instance_id, config, threads, wall, len(group), outcome))
+
+    # Instances without a given reference are measured against the best run
+    given = set(references) if not args.update_references else set()
+    for _, _, instance_id, _, _, _, _, (_, length, _, _) in raw_runs:
+        if instance_id not in given:
+            references[instance_id] = min(length, references.get(instance_id, np.inf))
+
+    runs, summary = [], {}
+    for family, city_num, instance_id, config, threads, wall, group_size, outcome in raw_runs:
+        records, length, search_time, overall_time = outcome
+        reference = references[instance_id]
+        horizon = max(search_time, float(records[-1, 1]) if len(records) else 0.0)
+        integral = primal_integral(records, length, horizon, reference)
+        run = dict(family=family, city_num=city_num, instance=instance_id, config=config, threads=threads,
+                   length=length, gap=(length - reference) / reference, time=search_time,
+                   overall_time=overall_time, primal_integral=integral,
+                   normalized_primal_integral=integral / horizon if horizon > 0 else None,
+                   time_to_gap={str(g): time_to_gap(records, length, search_time, reference, g)
+                                for g in args.target_gaps})
+        runs.append(run)
+        key = (family, city_num, config, threads)
+        summary.setdefault(key, dict(family=family, city_num=city_num, config=config, threads=threads,
+                                     instances=group_size, throughput=group_size / wall, runs=[]))["runs"].append(run)
+
+    for entry in summary.values():
+        entry_runs = entry.pop("runs")
+        entry["mean_gap"] = float(np.mean([r["gap"] for r in entry_runs]))
+        entry["mean_primal_integral"] = float(np.mean([r["primal_integral"] for r in entry_runs]))
+        entry["mean_time_to_gap"], entry["reached_gap"] = {}, {}
+        for g in map(str, args.target_gaps):
+            reached = [r["time_to_gap"][g] for r in entry_runs if r["time_to_gap"][g] is not None]
+            entry["reached_gap"][g] = len(reached)
+            entry["mean_time_to_gap"][g] = float(np.mean(reached)) if reached else None
+
+    meta = dict(timestamp=time.strftime("%Y-%m-%dT%H:%M:%S"), git_commit=git_commit(),
+                python=platform.python_version(), platform=platform.platform(), cpu_count=os.cpu_count(),
+                args=vars(args))
+    with open(args.output, "w") as f:
+        json.dump(dict(meta=meta, references=references, summary=list(summary.values()), runs=runs), f, indent=1)
+    print(f"Results written to {args.output}")
+
+
+def compare(base_path, new_path):
+    """Print the change of the summary metrics between two result files."""
+    with open(base_path) as f:
+        base = json.load(f)
+    with open(new_path) as f:
+        new = json.load(f)
+    key = lambda entry: (entry["family"], entry["city_num"], entry["config"], entry["threads"])
+    base_summary = {key(entry): entry for entry in base["summary"]}
+    print(f"{'family':>9} {'N':>7} {'config':<14} {'thr':>3} {'gap %':>15} {'primal integral':>19} "
+          f"{'instances/s':>19}")
+    for entry in new["summary"]:
+        old = base_summary.get(key(entry))
+        if old is None:
+            continue
+        print(f"{entry['family']:>9} {entry['city_num']:>7} {entry['config']:<14} {entry['threads']:>3} "
+              f"{100 * old['mean_gap']:7.3f}>{100 * entry['mean_gap']:<7.3f} "
+              f"{old['mean_primal_integral']:9.4f}>{entry['mean_primal_integral']:<9.4f} "
+              f"{old['throughput']:9.3f}>{entry['throughput']:<9.3f}")
+    if base["references"] != new["references"]:
+        print("Warning: the two files use different references, pass --reference to compare gaps")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--output", default="benchmark.json")
+    parser.add_argument("--families", nargs="+", default=["uniform", "clustered"])
+    parser.add_argument("--sizes", nargs="+", type=int, default=[100, 1000, 10000, 100000])
+    parser.add_argument("--instances", type=int, default=2, help="instances per family and size")
+    parser.add_argument("--tsplib", nargs="*", default=[], help="TSPLIB files to solve as well")
+    parser.add_argument("--configs", nargs="+", default=["default"], choices=sorted(CONFIGS))
+    parser.add_argument("--threads", nargs="+", type=int, default=[1, os.cpu_count() or 1])
+    parser.add_argument("--param-t", type=float, default=0.01, help="search time per city, in seconds")
+    parser.add_argument("--target-gaps", nargs="+", type=float, default=[0.05, 0.02, 0.01])
+    parser.add_argument("--heatmap-k", type=int, default=10)
+    parser.add_argument("--dense-max-cities", type=int, default=5000,
+                        help="larger instances are solved by decomposition, without heatmap and only "
+                             "under the default configuration")
+    parser.add_argument("--seed", type=int, default=42)
+    parser.add_argument("--reference", nargs="*", default=[], help="result files whose references to reuse")
+    parser.add_argument("--optima", help="JSON file {instance name: optimal length}, e.g. for TSPLIB")
+    parser.add_argument("--update-references", action="store_true",
+                        help="replace the given references by better lengths found")
+    parser.add_argument("--compare", nargs=2, metavar=("BASE", "NEW"))
+    args = parser.parse_args()
+    args.threads = sorted(set(args.threads))
+    if args.compare:
+        compare(*args.compare)
+    else:
+        run(args)
+
+
+if __name__ == "__main__":
+    main()
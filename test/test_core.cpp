@@ -0,0 +1,615 @@
+// Regression checks of the solver internals, registered with ctest (see
+// CMakeLists.txt). Run `test_core <name>` for one check, or no argument for
+// all of them
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <thread>
+
+#include "TSP_Dynamic.h"
+#include "TSP_Solver.h"
+
+thread_local int Failed_Check_Num = 0;
+
+#define Check(Condition)                                                                                               \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(Condition))                                                                                              \
+        {                                                                                                              \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #Condition);                                       \
+            Failed_Check_Num++;                                                                                        \
+        }                                                                                                              \
+    } while (0)
+
+// Random uniform coordinates of N cities, row-major N x 2
+vector<double> Get_Random_Coordinates(int N, unsigned long long Seed)
+{
+    Set_Random_Seed(Seed);
+    vector<double> Coordinates(2 * N);
+    for (double &Coordinate : Coordinates)
+        Coordinate = Get_Random_Int(1000000) / 1000000.0;
+    return Coordinates;
+}
+
+// Set up the globals of the calling thread for a search of an EUC_2D
+// instance, as Solve_Instance() does, without running it
+void Load_Search_Instance(int N, const vector<double> &Coordinates)
+{
+    Search_Param Param = Get_Search_Param();
+    Param.Candidate_Use_Heatmap = Candidate_Nearest;
+    Set_Search_Param(Param);
+    Heatmap_Format = Heatmap_Float64;
+    Temp_City_Num = City_Num = Virtual_City_Num = N;
+    Start_City = 0;
+    Salesman_Num = 1;
+    If_Has_Coordinates = true;
+    If_Shared_Instance = If_Shared_Candidate = false;
+
+    Allocate_Memory(N);
+    Load_Instance_Input<Metric_EUC_2D>(Coordinates.data());
+    Metric_EUC_2D::Prepare();
+    Calculate_All_Pair_Distance<Metric_EUC_2D>();
+    Current_Instance_Begin_Time = std::chrono::steady_clock::now();
+    Current_Instance_Best_Distance = Inf_Cost;
+    Identify_Candidate_Set();
+    Set_Candidate_Edge_Heatmap();
+    MCTS_Init();
+}
+
+// Return true if Tour[0..N) visits each of the N cities once
+bool If_Permutation(const int *Tour, int N)
+{
+    vector<char> If_Visited(N, false);
+    for (int i = 0; i < N; i++)
+    {
+        if (Tour[i] < 0 || Tour[i] >= N || If_Visited[Tour[i]])
+            return false;
+        If_Visited[Tour[i]] = true;
+    }
+    return true;
+}
+
+// Partition crossover of two 2-opt local optima: the offspring is a tour, no
+// longer than either parent
+void Test_Partition_Crossover()
+{
+    int N = 300;
+    Load_Search_Instance(N, Get_Random_Coordinates(N, 1));
+    Elite_Pool_Size = 2;
+
+    int Crossed_Num = 0;
+    for (int Trial = 0; Trial < 40; Trial++)
+    {
+        Init_Elite_Pool();
+        for (int Parent = 0; Parent < 2; Parent++)
+        {
+            for (int i = 0; i < N; i++)
+                Solution[i] = i;
+            for (int i = N - 1; i > 0; i--)
+                std::swap(Solution[i], Solution[Get_Random_Int(i + 1)]);
+            Convert_Solution_To_All_Node();
+            Local_Search_by_2Opt_Move();
+            Add_Elite_Tour();
+        }
+        if (Elite_Tour.size() < 2)
+            continue;
+
+        Current_Instance_Best_Distance = Inf_Cost;
+        if (!Partition_Crossover(0, 1))
+            continue;
+        Crossed_Num++;
+        Check(If_Permutation(Solution, N));
+        Check(Solution[0] == Start_City);
+        Convert_Solution_To_All_Node();
+        Check(Check_Solution_Feasible());
+        Distance_Type Offspring_Distance = Get_Solution_Total_Distance();
+        Check(Offspring_Distance <= Elite_Distance[0]);
+        Check(Offspring_Distance <= Elite_Distance[1]);
+    }
+    Check(Crossed_Num > 0);
+
+    Elite_Pool_Size = 0;
+    Release_Memory(N);
+}
+
+// Half precision heatmap entries: every half value survives the round trip
+// through float, subnormals, infinities and NaN included, and Half_To_Float()
+// is exact on the boundary values
+void Test_Half_Float_Round_Trip()
+{
+    for (uint32_t Half = 0; Half <= 0xffff; Half++)
+    {
+        float Value = Half_To_Float((uint16_t)Half);
+        bool If_NaN = (Half & 0x7c00) == 0x7c00 && (Half & 0x3ff) != 0;
+        if (If_NaN)
+        {
+            Check(std::isnan(Value));
+            uint16_t Back = Float_To_Half(Value);
+            Check((Back & 0x7c00) == 0x7c00 && (Back & 0x3ff) != 0);
+        }
+        else
+            Check(Float_To_Half(Value) == Half);
+    }
+
+    Check(Half_To_Float(0x0001) == std::ldexp(1.0f, -24)); // smallest subnormal
+    Check(Half_To_Float(0x03ff) == std::ldexp(1023.0f, -24)); // largest subnormal
+    Check(Half_To_Float(0x0400) == std::ldexp(1.0f, -14)); // smallest normal
+    Check(Half_To_Float(0x7bff) == 65504.0f);
+    Check(Half_To_Float(0x7c00) == std::numeric_limits<float>::infinity());
+    Check(Half_To_Float(0xfc00) == -std::numeric_limits<float>::infinity());
+    Check(std::signbit(Half_To_Float(0x8000)) && Half_To_Float(0x8000) == 0);
+
+    // Rounding of floats that are not half values
+    Check(Float_To_Half(std::ldexp(1.0f, -26)) == 0x0000); // below half the smallest subnormal
+    Check(Float_To_Half(std::ldexp(3.0f, -26)) == 0x0001); // rounds up to the smallest subnormal
+    Check(Float_To_Half(std::ldexp(1.5f, -24)) == 0x0002); // tie, to even
+    Check(Float_To_Half(65520.0f) == 0x7c00); // overflows to infinity
+    Check(Float_To_Half(1.0f + std::ldexp(1.0f, -11)) == 0x3c00); // tie, to even
+}
+
+// Length of Tour over the input coordinates (N x 2)
+double Get_Input_Tour_Length(const vector<int> &Tour, const vector<double> &Coordinates)
+{
+    double Length = 0;
+    for (size_t i = 0; i < Tour.size(); i++)
+    {
+        int First_City = Tour[i], Second_City = Tour[(i + 1) % Tour.size()];
+        Length += std::hypot(Coordinates[2 * First_City] - Coordinates[2 * Second_City],
+                             Coordinates[2 * First_City + 1] - Coordinates[2 * Second_City + 1]);
+    }
+    return Length;
+}
+
+// Internal renumbering of the cities: whatever the method, the returned tour
+// is in input numbers, starts from input city 0 and has the reported length
+// over the input coordinates, and so does the reference tour
+void Test_Renumbering()
+{
+    int N = 400;
+    vector<double> Coordinates = Get_Random_Coordinates(N, 2);
+    vector<int> Opt_Tour(N);
+    for (int i = 0; i < N; i++)
+        Opt_Tour[i] = i;
+    for (int i = N - 1; i > 0; i--)
+        std::swap(Opt_Tour[i], Opt_Tour[Get_Random_Int(i + 1)]);
+
+    for (int Method : {Renumber_None, Renumber_Hilbert, Renumber_Greedy})
+    {
+        Search_Param Param = Get_Search_Param();
+        Param.Param_T = 0.0005;
+        Param.Candidate_Use_Heatmap = Candidate_Nearest;
+        Param.Renumber_Method = Method;
+        TSP_Output Output = Solve_Instance<Metric_EUC_2D>(N, Param, Coordinates.data(), Opt_Tour.data(), NULL);
+
+        Check((int)Output.Solution.size() == N);
+        Check(If_Permutation(Output.Solution.data(), N));
+        Check(Output.Solution[0] == 0);
+        Check(std::fabs(Get_Input_Tour_Length(Output.Solution, Coordinates) - Output.MCTS_Distance) <
+              1e-9 * Output.MCTS_Distance);
+        Check(std::fabs(Get_Input_Tour_Length(Opt_Tour, Coordinates) - Output.Concorde_Distance) <
+              1e-9 * Output.Concorde_Distance);
+    }
+
+    // Instances without coordinates are renumbered by a nearest-neighbor
+    // tour over the distance matrix
+    vector<int> Matrix((size_t)N * N);
+    for (int i = 0; i < N; i++)
+        for (int j = 0; j < N; j++)
+            Matrix[(size_t)i * N + j] = (int)(0.5 + 1000 * std::hypot(Coordinates[2 * i] - Coordinates[2 * j],
+                                                                    Coordinates[2 * i + 1] - Coordinates[2 * j + 1]));
+    Search_Param Param = Get_Search_Param();
+    Param.Param_T = 0.0005;
+    Param.Candidate_Use_Heatmap = Candidate_Nearest;
+    Param.Renumber_Method = Renumber_Greedy;
+    TSP_Output Output = Solve_Instance<Metric_Explicit>(N, Param, Matrix.data(), Opt_Tour.data(), NULL);
+    Check(If_Permutation(Output.Solution.data(), N));
+    Check((int)Output.Solution.size() == N && Output.Solution[0] == 0);
+    long long Length = 0;
+    for (int i = 0; i < N && (int)Output.Solution.size() == N; i++)
+        Length += Matrix[(size_t)Output.Solution[i] * N + Output.Solution[(i + 1) % N]];
+    Check(Length == (long long)Output.MCTS_Distance);
+}
+
+// Return true if Update() rejects the change with std::runtime_error
+bool If_Update_Rejected(Dynamic_Instance<Metric_EUC_2D> &Instance, const vector<double> &Add_Input,
+                        const vector<int> &Remove_City, const vector<int> &Move_City,
+                        const vector<double> &Move_Input)
+{
+    try
+    {
+        Instance.Update(Add_Input, Remove_City, Move_City, Move_Input, 0.01);
+    }
+    catch (const std::runtime_error &)
+    {
+        return true;
+    }
+    return false;
+}
+
+// Updates of a live instance: out-of-range, repeated and both removed and
+// moved cities are rejected without touching the instance, which still takes
+// a valid update afterwards. The kept heatmap follows the renumbering of the
+// update, and is the candidate edge heatmap at the moved and added cities
+void Test_Live_Update_Validation()
+{
+    int N = 200;
+    vector<double> Coordinates = Get_Random_Coordinates(N, 3);
+    vector<int> Opt_Tour(N);
+    for (int i = 0; i < N; i++)
+        Opt_Tour[i] = i;
+    Search_Param Param = Get_Search_Param();
+    Param.Param_T = 0.0005;
+    Dynamic_Instance<Metric_EUC_2D> Instance(Param);
+    Instance.Solve(N, Coordinates.data(), Opt_Tour.data(), NULL);
+    vector<int> Tour = Instance.Tour;
+
+    vector<double> No_Input, One_Point = {0.5, 0.5};
+    Check(If_Update_Rejected(Instance, No_Input, {N}, {}, No_Input));
+    Check(If_Update_Rejected(Instance, No_Input, {-1}, {}, No_Input));
+    Check(If_Update_Rejected(Instance, No_Input, {}, {N}, One_Point));
+    Check(If_Update_Rejected(Instance, No_Input, {4, 7, 4}, {}, No_Input));
+    Check(If_Update_Rejected(Instance, No_Input, {}, {5, 5}, {0.1, 0.1, 0.2, 0.2}));
+    Check(If_Update_Rejected(Instance, No_Input, {5}, {5}, One_Point));
+    Check(If_Update_Rejected(Instance, No_Input, {}, {5}, No_Input)); // no coordinates for the moved city
+    Check(If_Update_Rejected(Instance, {0.5}, {}, {}, No_Input)); // half a point
+    Check(Instance.Get_City_Num() == N);
+    Check(Instance.Tour == Tour);
+
+    vector<vector<float>> Heatmap(N);
+    for (int i = 0; i < N; i++)
+        Heatmap[i].assign(Instance.Shared.Edge_Heatmap[i], Instance.Shared.Edge_Heatmap[i] + N);
+    TSP_Output Output = Instance.Update(One_Point, {4, 7}, {5}, {0.25, 0.75}, 0.01);
+    Check(Instance.Get_City_Num() == N - 1);
+    Check((int)Output.Solution.size() == N - 1);
+    Check(If_Permutation(Output.Solution.data(), N - 1));
+
+    // Cities 7 and 4 are removed, by decreasing index, and take the last
+    // cities N - 1 and N - 2. City 5 is moved, city N - 2 is added
+    vector<int> Old_City(N - 1);
+    for (int i = 0; i < N - 1; i++)
+        Old_City[i] = i == 7 ? N - 1 : i == 4 ? N - 2 : i;
+    const Shared_Instance &Shared = Instance.Shared;
+    auto If_Candidate = [&Shared](int City, int Other) {
+        return std::find(Shared.Candidate[City], Shared.Candidate[City] + Shared.Candidate_Num[City], Other) !=
+               Shared.Candidate[City] + Shared.Candidate_Num[City];
+    };
+    for (int i = 0; i < N - 1; i++)
+        for (int j = 0; j < N - 1; j++)
+            if (i == 5 || j == 5 || i == N - 2 || j == N - 2)
+                Check(Shared.Edge_Heatmap[i][j] == (If_Candidate(i, j) || If_Candidate(j, i) ? 1 : 0));
+            else
+                Check(Shared.Edge_Heatmap[i][j] == Heatmap[Old_City[i]][Old_City[j]]);
+}
+
+// Return true if Load_Resume_Snapshot() rejects the snapshot at Path for an
+// instance of N cities with std::runtime_error
+bool If_Resume_Rejected(const char *Path, int N)
+{
+    Resume_Path = Path;
+    try
+    {
+        Load_Resume_Snapshot(N);
+    }
+    catch (const std::runtime_error &)
+    {
+        return true;
+    }
+    return false;
+}
+
+// Checkpoint round trip: resuming restores the best tour, the edge
+// statistics, the RNG state and the consumed budget of the last snapshot,
+// merged with the edges of the earlier ones. A snapshot of another instance,
+// or a corrupt or truncated one, is rejected
+void Test_Checkpoint_Round_Trip()
+{
+    int N = 200;
+    vector<double> Coordinates = Get_Random_Coordinates(N, 4);
+    Load_Search_Instance(N, Coordinates);
+    const char *Path = "test_core_checkpoint.bin";
+    const char *Corrupt_Path = "test_core_checkpoint_corrupt.bin";
+    Checkpoint_Instance_Hash = Get_Instance_Hash<Metric_EUC_2D>(N, Coordinates.data(), NULL, NULL);
+
+    for (int i = 0; i < N; i++)
+        Solution[i] = i;
+    Convert_Solution_To_All_Node();
+    Local_Search_by_2Opt_Move();
+    Store_Best_Solution();
+    Current_Instance_Best_Distance = Get_Solution_Total_Distance();
+    Current_Instance_Begin_Time -= std::chrono::seconds(5);
+
+    // An edge changed before checkpointing starts, one in each snapshot and
+    // one in both
+    Checkpoint_Path = Path;
+    Weight[1][2] = 7;
+    Begin_Checkpointing();
+    auto Change_Edge = [](int First_City, int Second_City, float Edge_Weight) {
+        Weight[First_City][Second_City] = Edge_Weight;
+        Chosen_Times[First_City][Second_City]++;
+        Log_Edge_Change(First_City, Second_City);
+    };
+    Change_Edge(3, 4, 11);
+    Change_Edge(5, 6, 13);
+    Active_Checkpoint_Writer->Checkpoint();
+    Change_Edge(5, 6, 17);
+    Change_Edge(8, 9, 19);
+    Total_Simulation_Times = 1234;
+    Get_Random_Int(100);
+    Active_Checkpoint_Writer->Checkpoint();
+    End_Checkpointing();
+    Checkpoint_Path = "";
+
+    vector<int> Best_Tour(N);
+    for (int i = 0, Cur_City = Start_City; i < N; i++, Cur_City = Best_All_Node[Cur_City].Next_City)
+        Best_Tour[i] = Cur_City;
+    vector<float> Saved_Weight;
+    vector<int> Saved_Chosen_Times;
+    for (int i = 0; i < N; i++)
+    {
+        Saved_Weight.insert(Saved_Weight.end(), Weight[i], Weight[i] + N);
+        Saved_Chosen_Times.insert(Saved_Chosen_Times.end(), Chosen_Times[i], Chosen_Times[i] + N);
+    }
+    unsigned long long Saved_Random_State = Random_State;
+    Checkpoint_Snapshot Snapshot;
+    Check(Read_Checkpoint_File(Snapshot, Path));
+    Check(Snapshot.Elapsed_Time >= 5);
+
+    // Resume into a fresh search
+    MCTS_Init();
+    for (int i = 0; i < N; i++)
+        Solution[i] = (N - i) % N;
+    Convert_Solution_To_All_Node();
+    Store_Best_Solution();
+    Set_Random_Seed(99);
+    Current_Instance_Begin_Time = std::chrono::steady_clock::now();
+    Resume_Path = Path;
+    Check(Load_Resume_Snapshot(N));
+    Check(Resume_From_Checkpoint());
+
+    for (int i = 0, Cur_City = Start_City; i < N; i++, Cur_City = Best_All_Node[Cur_City].Next_City)
+        Check(Best_Tour[i] == Cur_City);
+    int Mismatch_Num = 0;
+    for (int i = 0; i < N; i++)
+        for (int j = 0; j < N; j++)
+            Mismatch_Num += Weight[i][j] != Saved_Weight[(size_t)i * N + j] ||
+                            Chosen_Times[i][j] != Saved_Chosen_Times[(size_t)i * N + j];
+    Check(Mismatch_Num == 0);
+    Check(Weight[1][2] == 7 && Weight[5][6] == 17 && Chosen_Times[5][6] == 2);
+    Check(Random_State == Saved_Random_State);
+    Check(Total_Simulation_Times == 1234);
+    double Elapsed_Time = Get_Elapsed_Time(Current_Instance_Begin_Time);
+    Check(Elapsed_Time >= Snapshot.Elapsed_Time && Elapsed_Time < Snapshot.Elapsed_Time + 1);
+
+    // Another instance, of the same size or not
+    Check(If_Resume_Rejected(Path, N - 1));
+    Checkpoint_Instance_Hash = Get_Instance_Hash<Metric_EUC_2D>(N, Get_Random_Coordinates(N, 5).data(), NULL, NULL);
+    Check(If_Resume_Rejected(Path, N));
+    Checkpoint_Instance_Hash = Snapshot.Instance_Hash;
+    Check(!If_Resume_Rejected(Path, N));
+
+    // Corrupt copies: a city out of range or repeated in the tour, an edge
+    // out of range, the file cut short, a tour size beyond the file
+    for (int Corruption = 0; Corruption < 5; Corruption++)
+    {
+        Checkpoint_Snapshot Corrupt = Snapshot;
+        if (Corruption == 0)
+            Corrupt.Best_Tour[3] = N;
+        else if (Corruption == 1)
+            Corrupt.Best_Tour[3] = Corrupt.Best_Tour[4];
+        else if (Corruption == 2)
+            Corrupt.Edges[0].Second_City = -1;
+        Check(Write_Checkpoint_File(Corrupt, Corrupt_Path));
+        if (Corruption >= 3)
+        {
+            std::ifstream Input(Corrupt_Path, std::ios::binary);
+            std::string Content((std::istreambuf_iterator<char>(Input)), std::istreambuf_iterator<char>());
+            Input.close();
+            size_t Tour_Size_Offset = 3 * sizeof(int) + sizeof(Snapshot.Instance_Hash) + sizeof(Snapshot.Best_Distance) +
+                                      sizeof(Snapshot.Total_Simulation_Times) + sizeof(Snapshot.Random_State) +
+                                      sizeof(Snapshot.Elapsed_Time);
+            unsigned long long Tour_Size = 1ULL << 60;
+            if (Corruption == 4)
+                memcpy(&Content[Tour_Size_Offset], &Tour_Size, sizeof(Tour_Size));
+            std::ofstream(Corrupt_Path, std::ios::binary)
+                .write(Content.data(), Corruption == 3 ? Content.size() / 2 : Content.size());
+        }
+        Check(If_Resume_Rejected(Corrupt_Path, N));
+    }
+
+    Resume_Path = "";
+    If_Resume_Snapshot_Loaded = false;
+    remove(Path);
+    remove(Corrupt_Path);
+    Release_Memory(N);
+}
+
+// Alpha-nearness candidates, on the complete and on the sparse ascent graph:
+// the candidate list of each city holds the cities of least alpha, alpha
+// being recomputed here by a walk of the tree from each city instead of the
+// sweep of the solver, and so its 1-tree neighbors, of alpha 0
+void Test_Alpha_Nearness_Candidates()
+{
+    for (int N : {150, Dense_Graph_Max_City_Num + 60})
+    {
+        Load_Search_Instance(N, Get_Random_Coordinates(N, 6));
+        Candidate_Use_Heatmap = Candidate_Alpha_Nearness;
+        Identify_Candidate_Set();
+
+        Ascent_Graph Graph;
+        Build_Ascent_Graph(Graph);
+        vector<int> Pi;
+        One_Tree Tree;
+        Check(Optimize_Penalties(Graph, Pi, Tree) != LLONG_MIN);
+        vector<vector<int>> Tree_Neighbor(N);
+        for (int i = 0; i < N; i++)
+            if (Tree.Dad[i] != Null)
+            {
+                Tree_Neighbor[i].push_back(Tree.Dad[i]);
+                Tree_Neighbor[Tree.Dad[i]].push_back(i);
+            }
+
+        int Checked_City_Num = 0;
+        vector<long long> Beta(N);
+        vector<int> Stack;
+        for (int i = 0; i < N; i++)
+        {
+            // Beta[j]: most expensive edge on the tree path from i to j
+            std::fill(Beta.begin(), Beta.end(), LLONG_MAX);
+            Beta[i] = LLONG_MIN;
+            Stack.assign(1, i);
+            while (!Stack.empty())
+            {
+                int Cur_City = Stack.back();
+                Stack.pop_back();
+                for (int Next_City : Tree_Neighbor[Cur_City])
+                    if (Beta[Next_City] == LLONG_MAX)
+                    {
+                        Beta[Next_City] = max(Beta[Cur_City], Get_Penalized_Distance(Cur_City, Next_City, Pi));
+                        Stack.push_back(Next_City);
+                    }
+            }
+
+            vector<std::pair<double, int>> Order;
+            for (int j = 0; j < N; j++)
+            {
+                if (j == i)
+                    continue;
+                bool If_Special_Edge = (i == Tree.Special_City && j == Tree.Special_Neighbor) ||
+                                       (j == Tree.Special_City && i == Tree.Special_Neighbor);
+                double Alpha = If_Special_Edge ? 0 : (double)(Get_Penalized_Distance(i, j, Pi) - Beta[j]);
+                Check(Alpha >= 0);
+                Order.push_back(std::make_pair(Alpha + (double)Get_Distance(i, j) / Inf_Cost, j));
+            }
+            std::stable_sort(Order.begin(), Order.end(),
+                             [](const std::pair<double, int> &First, const std::pair<double, int> &Second) {
+                                 return First.first < Second.first;
+                             });
+
+            Check(Candidate_Num[i] == min(Max_Candidate_Num, N - 1));
+            for (int k = 0; k < Candidate_Num[i]; k++)
+                Check(Candidate[i][k] == Order[k].second);
+
+            vector<int> One_Tree_Neighbor = Tree_Neighbor[i];
+            if (i == Tree.Special_City)
+                One_Tree_Neighbor.push_back(Tree.Special_Neighbor);
+            if (i == Tree.Special_Neighbor)
+                One_Tree_Neighbor.push_back(Tree.Special_City);
+            if ((int)One_Tree_Neighbor.size() > Candidate_Num[i])
+                continue;
+            Checked_City_Num++;
+            for (int Neighbor : One_Tree_Neighbor)
+                Check(std::find(Candidate[i], Candidate[i] + Candidate_Num[i], Neighbor) !=
+                      Candidate[i] + Candidate_Num[i]);
+        }
+        Check(Checked_City_Num > N * 9 / 10);
+        Release_Memory(N);
+    }
+}
+
+// N cities on a circle, in random order, and their optimal tour, the order of
+// their angles
+vector<double> Get_Circle_Coordinates(int N, unsigned long long Seed, vector<int> &Opt_Tour)
+{
+    Set_Random_Seed(Seed);
+    vector<std::pair<double, int>> Angle(N);
+    vector<double> Coordinates(2 * N);
+    for (int i = 0; i < N; i++)
+    {
+        Angle[i] = std::make_pair(Get_Random_Int(1000000) * 2 * std::acos(-1.0) / 1000000, i);
+        Coordinates[2 * i] = 0.5 + 0.4 * std::cos(Angle[i].first);
+        Coordinates[2 * i + 1] = 0.5 + 0.4 * std::sin(Angle[i].first);
+    }
+    std::sort(Angle.begin(), Angle.end());
+    Opt_Tour.resize(N);
+    for (int i = 0; i < N; i++)
+        Opt_Tour[i] = Angle[i].second;
+    std::rotate(Opt_Tour.begin(), std::find(Opt_Tour.begin(), Opt_Tour.end(), 0), Opt_Tour.end());
+    return Coordinates;
+}
+
+// Held-Karp lower bound on cities on a circle, whose optimal tour is known:
+// the bound of the background task, with the ascent on the complete or on the
+// sparse graph, is at most the optimum and close to it, and a solve with a
+// target gap stops long before its time budget once the gap is certified
+void Test_Lower_Bound()
+{
+    for (int N : {100, Dense_Graph_Max_City_Num + 100})
+    {
+        vector<int> Opt_Tour;
+        Load_Search_Instance(N, Get_Circle_Coordinates(N, 7, Opt_Tour));
+        long long Opt_Distance = 0;
+        for (int i = 0; i < N; i++)
+            Opt_Distance += Get_Distance(Opt_Tour[i], Opt_Tour[(i + 1) % N]);
+
+        long long One_Tree_Bound = Get_Complete_One_Tree_Bound(vector<int>(N, 0));
+        Check(One_Tree_Bound > 0 && One_Tree_Bound <= Opt_Distance);
+
+        Lower_Bound_Task Task;
+        Task.Start();
+        auto Start_Time = std::chrono::steady_clock::now();
+        while (Task.Bound.load() == Null && Get_Elapsed_Time(Start_Time) < 60)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        long long Bound = Task.Finish();
+        Check(Bound != Null);
+        Check(Bound >= One_Tree_Bound && Bound <= Opt_Distance);
+        Check(Bound >= 0.99 * Opt_Distance);
+        Release_Memory(N);
+    }
+
+    int N = 100;
+    vector<int> Opt_Tour;
+    vector<double> Coordinates = Get_Circle_Coordinates(N, 8, Opt_Tour);
+    Search_Param Param = Get_Search_Param();
+    Param.Param_T = 0.2; // a budget of 20 seconds
+    Param.Candidate_Use_Heatmap = Candidate_Nearest;
+    Param.Target_Gap = 0.02;
+    TSP_Output Output = Solve_Instance<Metric_EUC_2D>(N, Param, Coordinates.data(), Opt_Tour.data(), NULL);
+    Check(Output.Time < 5);
+    Check(Output.Certified_Gap >= 0 && Output.Certified_Gap <= 0.02);
+    // The bound is of the rounded distances of the search, up to half a unit
+    // per edge from the reported lengths
+    Check(Output.Lower_Bound > 0 && Output.Lower_Bound <= Output.Concorde_Distance + 0.5 * N / Metric_EUC_2D::Scale);
+}
+
+struct Named_Test
+{
+    const char *Name;
+    std::function<void()> Run;
+};
+
+const Named_Test Tests[] = {
+    {"partition_crossover", Test_Partition_Crossover},
+    {"half_float_round_trip", Test_Half_Float_Round_Trip},
+    {"renumbering", Test_Renumbering},
+    {"live_update_validation", Test_Live_Update_Validation},
+    {"checkpoint_round_trip", Test_Checkpoint_Round_Trip},
+    {"alpha_nearness_candidates", Test_Alpha_Nearness_Candidates},
+    {"lower_bound", Test_Lower_Bound},
+};
+
+int main(int argc, char **argv)
+{
+    int Run_Num = 0;
+    for (const Named_Test &Test : Tests)
+    {
+        if (argc > 1 && strcmp(argv[1], Test.Name) != 0)
+            continue;
+        int Failed_Before = Failed_Check_Num;
+        Test.Run();
+        printf("%s: %s\n", Test.Name, Failed_Check_Num == Failed_Before ? "passed" : "FAILED");
+        Run_Num++;
+    }
+    if (Run_Num == 0)
+    {
+        printf("Unknown test %s\n", argv[1]);
+        return 1;
+    }
+    return Failed_Check_Num == 0 ? 0 : 1;
+}